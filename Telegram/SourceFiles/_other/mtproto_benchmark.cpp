@@ -0,0 +1,459 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/details/mtproto_loopback_server.h"
+#include "mtproto/details/mtproto_abstract_socket.h"
+#include "mtproto/details/mtproto_conditioned_socket.h"
+#include "base/integration.h"
+#include "base/openssl_help.h"
+#include "base/unixtime.h"
+#include "logs.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtNetwork/QNetworkProxy>
+
+#include <cstdio>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else // Q_OS_WIN
+#include <time.h>
+#endif // Q_OS_WIN
+
+// Sends requests to the loopback fake DC through the MTProto transport
+// and reports requests/s, MB/s and the CPU time of the main thread.
+//
+// mtproto_benchmark [-protocol 0|1|d] [-method file|upload|history]
+//     [-requests N] [-parallel N] [-size BYTES] [-netconditions L:P:B]
+//     [-debug]
+
+namespace Logs {
+namespace {
+
+bool DebugLogs = false;
+
+} // namespace
+
+void SetDebugEnabled(bool enabled) {
+	DebugLogs = enabled;
+}
+
+bool DebugEnabled() {
+	return DebugLogs;
+}
+
+bool started() {
+	return true;
+}
+
+QString ProfilePrefix() {
+	return QString();
+}
+
+void writeMain(const QString &v) {
+	fprintf(stderr, "%s\n", v.toUtf8().constData());
+}
+
+void writeDebug(const char *file, int32 line, const QString &v) {
+	fprintf(stderr, "%s:%d %s\n", file, line, v.toUtf8().constData());
+}
+
+void writeTcp(const QString &v) {
+	writeMain(v);
+}
+
+void writeMtp(int32 dc, const QString &v) {
+	writeMain(QString("%1: %2").arg(dc).arg(v));
+}
+
+} // namespace Logs
+
+namespace {
+
+using namespace MTP;
+using namespace MTP::details;
+
+constexpr auto kDcId = 2;
+
+enum class Method {
+	File,
+	Upload,
+	History,
+};
+
+struct Options {
+	QString protocol = "d";
+	Method method = Method::File;
+	int requests = 2000;
+	int parallel = 4;
+	int size = 128 * 1024;
+	QString conditions;
+};
+
+class Integration final : public base::Integration {
+public:
+	using base::Integration::Integration;
+
+	void enterFromEventLoop(FnMut<void()> &&method) override {
+		method();
+	}
+	void logMessage(const QString &message) override {
+		DEBUG_LOG((message));
+	}
+	void logAssertionViolation(const QString &info) override {
+		LOG(("Assertion Failed! ") + info);
+	}
+
+};
+
+[[nodiscard]] crl::time MainThreadTime() {
+#ifdef Q_OS_WIN
+	FILETIME creation, exited, kernel, user;
+	GetThreadTimes(GetCurrentThread(), &creation, &exited, &kernel, &user);
+	const auto value = [](FILETIME time) {
+		return (uint64(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+	};
+	return crl::time((value(kernel) + value(user)) / 10000);
+#else // Q_OS_WIN
+	auto time = timespec();
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+	return crl::time(time.tv_sec) * 1000 + time.tv_nsec / 1000000;
+#endif // Q_OS_WIN
+}
+
+[[nodiscard]] bytes::vector ProtocolSecret(const QString &protocol) {
+	if (protocol == "0") {
+		return {};
+	}
+	auto result = bytes::vector(16);
+	bytes::set_random(result);
+	if (protocol == "d") {
+		result.insert(begin(result), bytes::type(0xDD));
+	}
+	return result;
+}
+
+class Client final {
+public:
+	Client(const Options &options, bytes::const_span secret, int port);
+
+	void start();
+
+private:
+	void connected();
+	void read();
+	void handle(const mtpBuffer &packet);
+	void sendRequests();
+	void sendRequest();
+	void finish(const QString &error = QString());
+	[[nodiscard]] mtpBuffer prepareRequest();
+
+	const Options _options;
+	const bytes::vector _secret;
+	const AuthKeyPtr _key;
+	const int _port = 0;
+	LoopbackTransport _transport;
+	std::unique_ptr<AbstractSocket> _socket;
+	bytes::vector _readBuffer;
+
+	uint64 _salt = 0;
+	uint64 _sessionId = 0;
+	mtpMsgId _lastMessageId = 0;
+	uint32 _seqNo = 0;
+	bool _startSent = false;
+	bool _finished = false;
+
+	int _sent = 0;
+	int _received = 0;
+	int64 _bytes = 0;
+	crl::time _started = 0;
+	crl::time _startedMainThread = 0;
+
+	rpl::lifetime _lifetime;
+
+};
+
+Client::Client(const Options &options, bytes::const_span secret, int port)
+: _options(options)
+, _secret(bytes::make_vector(secret))
+, _key(LoopbackAuthKey(kDcId))
+, _port(port)
+, _transport(LoopbackTransport::Side::Client, secret)
+, _readBuffer(64 * 1024)
+, _salt(openssl::RandomValue<uint64>())
+, _sessionId(openssl::RandomValue<uint64>()) {
+}
+
+void Client::start() {
+	_socket = AbstractSocket::Create(
+		QThread::currentThread(),
+		_secret,
+		QNetworkProxy(QNetworkProxy::NoProxy));
+
+	_socket->connected(
+	) | rpl::start_with_next([=] {
+		connected();
+	}, _lifetime);
+
+	_socket->readyRead(
+	) | rpl::start_with_next([=] {
+		read();
+	}, _lifetime);
+
+	_socket->disconnected(
+	) | rpl::start_with_next([=] {
+		finish("disconnected");
+	}, _lifetime);
+
+	_socket->error(
+	) | rpl::start_with_next([=] {
+		finish("socket error");
+	}, _lifetime);
+
+	_socket->connectToHost("127.0.0.1", _port);
+}
+
+void Client::connected() {
+	_started = crl::now();
+	_startedMainThread = MainThreadTime();
+	sendRequests();
+}
+
+void Client::read() {
+	const auto handlePacket = [&](mtpBuffer &&packet) {
+		handle(packet);
+	};
+	while (!_finished && _socket->hasBytesAvailable()) {
+		const auto read = _socket->read(_readBuffer);
+		if (read <= 0) {
+			break;
+		}
+		const auto data = bytes::make_span(_readBuffer).subspan(0, read);
+		if (!_transport.feed(data, handlePacket)) {
+			return finish("bad packet length");
+		}
+	}
+}
+
+void Client::handle(const mtpBuffer &packet) {
+	if (_finished) {
+		return;
+	}
+	const auto message = LoopbackDecrypt(_key, false, packet);
+	if (!message) {
+		return finish("bad encrypted packet");
+	}
+	constexpr auto kBodyPosition = 8;
+	auto from = message->constData() + kBodyPosition;
+	const auto end = message->constData() + message->size();
+	if (from + 4 > end || mtpTypeId(*from) != mtpc_rpc_result) {
+		// new_session_created and other service messages.
+		return;
+	}
+	from += 3;
+	const auto type = mtpTypeId(*from);
+	const auto size = int64(end - from) * sizeof(mtpPrime);
+	if (type == mtpc_rpc_error) {
+		auto error = MTPRpcError();
+		if (error.read(from, end)) {
+			return finish(qs(error.c_rpc_error().verror_message()));
+		}
+		return finish("bad rpc_error");
+	}
+
+	// Parse the answers as the application would.
+	auto parsed = false;
+	switch (_options.method) {
+	case Method::File: {
+		auto result = MTPupload_File();
+		parsed = result.read(from, end)
+			&& (result.type() == mtpc_upload_file);
+		if (parsed) {
+			_bytes += result.c_upload_file().vbytes().v.size();
+		}
+	} break;
+	case Method::Upload: {
+		auto result = MTPBool();
+		parsed = result.read(from, end);
+	} break;
+	case Method::History: {
+		auto result = MTPmessages_Messages();
+		parsed = result.read(from, end);
+		if (parsed) {
+			_bytes += size;
+		}
+	} break;
+	}
+	if (!parsed) {
+		return finish("bad response");
+	}
+	if (++_received == _options.requests) {
+		finish();
+	} else {
+		sendRequests();
+	}
+}
+
+void Client::sendRequests() {
+	while (!_finished
+		&& _sent < _options.requests
+		&& _sent - _received < _options.parallel) {
+		sendRequest();
+	}
+}
+
+mtpBuffer Client::prepareRequest() {
+	auto result = mtpBuffer();
+	switch (_options.method) {
+	case Method::File:
+		MTPupload_GetFile(
+			MTP_flags(0),
+			MTP_inputDocumentFileLocation(
+				MTP_long(1),
+				MTP_long(1),
+				MTP_bytes(),
+				MTP_string()),
+			MTP_int(_sent * _options.size),
+			MTP_int(_options.size)
+		).write(result);
+		break;
+	case Method::Upload: {
+		MTPupload_SaveFilePart(
+			MTP_long(1),
+			MTP_int(_sent),
+			MTP_bytes(QByteArray(_options.size, char(0x17)))
+		).write(result);
+		_bytes += _options.size;
+	} break;
+	case Method::History:
+		MTPmessages_GetHistory(
+			MTP_inputPeerSelf(),
+			MTP_int(0), // offset_id
+			MTP_int(0), // offset_date
+			MTP_int(0), // add_offset
+			MTP_int(_options.size), // limit
+			MTP_int(0), // max_id
+			MTP_int(0), // min_id
+			MTP_int(0) // hash
+		).write(result);
+		break;
+	}
+	return result;
+}
+
+void Client::sendRequest() {
+	constexpr auto kHeaderInts = 8;
+	const auto request = prepareRequest();
+	const auto now = mtpMsgId(base::unixtime::now());
+	_lastMessageId = std::max(now << 32, _lastMessageId + 4);
+
+	auto message = mtpBuffer(kHeaderInts);
+	message.reserve(kHeaderInts + request.size());
+	memcpy(message.data(), &_salt, sizeof(_salt));
+	memcpy(message.data() + 2, &_sessionId, sizeof(_sessionId));
+	memcpy(message.data() + 4, &_lastMessageId, sizeof(_lastMessageId));
+	message[6] = _seqNo++ * 2 + 1;
+	message[7] = request.size() * sizeof(mtpPrime);
+	message.append(request);
+
+	auto prefix = bytes::vector();
+	if (!_startSent) {
+		_startSent = true;
+		prefix = _transport.prepareStart(kDcId, [&](bytes::const_span n) {
+			return _socket->isGoodStartNonce(n);
+		});
+	}
+	const auto packet = _transport.wrap(LoopbackEncrypt(_key, true, message));
+	_socket->write(prefix, packet);
+	++_sent;
+}
+
+void Client::finish(const QString &error) {
+	if (_finished) {
+		return;
+	}
+	_finished = true;
+	const auto duration = std::max(crl::now() - _started, crl::time(1));
+	const auto mainThread = MainThreadTime() - _startedMainThread;
+
+	if (!error.isEmpty()) {
+		fprintf(stderr, "Error: %s\n", error.toUtf8().constData());
+		QCoreApplication::exit(1);
+		return;
+	}
+	printf(
+		"%d requests in %lld ms: %.1f requests/s, %.2f MB/s, "
+		"main thread %lld ms (%.1f%%).\n",
+		_received,
+		qlonglong(duration),
+		_received * 1000. / duration,
+		_bytes * 1000. / (duration * 1024. * 1024.),
+		qlonglong(mainThread),
+		mainThread * 100. / duration);
+	QCoreApplication::quit();
+}
+
+[[nodiscard]] Options ParseOptions(const QStringList &arguments) {
+	auto result = Options();
+	for (auto i = 1; i + 1 < arguments.size(); i += 2) {
+		const auto &key = arguments[i];
+		const auto &value = arguments[i + 1];
+		if (key == "-protocol") {
+			result.protocol = value;
+		} else if (key == "-method") {
+			result.method = (value == "upload")
+				? Method::Upload
+				: (value == "history")
+				? Method::History
+				: Method::File;
+			if (result.method == Method::History
+				&& !arguments.contains("-size")) {
+				result.size = 100;
+			}
+		} else if (key == "-requests") {
+			result.requests = std::max(value.toInt(), 1);
+		} else if (key == "-parallel") {
+			result.parallel = std::max(value.toInt(), 1);
+		} else if (key == "-size") {
+			result.size = std::max(value.toInt(), 1);
+		} else if (key == "-netconditions") {
+			result.conditions = value;
+		}
+	}
+	return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+	auto integration = Integration(argc, argv);
+	base::Integration::Set(&integration);
+
+	QCoreApplication application(argc, argv);
+	const auto arguments = application.arguments();
+	Logs::SetDebugEnabled(arguments.contains("-debug"));
+
+	const auto options = ParseOptions(arguments);
+	if (!options.conditions.isEmpty()) {
+		SetNetworkConditions(ParseNetworkConditions(options.conditions));
+	}
+	const auto secret = ProtocolSecret(options.protocol);
+	auto responses = LoopbackResponses();
+	responses.fileLimit = std::max(options.size, responses.fileLimit);
+	responses.historyLimit = std::max(options.size, responses.historyLimit);
+
+	const auto server = std::make_unique<LoopbackServer>(
+		LoopbackAuthKey(kDcId),
+		secret,
+		responses);
+	if (!server->port()) {
+		return 1;
+	}
+	auto client = Client(options, secret, server->port());
+	client.start();
+	return application.exec();
+}
@@ -0,0 +1,123 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/timer.h"
+#include "base/flat_set.h"
+#include "base/weak_ptr.h"
+
+namespace Api {
+
+enum class RequestPriority {
+	Normal, // Waits for the batch delay to collect more keys.
+	High, // Sent on the next event loop iteration.
+};
+
+struct RequestBatcherStats {
+	int keys = 0; // All the add() calls.
+	int merged = 0; // Keys already waiting or already being requested.
+	int batches = 0; // Batches passed to the sender.
+};
+
+// Collects keys that should be requested from the server, drops the ones
+// that are already queued or in flight and passes them to the sender in
+// batches of limited size. The sender calls the finish callback when
+// the batch request is done, after that the keys may be requested again.
+template <typename Key>
+class RequestBatcher final : public base::has_weak_ptr {
+public:
+	struct Options {
+		const char *name = "";
+		int maxBatchSize = 100;
+		crl::time delay = 0;
+	};
+	using Sender = Fn<void(std::vector<Key> &&keys, Fn<void()> finish)>;
+
+	RequestBatcher(Options options, Sender sender)
+	: _options(options)
+	, _sender(std::move(sender))
+	, _timer([=] { send(); }) {
+		Expects(_options.maxBatchSize > 0);
+	}
+	~RequestBatcher() {
+		if (_stats.keys) {
+			DEBUG_LOG(("API Batcher: %1 - %2 keys, %3 merged, %4 batches."
+				).arg(_options.name
+				).arg(_stats.keys
+				).arg(_stats.merged
+				).arg(_stats.batches));
+		}
+	}
+
+	// Returns false if the key was already queued or being requested.
+	bool add(
+			const Key &key,
+			RequestPriority priority = RequestPriority::Normal) {
+		++_stats.keys;
+		if (contains(key)) {
+			++_stats.merged;
+			if (priority == RequestPriority::High
+				&& _pending.contains(key)) {
+				_timer.callOnce(0);
+			}
+			return false;
+		}
+		_pending.emplace(key);
+		if (priority == RequestPriority::High) {
+			_timer.callOnce(0);
+		} else if (!_timer.isActive()) {
+			_timer.callOnce(_options.delay);
+		}
+		return true;
+	}
+
+	[[nodiscard]] bool contains(const Key &key) const {
+		return _pending.contains(key) || _inFlight.contains(key);
+	}
+	void remove(const Key &key) {
+		_pending.remove(key);
+	}
+
+	[[nodiscard]] RequestBatcherStats stats() const {
+		return _stats;
+	}
+
+private:
+	void send() {
+		while (!_pending.empty()) {
+			const auto count = std::min(
+				int(_pending.size()),
+				_options.maxBatchSize);
+			auto keys = std::vector<Key>(
+				_pending.begin(),
+				_pending.begin() + count);
+			_pending.erase(_pending.begin(), _pending.begin() + count);
+			for (const auto &key : keys) {
+				_inFlight.emplace(key);
+			}
+			++_stats.batches;
+			auto finish = crl::guard(this, [=] {
+				for (const auto &key : keys) {
+					_inFlight.remove(key);
+				}
+			});
+			_sender(std::move(keys), std::move(finish));
+		}
+	}
+
+	const Options _options;
+	const Sender _sender;
+	base::Timer _timer;
+
+	base::flat_set<Key> _pending;
+	base::flat_set<Key> _inFlight;
+	RequestBatcherStats _stats;
+
+};
+
+} // namespace Api
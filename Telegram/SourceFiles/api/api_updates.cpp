@@ -384,6 +384,7 @@ void Updates::channelDifferenceDone(
 
 void Updates::feedChannelDifference(
 		const MTPDupdates_channelDifference &data) {
+	const auto bulk = session().data().bulkUpdates();
 	session().data().processUsers(data.vusers());
 	session().data().processChats(data.vchats());
 
@@ -549,11 +550,23 @@ void Updates::feedDifference(
 		const MTPVector<MTPMessage> &msgs,
 		const MTPVector<MTPUpdate> &other) {
 	Core::App().checkAutoLock();
-	session().data().processUsers(users);
-	session().data().processChats(chats);
-	feedMessageIds(other);
-	session().data().processMessages(msgs, NewMessageType::Unread);
-	feedUpdateVector(other, true);
+
+	const auto started = crl::now();
+	{
+		const auto bulk = session().data().bulkUpdates();
+		session().data().processUsers(users);
+		session().data().processChats(chats);
+		feedMessageIds(other);
+		session().data().processMessages(msgs, NewMessageType::Unread);
+		feedUpdateVector(other, true);
+	}
+	DEBUG_LOG(("Difference: %1 users, %2 chats, %3 messages, "
+		"%4 updates applied in %5 ms."
+		).arg(users.v.size()
+		).arg(chats.v.size()
+		).arg(msgs.v.size()
+		).arg(other.v.size()
+		).arg(crl::now() - started));
 }
 
 void Updates::differenceFail(const RPCError &error) {
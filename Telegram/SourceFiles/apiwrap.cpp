@@ -86,6 +86,9 @@ namespace {
 // 1 second wait before reload members in channel after adding.
 constexpr auto kReloadChannelMembersTimeout = 1000;
 
+// Max peers of each type in one users.getUsers / getChats request.
+constexpr auto kPeersPerRequestMax = 100;
+
 // Save draft to the cloud with 1 sec extra delay.
 constexpr auto kSaveCloudDraftTimeout = 1000;
 
@@ -182,6 +185,24 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 : MTP::Sender(&session->account().mtp())
 , _session(session)
 , _messageDataResolveDelayed([=] { resolveMessageDatas(); })
+, _peerRequests(
+	{ .name = "peers", .maxBatchSize = kPeersPerRequestMax },
+	[=](auto &&peers, Fn<void()> finish) {
+		sendPeersRequest(std::move(peers), std::move(finish));
+	})
+, _peerSettingsRequests(
+	{ .name = "peer settings", .maxBatchSize = 1 },
+	[=](auto &&peers, Fn<void()> finish) {
+		sendPeerSettingsRequest(peers.front(), std::move(finish));
+	})
+, _participantsCountRequests(
+	{ .name = "participants count", .delay = kReloadChannelMembersTimeout },
+	[=](auto &&channels, Fn<void()> finish) {
+		for (const auto channel : channels) {
+			channel->updateFullForced();
+		}
+		finish();
+	})
 , _webPagesTimer([=] { resolveWebPages(); })
 , _draftsSaveTimer([=] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([=] { readFeaturedSets(); })
@@ -1187,56 +1208,27 @@ void ApiWrap::gotUserFull(
 }
 
 void ApiWrap::requestPeer(not_null<PeerData*> peer) {
-	if (_fullPeerRequests.contains(peer) || _peerRequests.contains(peer)) {
-		return;
+	if (!_fullPeerRequests.contains(peer)) {
+		_peerRequests.add(peer, Api::RequestPriority::High);
 	}
-
-	const auto requestId = [&] {
-		const auto failHandler = [=](const RPCError &error) {
-			_peerRequests.remove(peer);
-		};
-		const auto chatHandler = [=](const MTPmessages_Chats &result) {
-			_peerRequests.remove(peer);
-			const auto &chats = result.match([](const auto &data) {
-				return data.vchats();
-			});
-			_session->data().applyMaximumChatVersions(chats);
-			_session->data().processChats(chats);
-		};
-		if (const auto user = peer->asUser()) {
-			return request(MTPusers_GetUsers(
-				MTP_vector<MTPInputUser>(1, user->inputUser)
-			)).done([=](const MTPVector<MTPUser> &result) {
-				_peerRequests.remove(user);
-				_session->data().processUsers(result);
-			}).fail(failHandler).send();
-		} else if (const auto chat = peer->asChat()) {
-			return request(MTPmessages_GetChats(
-				MTP_vector<MTPint>(1, chat->inputChat)
-			)).done(chatHandler).fail(failHandler).send();
-		} else if (const auto channel = peer->asChannel()) {
-			return request(MTPchannels_GetChannels(
-				MTP_vector<MTPInputChannel>(1, channel->inputChannel)
-			)).done(chatHandler).fail(failHandler).send();
-		}
-		Unexpected("Peer type in requestPeer.");
-	}();
-	_peerRequests.insert(peer, requestId);
 }
 
 void ApiWrap::requestPeerSettings(not_null<PeerData*> peer) {
-	if (!_requestedPeerSettings.emplace(peer).second) {
-		return;
-	}
+	_peerSettingsRequests.add(peer, Api::RequestPriority::High);
+}
+
+void ApiWrap::sendPeerSettingsRequest(
+		not_null<PeerData*> peer,
+		Fn<void()> finish) {
 	request(MTPmessages_GetPeerSettings(
 		peer->input
 	)).done([=](const MTPPeerSettings &result) {
 		peer->setSettings(result.match([&](const MTPDpeerSettings &data) {
 			return data.vflags().v;
 		}));
-		_requestedPeerSettings.erase(peer);
+		finish();
 	}).fail([=](const RPCError &error) {
-		_requestedPeerSettings.erase(peer);
+		finish();
 	}).send();
 }
 
@@ -1390,18 +1382,20 @@ void ApiWrap::markMediaRead(not_null<HistoryItem*> item) {
 }
 
 void ApiWrap::requestPeers(const QList<PeerData*> &peers) {
+	for (const auto peer : peers) {
+		if (peer && !_fullPeerRequests.contains(peer)) {
+			_peerRequests.add(peer, Api::RequestPriority::High);
+		}
+	}
+}
+
+void ApiWrap::sendPeersRequest(
+		std::vector<not_null<PeerData*>> &&peers,
+		Fn<void()> finish) {
 	QVector<MTPint> chats;
 	QVector<MTPInputChannel> channels;
 	QVector<MTPInputUser> users;
-	chats.reserve(peers.size());
-	channels.reserve(peers.size());
-	users.reserve(peers.size());
 	for (const auto peer : peers) {
-		if (!peer
-			|| _fullPeerRequests.contains(peer)
-			|| _peerRequests.contains(peer)) {
-			continue;
-		}
 		if (const auto user = peer->asUser()) {
 			users.push_back(user->inputUser);
 		} else if (const auto chat = peer->asChat()) {
@@ -1410,27 +1404,48 @@ void ApiWrap::requestPeers(const QList<PeerData*> &peers) {
 			channels.push_back(channel->inputChannel);
 		}
 	}
+
+	// The batch is finished when all the requests for it are done.
+	const auto left = std::make_shared<int>(0);
+	const auto requestFinished = [=] {
+		if (!--*left) {
+			finish();
+		}
+	};
 	const auto handleChats = [=](const MTPmessages_Chats &result) {
-		_session->data().processChats(result.match([](const auto &data) {
+		const auto &chats = result.match([](const auto &data) {
 			return data.vchats();
-		}));
+		});
+		_session->data().applyMaximumChatVersions(chats);
+		_session->data().processChats(chats);
+		requestFinished();
+	};
+	const auto handleFail = [=](const RPCError &error) {
+		requestFinished();
 	};
 	if (!chats.isEmpty()) {
+		++*left;
 		request(MTPmessages_GetChats(
 			MTP_vector<MTPint>(chats)
-		)).done(handleChats).send();
+		)).done(handleChats).fail(handleFail).send();
 	}
 	if (!channels.isEmpty()) {
+		++*left;
 		request(MTPchannels_GetChannels(
 			MTP_vector<MTPInputChannel>(channels)
-		)).done(handleChats).send();
+		)).done(handleChats).fail(handleFail).send();
 	}
 	if (!users.isEmpty()) {
+		++*left;
 		request(MTPusers_GetUsers(
 			MTP_vector<MTPInputUser>(users)
 		)).done([=](const MTPVector<MTPUser> &result) {
 			_session->data().processUsers(result);
-		}).send();
+			requestFinished();
+		}).fail(handleFail).send();
+	}
+	if (!*left) {
+		finish();
 	}
 }
 
@@ -2711,9 +2726,7 @@ void ApiWrap::resolveWebPages() {
 
 void ApiWrap::requestParticipantsCountDelayed(
 		not_null<ChannelData*> channel) {
-	_participantsCountRequestTimer.call(
-		kReloadChannelMembersTimeout,
-		[=] { channel->updateFullForced(); });
+	_participantsCountRequests.add(channel);
 }
 
 template <typename Request>
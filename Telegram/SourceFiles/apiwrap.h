@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "api/api_common.h"
+#include "api/api_request_batcher.h"
 #include "base/timer.h"
 #include "base/flat_map.h"
 #include "base/flat_set.h"
@@ -661,6 +662,13 @@ private:
 		not_null<ChannelData*> channel);
 	void migrateFail(not_null<PeerData*> peer, const RPCError &error);
 
+	void sendPeersRequest(
+		std::vector<not_null<PeerData*>> &&peers,
+		Fn<void()> finish);
+	void sendPeerSettingsRequest(
+		not_null<PeerData*> peer,
+		Fn<void()> finish);
+
 	not_null<Main::Session*> _session;
 
 	base::flat_map<QString, int> _modifyRequests;
@@ -671,13 +679,13 @@ private:
 
 	using PeerRequests = QMap<PeerData*, mtpRequestId>;
 	PeerRequests _fullPeerRequests;
-	PeerRequests _peerRequests;
-	base::flat_set<not_null<PeerData*>> _requestedPeerSettings;
+	Api::RequestBatcher<not_null<PeerData*>> _peerRequests;
+	Api::RequestBatcher<not_null<PeerData*>> _peerSettingsRequests;
 
 	PeerRequests _participantsRequests;
 	PeerRequests _botsRequests;
 	PeerRequests _adminsRequests;
-	base::DelayedCallTimer _participantsCountRequestTimer;
+	Api::RequestBatcher<not_null<ChannelData*>> _participantsCountRequests;
 
 	ChannelData *_channelMembersForAdd = nullptr;
 	mtpRequestId _channelMembersForAddRequestId = 0;
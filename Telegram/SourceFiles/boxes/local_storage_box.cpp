@@ -11,17 +11,23 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/wrap/slide_wrap.h"
 #include "ui/widgets/labels.h"
 #include "ui/widgets/buttons.h"
+#include "ui/widgets/checkbox.h"
 #include "ui/widgets/shadow.h"
 #include "ui/widgets/continuous_sliders.h"
 #include "ui/effects/radial_animation.h"
 #include "ui/text/format_values.h"
 #include "ui/emoji_config.h"
+#include "boxes/confirm_box.h"
 #include "storage/storage_account.h"
+#include "storage/storage_domain.h"
 #include "storage/cache/storage_cache_database.h"
 #include "data/data_session.h"
 #include "lang/lang_keys.h"
 #include "mainwindow.h"
 #include "main/main_session.h"
+#include "main/main_domain.h"
+#include "core/application.h"
+#include "core/core_settings.h"
 #include "styles/style_layers.h"
 #include "styles/style_boxes.h"
 
@@ -400,6 +406,14 @@ void LocalStorageBox::setupControls() {
 	auto summaryTitle = [](size_type) {
 		return tr::lng_local_storage_summary(tr::now);
 	};
+	if (_session->data().usesSharedCache()) {
+		container->add(
+			object_ptr<Ui::FlatLabel>(
+				container,
+				tr::lng_local_storage_shared_all(tr::now),
+				st::boxDividerLabel),
+			st::localStorageSharedMargin);
+	}
 	auto mediaCacheTitle = [](size_type) {
 		return tr::lng_local_storage_media(tr::now);
 	};
@@ -409,6 +423,7 @@ void LocalStorageBox::setupControls() {
 		tr::lng_local_storage_clear(),
 		summary());
 	setupLimits(container);
+	setupSharedCache(container);
 	const auto shadow = container->add(object_ptr<Ui::SlideWrap<>>(
 		container,
 		object_ptr<Ui::PlainShadow>(container),
@@ -559,6 +574,69 @@ void LocalStorageBox::setupLimits(not_null<Ui::VerticalLayout*> container) {
 		});
 }
 
+void LocalStorageBox::setupSharedCache(
+		not_null<Ui::VerticalLayout*> container) {
+	const auto checkbox = container->add(
+		object_ptr<Ui::Checkbox>(
+			container,
+			tr::lng_local_storage_shared(tr::now),
+			Core::App().settings().sharedMediaCache(),
+			st::defaultBoxCheckbox),
+		st::localStorageSharedMargin);
+	checkbox->checkedChanges(
+	) | rpl::start_with_next([=](bool checked) {
+		Core::App().settings().setSharedMediaCache(checked);
+		Core::App().saveSettingsDelayed();
+	}, checkbox->lifetime());
+
+	container->add(
+		object_ptr<Ui::FlatLabel>(
+			container,
+			tr::lng_local_storage_shared_about(tr::now),
+			st::boxDividerLabel),
+		st::localStorageLimitMargin);
+
+	// The caches of the other mode are not opened in this launch.
+	const auto unused = _session->data().usesSharedCache()
+		? QStringList{
+			_session->local().cachePath(),
+			_session->local().cacheBigFilePath(),
+		}
+		: QStringList{ _session->domain().local().sharedCachePath() };
+	const auto exists = ranges::any_of(unused, [](const QString &path) {
+		return QDir(path).exists();
+	});
+	if (!exists) {
+		return;
+	}
+	const auto wrap = container->add(
+		object_ptr<Ui::SlideWrap<Ui::LinkButton>>(
+			container,
+			object_ptr<Ui::LinkButton>(
+				container,
+				tr::lng_local_storage_unused(tr::now),
+				st::boxLinkButton),
+			st::localStorageLimitMargin));
+	wrap->entity()->addClickHandler([=] {
+		auto remove = crl::guard(wrap, [=](Fn<void()> &&close) {
+			crl::async([=] {
+				for (const auto &path : unused) {
+					QDir(path).removeRecursively();
+				}
+			});
+			wrap->hide(anim::type::normal);
+			close();
+		});
+		Ui::show(
+			Box<ConfirmBox>(
+				tr::lng_local_storage_unused_sure(tr::now),
+				tr::lng_local_storage_unused_remove(tr::now),
+				st::attentionBoxButton,
+				std::move(remove)),
+			Ui::LayerOption::KeepOther);
+	});
+}
+
 void LocalStorageBox::limitsChanged() {
 	const auto &settings = _session->local().cacheSettings();
 	const auto &settingsBig = _session->local().cacheBigFileSettings();
@@ -57,6 +57,7 @@ private:
 		const Database::TaggedSummary *data);
 	void setupControls();
 	void setupLimits(not_null<Ui::VerticalLayout*> container);
+	void setupSharedCache(not_null<Ui::VerticalLayout*> container);
 	void updateMediaLimit();
 	void updateTotalLimit();
 	void updateTotalLabel();
@@ -504,28 +504,23 @@ void PasscodeBox::handleSrpIdInvalid() {
 }
 
 void PasscodeBox::save(bool force) {
-	if (_setRequest) return;
+	if (_setRequest || _localPasscodeProcessing) return;
 
 	QString old = _oldPasscode->text(), pwd = _newPasscode->text(), conf = _reenterPasscode->text();
 	const auto has = currentlyHave();
 	if (!_cloudPwd && (_turningOff || has)) {
-		if (!passcodeCanTry()) {
-			_oldError = tr::lng_flood_error(tr::now);
-			_oldPasscode->setFocus();
-			_oldPasscode->showError();
-			update();
-			return;
-		}
-
-		if (Core::App().domain().local().checkPasscode(old.toUtf8())) {
-			cSetPasscodeBadTries(0);
-			if (_turningOff) pwd = conf = QString();
-		} else {
-			cSetPasscodeBadTries(cPasscodeBadTries() + 1);
-			cSetPasscodeLastTry(crl::now());
-			badOldPasscode();
+		if (_checkedOldPasscode != old) {
+			if (!passcodeCanTry()) {
+				_oldError = tr::lng_flood_error(tr::now);
+				_oldPasscode->setFocus();
+				_oldPasscode->showError();
+				update();
+				return;
+			}
+			checkOldPasscode(old, force);
 			return;
 		}
+		if (_turningOff) pwd = conf = QString();
 	}
 	const auto onlyCheck = onlyCheckCurrent();
 	if (!onlyCheck && pwd.isEmpty()) {
@@ -585,14 +580,34 @@ void PasscodeBox::save(bool force) {
 		closeReplacedBy();
 		const auto weak = Ui::MakeWeak(this);
 		cSetPasscodeBadTries(0);
-		Core::App().domain().local().setPasscode(pwd.toUtf8());
-		Core::App().localPasscodeChanged();
-		if (weak) {
-			closeBox();
-		}
+		_localPasscodeProcessing = true;
+		Core::App().domain().local().setPasscode(pwd.toUtf8(), [=] {
+			Core::App().localPasscodeChanged();
+			if (weak) {
+				closeBox();
+			}
+		});
 	}
 }
 
+void PasscodeBox::checkOldPasscode(const QString &old, bool force) {
+	// Key derivation is slow, so it is done on a background thread.
+	_localPasscodeProcessing = true;
+	const auto done = crl::guard(this, [=](bool correct) {
+		_localPasscodeProcessing = false;
+		if (!correct) {
+			cSetPasscodeBadTries(cPasscodeBadTries() + 1);
+			cSetPasscodeLastTry(crl::now());
+			badOldPasscode();
+			return;
+		}
+		cSetPasscodeBadTries(0);
+		_checkedOldPasscode = old;
+		save(force);
+	});
+	Core::App().domain().local().checkPasscode(old.toUtf8(), done);
+}
+
 void PasscodeBox::submitOnlyCheckCloudPassword(const QString &oldPassword) {
 	Expects(!_oldPasscode->isHidden());
 
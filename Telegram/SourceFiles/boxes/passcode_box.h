@@ -74,6 +74,7 @@ private:
 	void newChanged();
 	void emailChanged();
 	void save(bool force = false);
+	void checkOldPasscode(const QString &old, bool force);
 	void badOldPasscode();
 	void recoverByEmail();
 	void recoverExpired();
@@ -139,6 +140,8 @@ private:
 	bool _cloudPwd = false;
 	CloudFields _cloudFields;
 	mtpRequestId _setRequest = 0;
+	std::optional<QString> _checkedOldPasscode;
+	bool _localPasscodeProcessing = false;
 
 	crl::time _lastSrpIdInvalidTime = 0;
 	bool _skipEmailWarning = false;
@@ -1878,6 +1878,7 @@ void StickersBox::Inner::rebuild() {
 		}
 	}
 	for (const auto setId : order) {
+		session().local().readPendingStickerSet(setId);
 		auto it = sets.find(setId);
 		if (it == sets.cend()) {
 			continue;
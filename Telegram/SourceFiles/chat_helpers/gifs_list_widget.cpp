@@ -25,6 +25,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/image/image.h"
 #include "boxes/stickers_box.h"
 #include "inline_bots/inline_bot_result.h"
+#include "inline_bots/inline_bot_results_cache.h"
 #include "storage/localstorage.h"
 #include "lang/lang_keys.h"
 #include "mainwindow.h"
@@ -242,8 +243,8 @@ GifsListWidget::~GifsListWidget() {
 void GifsListWidget::cancelGifsSearch() {
 	_footer->setLoading(false);
 	if (_inlineRequestId) {
-		_api.request(_inlineRequestId).cancel();
-		_inlineRequestId = 0;
+		controller()->session().inlineResultsCache().cancel(
+			base::take(_inlineRequestId));
 	}
 	_inlineRequestTimer.stop();
 	_inlineQuery = _inlineNextQuery = _inlineNextOffset = QString();
@@ -927,8 +928,8 @@ void GifsListWidget::searchForGifs(const QString &query) {
 	if (_inlineQuery != query) {
 		_footer->setLoading(false);
 		if (_inlineRequestId) {
-			_api.request(_inlineRequestId).cancel();
-			_inlineRequestId = 0;
+			controller()->session().inlineResultsCache().cancel(
+				base::take(_inlineRequestId));
 		}
 		if (_inlineCache.find(query) != _inlineCache.cend()) {
 			_inlineRequestTimer.stop();
@@ -992,20 +993,19 @@ void GifsListWidget::sendInlineRequest() {
 	}
 
 	_footer->setLoading(true);
-	_inlineRequestId = _api.request(MTPmessages_GetInlineBotResults(
-		MTP_flags(0),
-		_searchBot->inputUser,
-		_inlineQueryPeer->input,
-		MTPInputGeoPoint(),
-		MTP_string(_inlineQuery),
-		MTP_string(nextOffset)
-	)).done([this](const MTPmessages_BotResults &result) {
-		inlineResultsDone(result);
-	}).fail([this](const RPCError &error) {
-		// show error?
-		_footer->setLoading(false);
-		_inlineRequestId = 0;
-	}).handleAllErrors().send();
+	_inlineRequestId = controller()->session().inlineResultsCache().request(
+		_searchBot,
+		_inlineQueryPeer,
+		_inlineQuery,
+		nextOffset,
+		crl::guard(this, [=](const MTPmessages_BotResults &result) {
+			inlineResultsDone(result);
+		}),
+		crl::guard(this, [=] {
+			// show error?
+			_footer->setLoading(false);
+			_inlineRequestId = 0;
+		}));
 }
 
 void GifsListWidget::refreshRecent() {
@@ -195,7 +195,7 @@ private:
 	mtpRequestId _searchBotRequestId = 0;
 	PeerData *_inlineQueryPeer = nullptr;
 	QString _inlineQuery, _inlineNextQuery, _inlineNextOffset;
-	mtpRequestId _inlineRequestId = 0;
+	uint64 _inlineRequestId = 0;
 
 	rpl::event_stream<TabbedSelector::FileChosen> _fileChosen;
 	rpl::event_stream<TabbedSelector::PhotoChosen> _photoChosen;
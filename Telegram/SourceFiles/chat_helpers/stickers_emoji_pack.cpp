@@ -8,8 +8,11 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "chat_helpers/stickers_emoji_pack.h"
 
 #include "chat_helpers/stickers_emoji_image_loader.h"
+#include "chat_helpers/stickers_lottie.h"
 #include "history/history_item.h"
+#include "history/view/media/history_view_sticker.h"
 #include "lottie/lottie_common.h"
+#include "lottie/lottie_single_player.h"
 #include "ui/emoji_config.h"
 #include "ui/text/text_isolated_emoji.h"
 #include "ui/image/image.h"
@@ -17,6 +20,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_file_origin.h"
 #include "data/data_session.h"
 #include "data/data_document.h"
+#include "data/data_document_media.h"
 #include "core/core_settings.h"
 #include "core/application.h"
 #include "base/call_delayed.h"
@@ -30,6 +34,11 @@ namespace Stickers {
 namespace {
 
 constexpr auto kRefreshTimeout = 7200 * crl::time(1000);
+constexpr auto kStillFramesLimit = 64;
+constexpr auto kPrerenderCount = 8;
+constexpr auto kPrerenderDelay = 5 * crl::time(1000);
+constexpr auto kPrerenderIdleTimeout = 3 * crl::time(1000);
+constexpr auto kPrerenderTimeout = 60 * crl::time(1000);
 
 [[nodiscard]] QSize SingleSize() {
 	const auto single = st::largeEmojiSize;
@@ -100,12 +109,23 @@ constexpr auto kRefreshTimeout = 7200 * crl::time(1000);
 
 } // namespace
 
+struct EmojiPack::Prerender {
+	Sticker sticker;
+	std::shared_ptr<Data::DocumentMedia> media;
+	std::unique_ptr<Lottie::SinglePlayer> player;
+	QSize box;
+	crl::time started = 0;
+	bool finished = false;
+	rpl::lifetime lifetime;
+};
+
 QSize LargeEmojiImage::Size() {
 	return SingleSize();
 }
 
 EmojiPack::EmojiPack(not_null<Main::Session*> session)
-: _session(session) {
+: _session(session)
+, _prerenderTimer([=] { prerenderNext(); }) {
 	refresh();
 
 	session->data().itemRemoved(
@@ -127,7 +147,12 @@ EmojiPack::EmojiPack(not_null<Main::Session*> session)
 	}, _lifetime);
 }
 
-EmojiPack::~EmojiPack() = default;
+EmojiPack::~EmojiPack() {
+	DEBUG_LOG(("Emoji Pack: %1 times shown from still frames, "
+		"%2 emoji pre-rendered."
+		).arg(_stillFramesShown
+		).arg(_prerendered.size()));
+}
 
 bool EmojiPack::add(not_null<HistoryItem*> item) {
 	if (const auto emoji = item->isolatedEmoji()) {
@@ -208,6 +233,142 @@ std::shared_ptr<LargeEmojiImage> EmojiPack::image(EmojiPtr emoji) {
 	return result;
 }
 
+QImage EmojiPack::stillFrame(
+		not_null<DocumentData*> document,
+		const Lottie::ColorReplacements *replacements,
+		QSize box) {
+	const auto i = _stillFrames.find(StickerKey(document, replacements));
+	if (i == end(_stillFrames) || i->second.box != box) {
+		return QImage();
+	}
+	i->second.used = ++_stillFramesUsed;
+	++_stillFramesShown;
+	return i->second.image;
+}
+
+void EmojiPack::rememberStillFrame(
+		not_null<DocumentData*> document,
+		const Lottie::ColorReplacements *replacements,
+		QSize box,
+		const QImage &frame) {
+	if (frame.isNull()) {
+		return;
+	}
+	auto &entry = _stillFrames[StickerKey(document, replacements)];
+	if (entry.box == box && entry.image.cacheKey() == frame.cacheKey()) {
+		return;
+	}
+	entry = StillFrame{
+		.box = box,
+		.image = frame,
+		.used = ++_stillFramesUsed,
+	};
+	if (_stillFrames.size() > kStillFramesLimit) {
+		_stillFrames.erase(ranges::min_element(
+			_stillFrames,
+			ranges::less(),
+			[](const auto &pair) { return pair.second.used; }));
+	}
+}
+
+void EmojiPack::prerenderNext() {
+	// Either the previous one is finished or it has timed out.
+	_prerender = nullptr;
+
+	const auto idle = crl::now() - Core::App().lastNonIdleTime();
+	if (idle < kPrerenderIdleTimeout) {
+		_prerenderTimer.callOnce(kPrerenderIdleTimeout - idle);
+		return;
+	}
+	const auto &recent = GetRecentEmoji();
+	const auto count = std::min(int(recent.size()), kPrerenderCount);
+	for (auto i = 0; i != count; ++i) {
+		const auto sticker = stickerForEmoji(
+			IsolatedEmoji{ { recent[i].first } });
+		if (sticker
+			&& _prerendered.emplace(
+				sticker.document,
+				sticker.replacements).second) {
+			prerender(sticker);
+			return;
+		}
+	}
+}
+
+void EmojiPack::prerender(Sticker sticker) {
+	Expects(sticker.document != nullptr);
+
+	_prerender = std::make_unique<Prerender>();
+	const auto raw = _prerender.get();
+	raw->sticker = sticker;
+	raw->media = sticker.document->createMediaView();
+	raw->started = crl::now();
+	_prerenderTimer.callOnce(kPrerenderTimeout);
+
+	raw->media->checkStickerLarge();
+	if (raw->media->loaded()) {
+		prerenderStart();
+		return;
+	}
+	_session->downloaderTaskFinished(
+	) | rpl::filter([=] {
+		return raw->media->loaded();
+	}) | rpl::take(1) | rpl::start_with_next([=] {
+		prerenderStart();
+	}, raw->lifetime);
+}
+
+void EmojiPack::prerenderStart() {
+	Expects(_prerender != nullptr);
+
+	// Same size and cache key as for the sticker in the chat, so that
+	// the chat reads the frames from the cache instead of rendering.
+	const auto raw = _prerender.get();
+	const auto document = raw->sticker.document;
+	raw->box = HistoryView::Sticker::GetAnimatedEmojiSize(
+		_session,
+		document->dimensions) * cIntRetinaFactor();
+	raw->player = ChatHelpers::LottiePlayerFromDocument(
+		raw->media.get(),
+		raw->sticker.replacements,
+		ChatHelpers::StickerLottieSize::MessageHistory,
+		raw->box,
+		Lottie::Quality::High);
+	raw->player->updates(
+	) | rpl::start_with_next([=] {
+		prerenderStep();
+	}, raw->lifetime);
+}
+
+void EmojiPack::prerenderStep() {
+	Expects(_prerender != nullptr);
+
+	const auto raw = _prerender.get();
+	if (raw->finished || !raw->player->ready()) {
+		return;
+	}
+	auto request = Lottie::FrameRequest();
+	request.box = raw->box;
+	const auto frame = raw->player->frameInfo(request);
+	const auto count = raw->player->information().framesCount;
+	if (!frame.index) {
+		rememberStillFrame(
+			raw->sticker.document,
+			raw->sticker.replacements,
+			raw->box,
+			frame.image);
+	}
+	if (frame.index + 1 < count) {
+		raw->player->markFrameShown();
+		return;
+	}
+	raw->finished = true;
+	DEBUG_LOG(("Emoji Pack: pre-rendered %1 frames in %2 ms."
+		).arg(count
+		).arg(crl::now() - raw->started));
+	_prerenderTimer.callOnce(kPrerenderDelay);
+}
+
 void EmojiPack::refresh() {
 	if (_requestId) {
 		return;
@@ -250,6 +411,9 @@ void EmojiPack::applySet(const MTPDmessages_stickerSet &data) {
 	for (const auto &[emoji, Document] : was) {
 		refreshItems(emoji);
 	}
+	if (!_prerender) {
+		_prerenderTimer.callOnce(kPrerenderDelay);
+	}
 }
 
 void EmojiPack::refreshAll() {
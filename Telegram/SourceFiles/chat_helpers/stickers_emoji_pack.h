@@ -67,8 +67,30 @@ public:
 	[[nodiscard]] Sticker stickerForEmoji(const IsolatedEmoji &emoji);
 	[[nodiscard]] std::shared_ptr<LargeEmojiImage> image(EmojiPtr emoji);
 
+	// The first frame of an animated emoji, shared by all the messages
+	// with that emoji, so that a message that already played it doesn't
+	// need a lottie player to show it again.
+	[[nodiscard]] QImage stillFrame(
+		not_null<DocumentData*> document,
+		const Lottie::ColorReplacements *replacements,
+		QSize box);
+	void rememberStillFrame(
+		not_null<DocumentData*> document,
+		const Lottie::ColorReplacements *replacements,
+		QSize box,
+		const QImage &frame);
+
 private:
 	class ImageLoader;
+	struct StillFrame {
+		QSize box;
+		QImage image;
+		uint64 used = 0;
+	};
+	struct Prerender;
+	using StickerKey = std::pair<
+		not_null<DocumentData*>,
+		const Lottie::ColorReplacements*>;
 
 	void refresh();
 	void refreshDelayed();
@@ -82,6 +104,11 @@ private:
 	void refreshItems(EmojiPtr emoji);
 	void refreshItems(const base::flat_set<not_null<HistoryItem*>> &list);
 
+	void prerenderNext();
+	void prerender(Sticker sticker);
+	void prerenderStart();
+	void prerenderStep();
+
 	not_null<Main::Session*> _session;
 	base::flat_map<EmojiPtr, not_null<DocumentData*>> _map;
 	base::flat_map<
@@ -90,6 +117,14 @@ private:
 	base::flat_map<EmojiPtr, std::weak_ptr<LargeEmojiImage>> _images;
 	mtpRequestId _requestId = 0;
 
+	base::flat_map<StickerKey, StillFrame> _stillFrames;
+	uint64 _stillFramesUsed = 0;
+	int _stillFramesShown = 0;
+
+	base::Timer _prerenderTimer;
+	std::unique_ptr<Prerender> _prerender;
+	base::flat_set<StickerKey> _prerendered;
+
 	rpl::lifetime _lifetime;
 
 };
@@ -80,14 +80,14 @@ struct StickerIcon {
 	}
 
 	void ensureMediaCreated() const {
-		if (!sticker) {
+		if (!set) {
 			return;
 		} else if (set->hasThumbnail()) {
 			if (!thumbnailMedia) {
 				thumbnailMedia = set->createThumbnailView();
 				set->loadThumbnail();
 			}
-		} else if (!stickerMedia) {
+		} else if (sticker && !stickerMedia) {
 			stickerMedia = sticker->createMediaView();
 			stickerMedia->thumbnailWanted(sticker->stickerSetOrigin());
 		}
@@ -355,11 +355,10 @@ void StickersListWidget::Footer::enumerateVisibleIcons(Callback callback) {
 
 void StickersListWidget::Footer::preloadImages() {
 	enumerateVisibleIcons([](const StickerIcon &icon, int x) {
-		if (const auto sticker = icon.sticker) {
-			Assert(icon.set != nullptr);
-			if (icon.set->hasThumbnail()) {
-				icon.set->loadThumbnail();
-			} else {
+		if (const auto set = icon.set) {
+			if (set->hasThumbnail()) {
+				set->loadThumbnail();
+			} else if (const auto sticker = icon.sticker) {
 				sticker->loadThumbnail(sticker->stickerSetOrigin());
 			}
 		}
@@ -741,7 +740,7 @@ void StickersListWidget::Footer::validateIconLottieAnimation(
 		const StickerIcon &icon) {
 	icon.ensureMediaCreated();
 	if (icon.lottie
-		|| !icon.sticker
+		|| !icon.set
 		|| !HasLottieThumbnail(
 			icon.thumbnailMedia.get(),
 			icon.stickerMedia.get())) {
@@ -781,10 +780,9 @@ void StickersListWidget::Footer::paintSetIcon(
 		Painter &p,
 		const StickerIcon &icon,
 		int x) const {
-	if (icon.sticker) {
+	if (icon.set) {
 		icon.ensureMediaCreated();
 		const_cast<Footer*>(this)->validateIconLottieAnimation(icon);
-		const auto origin = icon.sticker->stickerSetOrigin();
 		const auto thumb = icon.thumbnailMedia
 			? icon.thumbnailMedia->image()
 			: icon.stickerMedia
@@ -1083,7 +1081,9 @@ bool StickersListWidget::enumerateSections(Callback callback) const {
 			info.rowsCount = 0;
 			info.rowsBottom = info.rowsTop + _megagroupSetButtonRect.y() + _megagroupSetButtonRect.height() + st::stickerGroupCategoryAddMargin.bottom();
 		} else {
-			info.rowsCount = (info.count / _columnCount) + ((info.count % _columnCount) ? 1 : 0);
+			// Pending sets take their place before the contents are read.
+			const auto count = set.pending ? set.count : info.count;
+			info.rowsCount = (count / _columnCount) + ((count % _columnCount) ? 1 : 0);
 			info.rowsBottom = info.rowsTop + info.rowsCount * _singleSize.height();
 		}
 		if (!callback(info)) {
@@ -1630,6 +1630,9 @@ void StickersListWidget::paintStickers(Painter &p, QRect clip) {
 			auto buttonSelected = (std::get_if<OverGroupAdd>(&_selected) != nullptr);
 			paintMegagroupEmptySet(p, info.rowsTop, buttonSelected);
 			return true;
+		} else if (set.pending) {
+			readVisiblePendingSetsQueued();
+			return true;
 		}
 		auto special = (set.flags & MTPDstickerSet::Flag::f_official) != 0;
 		auto fromRow = floorclamp(clip.y() - info.rowsTop, _singleSize.height(), 0, info.rowsCount);
@@ -1681,6 +1684,61 @@ void StickersListWidget::checkVisibleLottie() {
 	});
 }
 
+void StickersListWidget::readPendingSet(Set &set) {
+	Expects(set.set != nullptr);
+
+	set.pending = false;
+	session().local().readPendingStickerSet(set.id);
+	set.stickers = PrepareStickers(set.set->stickers);
+	set.count = set.set->count;
+}
+
+void StickersListWidget::readVisiblePendingSetsQueued() {
+	if (_readPendingSetsQueued) {
+		return;
+	}
+	_readPendingSetsQueued = true;
+	crl::on_main(this, [=] {
+		_readPendingSetsQueued = false;
+		readVisiblePendingSets();
+	});
+}
+
+void StickersListWidget::readVisiblePendingSets() {
+	if (_section != Section::Stickers) {
+		return;
+	}
+	const auto visibleTop = getVisibleTop();
+	const auto visibleBottom = getVisibleBottom();
+	auto sections = std::vector<int>();
+	enumerateSections([&](const SectionInfo &info) {
+		if (info.top >= visibleBottom) {
+			return false;
+		} else if (info.rowsBottom > visibleTop
+			&& _mySets[info.section].pending) {
+			sections.push_back(info.section);
+		}
+		return true;
+	});
+	if (sections.empty()) {
+		return;
+	}
+	auto layoutChanged = false;
+	for (const auto section : sections) {
+		auto &set = _mySets[section];
+		const auto wasCount = set.count;
+		readPendingSet(set);
+		if (int(set.stickers.size()) != wasCount) {
+			layoutChanged = true;
+		}
+	}
+	if (layoutChanged) {
+		resizeToWidth(width());
+	}
+	updateSelected();
+	update();
+}
+
 void StickersListWidget::clearHeavyIn(Set &set, bool clearSavedFrames) {
 	const auto player = base::take(set.lottiePlayer);
 	const auto lifetime = base::take(set.lottieLifetime);
@@ -2347,7 +2405,13 @@ void StickersListWidget::refreshMySets() {
 	refreshMegagroupStickers(GroupStickersPlace::Visible);
 	for (const auto setId : session().data().stickers().setsOrder()) {
 		const auto externalLayout = false;
-		appendSet(_mySets, setId, externalLayout, AppendSkip::Archived);
+		if (appendSet(_mySets, setId, externalLayout, AppendSkip::Archived)) {
+			auto &set = _mySets.back();
+			if (set.pending && !set.set->hasThumbnail()) {
+				// The footer icon of such set is its first sticker.
+				readPendingSet(set);
+			}
+		}
 	}
 	refreshMegagroupStickers(GroupStickersPlace::Hidden);
 
@@ -2452,11 +2516,16 @@ bool StickersListWidget::appendSet(
 		AppendSkip skip) {
 	const auto &sets = session().data().stickers().sets();
 	auto it = sets.find(setId);
-	if (it == sets.cend()
-		|| (!externalLayout && it->second->stickers.isEmpty())) {
+	if (it == sets.cend()) {
 		return false;
 	}
 	const auto set = it->second.get();
+	const auto pending = !externalLayout
+		&& set->stickers.isEmpty()
+		&& session().local().hasPendingStickerSet(setId);
+	if (!externalLayout && set->stickers.isEmpty() && !pending) {
+		return false;
+	}
 	if ((skip == AppendSkip::Archived)
 		&& (set->flags & MTPDstickerSet::Flag::f_archived)) {
 		return false;
@@ -2479,6 +2548,7 @@ bool StickersListWidget::appendSet(
 		PrepareStickers((set->stickers.empty() && externalLayout)
 			? set->covers
 			: set->stickers));
+	to.back().pending = pending;
 	return true;
 }
 
@@ -2720,14 +2790,16 @@ std::vector<StickerIcon> StickersListWidget::fillIcons() {
 		}
 		const auto set = _mySets[i].set;
 		Assert(set != nullptr);
-		const auto s = _mySets[i].stickers[0].document;
+		const auto s = _mySets[i].stickers.empty()
+			? nullptr
+			: _mySets[i].stickers.front().document.get();
 		const auto availw = st::stickerIconWidth - 2 * st::stickerIconPadding;
 		const auto availh = st::emojiFooterHeight - 2 * st::stickerIconPadding;
 		const auto size = set->hasThumbnail()
 			? QSize(
 				set->thumbnailLocation().width(),
 				set->thumbnailLocation().height())
-			: s->hasThumbnail()
+			: (s && s->hasThumbnail())
 			? QSize(
 				s->thumbnailLocation().width(),
 				s->thumbnailLocation().height())
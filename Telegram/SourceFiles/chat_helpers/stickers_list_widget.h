@@ -211,6 +211,7 @@ private:
 
 		int count = 0;
 		bool externalLayout = false;
+		bool pending = false; // Contents are not read from local storage.
 	};
 	struct FeaturedSet {
 		uint64 id = 0;
@@ -289,6 +290,9 @@ private:
 	void takeHeavyData(Sticker &to, Sticker &from);
 	void clearHeavyIn(Set &set, bool clearSavedFrames = true);
 	void clearHeavyData();
+	void readPendingSet(Set &set);
+	void readVisiblePendingSetsQueued();
+	void readVisiblePendingSets();
 
 	int stickersRight() const;
 	bool featuredHasAddButton(int index) const;
@@ -350,6 +354,7 @@ private:
 	Section _section = Section::Stickers;
 
 	bool _displayingSet = false;
+	bool _readPendingSetsQueued = false;
 	uint64 _removingSetId = 0;
 
 	Footer *_footer = nullptr;
@@ -22,6 +22,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/launcher.h"
 #include "core/ui_integration.h"
 #include "core/core_settings.h"
+#include "core/core_startup_trace.h"
 #include "chat_helpers/emoji_keywords.h"
 #include "chat_helpers/stickers_emoji_image_loader.h"
 #include "base/platform/base_platform_info.h"
@@ -64,6 +65,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/serialize_common.h"
 #include "storage/storage_domain.h"
 #include "storage/storage_databases.h"
+#include "data/data_userpic_atlas.h"
 #include "storage/localstorage.h"
 #include "export/export_manager.h"
 #include "window/window_session_controller.h"
@@ -79,6 +81,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <QtWidgets/QDesktopWidget>
 #include <QtCore/QMimeDatabase>
+#include <QtCore/QDir>
 #include <QtGui/QGuiApplication>
 #include <QtGui/QScreen>
 
@@ -88,6 +91,56 @@ namespace {
 constexpr auto kQuitPreventTimeoutMs = crl::time(1500);
 constexpr auto kAutoLockTimeoutLateMs = crl::time(3000);
 constexpr auto kClearEmojiImageSourceTimeout = 10 * crl::time(1000);
+constexpr auto kPrefetchFileSizeLimit = 1024 * 1024;
+constexpr auto kPrefetchTotalSizeLimit = 8 * 1024 * 1024;
+
+// Accounts keep the files read on launch in folders named by the
+// hex key of their data name. Media caches live in other folders.
+[[nodiscard]] bool IsAccountDataFolder(const QString &name) {
+	constexpr auto kNameLength = 16;
+	if (name.size() != kNameLength) {
+		return false;
+	}
+	for (const auto ch : name) {
+		if (!(ch >= '0' && ch <= '9') && !(ch >= 'A' && ch <= 'F')) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Reads local storage files once, so that on a cold disk cache the
+// following sequential reads on the main thread are served from memory.
+// Only the settings, keys and account data folders are read, media
+// caches are skipped.
+void PrefetchLocalStorageFiles(const QString &basePath) {
+	const auto phase = StartupTrace::Phase("prefetch_local_storage");
+	auto left = int64(kPrefetchTotalSizeLimit);
+	const auto prefetch = [&](const QString &path) {
+		const auto list = QDir(path).entryInfoList(
+			QDir::Files | QDir::NoDotAndDotDot);
+		for (const auto &info : list) {
+			const auto size = info.size();
+			if (size > kPrefetchFileSizeLimit || size > left) {
+				continue;
+			}
+			auto f = QFile(info.absoluteFilePath());
+			if (f.open(QIODevice::ReadOnly)) {
+				left -= f.readAll().size();
+			}
+		}
+	};
+	prefetch(basePath);
+	const auto folders = QDir(basePath).entryInfoList(
+		QDir::Dirs | QDir::NoDotAndDotDot);
+	for (const auto &info : folders) {
+		if (left <= 0) {
+			break;
+		} else if (IsAccountDataFolder(info.fileName())) {
+			prefetch(info.absoluteFilePath());
+		}
+	}
+}
 
 } // namespace
 
@@ -114,6 +167,7 @@ Application::Application(not_null<Launcher*> launcher)
 , _langpack(std::make_unique<Lang::Instance>())
 , _langCloudManager(std::make_unique<Lang::CloudManager>(langpack()))
 , _emojiKeywords(std::make_unique<ChatHelpers::EmojiKeywords>())
+, _userpicAtlas(std::make_unique<Data::UserpicAtlas>())
 , _logo(Window::LoadLogo())
 , _logoNoMargin(Window::LoadLogoNoMargin())
 , _autoLockTimer([=] { checkAutoLock(); }) {
@@ -139,6 +193,14 @@ Application::Application(not_null<Launcher*> launcher)
 		}
 	}, _lifetime);
 
+	_domain->activeSessionChanges(
+	) | rpl::filter(
+		rpl::mappers::_1 == nullptr
+	) | rpl::start_with_next([=] {
+		// Don't keep the userpics of the logged out session.
+		_userpicAtlas->clear();
+	}, _lifetime);
+
 	_domain->activeValue(
 	) | rpl::filter(rpl::mappers::_1 != nullptr
 	) | rpl::take(1) | rpl::start_with_next([=] {
@@ -166,6 +228,7 @@ Application::~Application() {
 
 	Ui::Emoji::Clear();
 	Media::Clip::Finish();
+	_userpicAtlas->clear();
 
 	App::deinitMedia();
 
@@ -181,8 +244,24 @@ Application::~Application() {
 }
 
 void Application::run() {
+	// Independent warm-ups run on background threads in parallel with
+	// the main thread initialization. They don't need to be joined:
+	// QMimeDatabase is internally synchronized and prefetched files
+	// are only used to fill the OS disk cache.
+	crl::async([basePath = cWorkingDir() + u"tdata/"_q] {
+		PrefetchLocalStorageFiles(basePath);
+	});
+	crl::async([] {
+		const auto phase = StartupTrace::Phase("mime_database");
+
+		// Create mime database, so it won't be slow later.
+		QMimeDatabase().mimeTypeForName(qsl("text/plain"));
+	});
+
+	auto phase = std::make_unique<StartupTrace::Phase>("fonts");
 	style::internal::StartFonts();
 
+	phase = std::make_unique<StartupTrace::Phase>("third_party");
 	ThirdParty::start();
 	Global::start();
 	refreshGlobalProxy(); // Depends on Global::start().
@@ -191,6 +270,7 @@ void Application::run() {
 	// Depends on notifications settings.
 	_notifications = std::make_unique<Window::Notifications::System>();
 
+	phase = std::make_unique<StartupTrace::Phase>("local_storage");
 	startLocalStorage();
 	ValidateScale();
 
@@ -210,13 +290,19 @@ void Application::run() {
 
 	Core::App().settings().setWindowControlsLayout(Platform::WindowControlsLayout());
 
+	phase = std::make_unique<StartupTrace::Phase>("translator");
 	_translator = std::make_unique<Lang::Translator>();
 	QCoreApplication::instance()->installTranslator(_translator.get());
 
+	phase = std::make_unique<StartupTrace::Phase>("style_manager");
 	style::startManager(cScale());
 	Ui::InitTextOptions();
+
+	phase = std::make_unique<StartupTrace::Phase>("emoji");
 	Ui::Emoji::Init();
 	startEmojiImageLoader();
+
+	phase = std::make_unique<StartupTrace::Phase>("media_player");
 	startSystemDarkModeViewer();
 	Media::Player::start(_audio.get());
 
@@ -235,9 +321,7 @@ void Application::run() {
 
 	DEBUG_LOG(("Application Info: starting app..."));
 
-	// Create mime database, so it won't be slow later.
-	QMimeDatabase().mimeTypeForName(qsl("text/plain"));
-
+	phase = std::make_unique<StartupTrace::Phase>("window");
 	_window = std::make_unique<Window::Controller>();
 
 	_domain->activeChanges(
@@ -261,8 +345,11 @@ void Application::run() {
 	// Depend on activeWindow() for now :(
 	startShortcuts();
 	App::initMedia();
+
+	phase = std::make_unique<StartupTrace::Phase>("domain");
 	startDomain();
 
+	phase = std::make_unique<StartupTrace::Phase>("window_show");
 	_window->widget()->show();
 
 	const auto currentGeometry = _window->widget()->geometry();
@@ -277,10 +364,18 @@ void Application::run() {
 	}
 
 	_window->updateIsActiveFocus();
+	phase = nullptr;
 
 	for (const auto &error : Shortcuts::Errors()) {
 		LOG(("Shortcuts Error: %1").arg(error));
 	}
+
+	if (StartupTrace::Enabled()) {
+		// Finish after the first frame of the window was painted.
+		crl::on_main(this, [] {
+			StartupTrace::Finish();
+		});
+	}
 }
 
 void Application::startDomain() {
@@ -85,6 +85,7 @@ class CloudManager;
 
 namespace Data {
 struct CloudTheme;
+class UserpicAtlas;
 } // namespace Data
 
 namespace Stickers {
@@ -223,6 +224,11 @@ public:
 		return _emojiImageLoader;
 	}
 
+	// Userpics prepared for painting.
+	[[nodiscard]] Data::UserpicAtlas &userpicAtlas() {
+		return *_userpicAtlas;
+	}
+
 	// Internal links.
 	void checkStartUrl();
 	bool openLocalUrl(const QString &url, QVariant context);
@@ -351,6 +357,7 @@ private:
 	const std::unique_ptr<Lang::Instance> _langpack;
 	const std::unique_ptr<Lang::CloudManager> _langCloudManager;
 	const std::unique_ptr<ChatHelpers::EmojiKeywords> _emojiKeywords;
+	const std::unique_ptr<Data::UserpicAtlas> _userpicAtlas;
 	std::unique_ptr<Lang::Translator> _translator;
 	base::Observable<void> _passcodedChanged;
 	QPointer<Ui::BoxContent> _badProxyDisableBox;
@@ -34,7 +34,7 @@ QByteArray Settings::serialize() const {
 		+ Serialize::stringSize(_callOutputDeviceId)
 		+ Serialize::stringSize(_callInputDeviceId)
 		+ Serialize::stringSize(_callVideoInputDeviceId)
-		+ sizeof(qint32) * 3;
+		+ sizeof(qint32) * 4;
 	for (const auto &[key, value] : _soundOverrides) {
 		size += Serialize::stringSize(key) + Serialize::stringSize(value);
 	}
@@ -112,7 +112,8 @@ QByteArray Settings::serialize() const {
 			<< qint32(_ipRevealWarning ? 1 : 0)
 			<< qint32(_groupCallPushToTalk ? 1 : 0)
 			<< _groupCallPushToTalkShortcut
-			<< qint64(_groupCallPushToTalkDelay);
+			<< qint64(_groupCallPushToTalkDelay)
+			<< qint32(_sharedMediaCache ? 1 : 0);
 	}
 	return result;
 }
@@ -183,6 +184,7 @@ void Settings::addFromSerialized(const QByteArray &serialized) {
 	qint32 groupCallPushToTalk = _groupCallPushToTalk ? 1 : 0;
 	QByteArray groupCallPushToTalkShortcut = _groupCallPushToTalkShortcut;
 	qint64 groupCallPushToTalkDelay = _groupCallPushToTalkDelay;
+	qint32 sharedMediaCache = _sharedMediaCache ? 1 : 0;
 
 	stream >> themesAccentColors;
 	if (!stream.atEnd()) {
@@ -275,6 +277,9 @@ void Settings::addFromSerialized(const QByteArray &serialized) {
 			>> groupCallPushToTalkShortcut
 			>> groupCallPushToTalkDelay;
 	}
+	if (!stream.atEnd()) {
+		stream >> sharedMediaCache;
+	}
 	if (stream.status() != QDataStream::Ok) {
 		LOG(("App Error: "
 			"Bad data for Core::Settings::constructFromSerialized()"));
@@ -369,6 +374,7 @@ void Settings::addFromSerialized(const QByteArray &serialized) {
 	_groupCallPushToTalk = (groupCallPushToTalk == 1);
 	_groupCallPushToTalkShortcut = groupCallPushToTalkShortcut;
 	_groupCallPushToTalkDelay = groupCallPushToTalkDelay;
+	_sharedMediaCache = _sharedMediaCacheActive = (sharedMediaCache == 1);
 }
 
 bool Settings::chatWide() const {
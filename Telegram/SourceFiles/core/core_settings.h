@@ -279,6 +279,16 @@ public:
 	void setIpRevealWarning(bool warning) {
 		_ipRevealWarning = warning;
 	}
+	[[nodiscard]] bool sharedMediaCache() const {
+		return _sharedMediaCache;
+	}
+	void setSharedMediaCache(bool shared) {
+		_sharedMediaCache = shared;
+	}
+	// The value read on launch, changes take effect after restart.
+	[[nodiscard]] bool sharedMediaCacheActive() const {
+		return _sharedMediaCacheActive;
+	}
 	[[nodiscard]] bool loopAnimatedStickers() const {
 		return _loopAnimatedStickers;
 	}
@@ -541,6 +551,8 @@ private:
 	base::flat_map<QString, QString> _soundOverrides;
 	bool _exeLaunchWarning = true;
 	bool _ipRevealWarning = true;
+	bool _sharedMediaCache = false;
+	bool _sharedMediaCacheActive = false;
 	bool _loopAnimatedStickers = true;
 	rpl::variable<bool> _largeEmoji = true;
 	rpl::variable<bool> _replaceEmoji = true;
@@ -0,0 +1,161 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/core_startup_trace.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+#include <mutex>
+#include <thread>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else // Q_OS_WIN
+#include <time.h>
+#endif // Q_OS_WIN
+
+namespace Core::StartupTrace {
+namespace {
+
+struct Event {
+	QString name;
+	crl::time wallStarted = 0;
+	crl::time wallDuration = 0;
+	int64 cpuDuration = 0;
+	uint64 thread = 0;
+};
+
+struct State {
+	crl::time started = 0;
+	std::mutex mutex;
+	std::vector<Event> events;
+	std::atomic<bool> enabled = false;
+};
+
+State GlobalState;
+
+[[nodiscard]] int64 ThreadCpuTimeMicroseconds() {
+#ifdef Q_OS_WIN
+	auto creation = FILETIME();
+	auto exit = FILETIME();
+	auto kernel = FILETIME();
+	auto user = FILETIME();
+	if (!GetThreadTimes(
+			GetCurrentThread(),
+			&creation,
+			&exit,
+			&kernel,
+			&user)) {
+		return 0;
+	}
+	const auto value = [](const FILETIME &time) {
+		return (int64(time.dwHighDateTime) << 32) | int64(time.dwLowDateTime);
+	};
+	return (value(kernel) + value(user)) / 10; // 100ns intervals.
+#else // Q_OS_WIN
+	auto spec = timespec();
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &spec) != 0) {
+		return 0;
+	}
+	return int64(spec.tv_sec) * 1000000 + int64(spec.tv_nsec) / 1000;
+#endif // Q_OS_WIN
+}
+
+[[nodiscard]] uint64 CurrentThreadId() {
+	return uint64(std::hash<std::thread::id>()(std::this_thread::get_id()));
+}
+
+} // namespace
+
+void Start() {
+	GlobalState.started = crl::now();
+	GlobalState.enabled = true;
+}
+
+bool Enabled() {
+	return GlobalState.enabled;
+}
+
+void Finish() {
+	if (!GlobalState.enabled.exchange(false)) {
+		return;
+	}
+	auto events = [&] {
+		auto lock = std::unique_lock(GlobalState.mutex);
+		return base::take(GlobalState.events);
+	}();
+
+	const auto main = CurrentThreadId();
+	auto threads = base::flat_map<uint64, int>{ { main, 1 } };
+	auto list = QJsonArray();
+	for (const auto &event : events) {
+		const auto i = threads.emplace(
+			event.thread,
+			int(threads.size()) + 1).first;
+		auto args = QJsonObject();
+		args.insert("cpu_ms", event.cpuDuration / 1000.);
+		auto object = QJsonObject();
+		object.insert("name", event.name);
+		object.insert("cat", "startup");
+		object.insert("ph", "X");
+		object.insert("pid", 1);
+		object.insert("tid", i->second);
+		object.insert("ts", double(event.wallStarted * 1000));
+		object.insert("dur", double(event.wallDuration * 1000));
+		object.insert("args", args);
+		list.append(object);
+
+		LOG(("Startup Trace: %1 took %2 ms wall, %3 ms cpu."
+			).arg(event.name
+			).arg(event.wallDuration
+			).arg(event.cpuDuration / 1000));
+	}
+	auto root = QJsonObject();
+	root.insert("traceEvents", list);
+	root.insert("displayTimeUnit", "ms");
+
+	auto f = QFile(cWorkingDir() + u"startup_trace.json"_q);
+	if (f.open(QIODevice::WriteOnly)) {
+		f.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+	} else {
+		LOG(("Startup Trace Error: Could not write '%1'.").arg(f.fileName()));
+	}
+}
+
+Phase::Phase(const char *name)
+: _name(GlobalState.enabled ? name : nullptr)
+, _wallStarted(_name ? crl::now() : 0)
+, _cpuStarted(_name ? ThreadCpuTimeMicroseconds() : 0) {
+}
+
+Phase::~Phase() {
+	finish();
+}
+
+void Phase::finish() {
+	if (!_name) {
+		return;
+	}
+	const auto name = base::take(_name);
+	if (!GlobalState.enabled) {
+		return;
+	}
+	auto event = Event{
+		.name = QString::fromLatin1(name),
+		.wallStarted = _wallStarted - GlobalState.started,
+		.wallDuration = crl::now() - _wallStarted,
+		.cpuDuration = ThreadCpuTimeMicroseconds() - _cpuStarted,
+		.thread = CurrentThreadId(),
+	};
+	auto lock = std::unique_lock(GlobalState.mutex);
+	GlobalState.events.push_back(std::move(event));
+}
+
+} // namespace Core::StartupTrace
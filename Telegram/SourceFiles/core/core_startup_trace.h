@@ -0,0 +1,37 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core::StartupTrace {
+
+// Enabled by the "-tracestartup" command line argument.
+// Collects wall and thread CPU time for each startup phase and writes
+// them to "startup_trace.json" (Chrome trace format) in the working dir.
+void Start();
+[[nodiscard]] bool Enabled();
+
+// Writes the collected events, further phases are ignored.
+void Finish();
+
+class Phase final {
+public:
+	explicit Phase(const char *name);
+	Phase(const Phase &other) = delete;
+	Phase &operator=(const Phase &other) = delete;
+	~Phase();
+
+	void finish();
+
+private:
+	const char *_name = nullptr;
+	crl::time _wallStarted = 0;
+	int64 _cpuStarted = 0;
+
+};
+
+} // namespace Core::StartupTrace
@@ -14,7 +14,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/main_queue_processor.h"
 #include "ui/ui_utility.h"
 #include "core/crash_reports.h"
+#include "core/core_startup_trace.h"
 #include "core/update_checker.h"
+#include "mtproto/details/mtproto_conditioned_socket.h"
 #include "core/sandbox.h"
 #include "base/concurrent_timer.h"
 
@@ -454,6 +456,8 @@ void Launcher::processArguments() {
 		{ "-workdir"        , KeyFormat::OneValue },
 		{ "--"              , KeyFormat::OneValue },
 		{ "-scale"          , KeyFormat::OneValue },
+		{ "-tracestartup"   , KeyFormat::NoValues },
+		{ "-netconditions"  , KeyFormat::OneValue },
 	};
 	auto parseResult = QMap<QByteArray, QStringList>();
 	auto parsingKey = QByteArray();
@@ -481,6 +485,16 @@ void Launcher::processArguments() {
 	if (parseResult.contains("-externalupdater")) {
 		SetUpdaterDisabledAtStartup();
 	}
+	if (parseResult.contains("-tracestartup")) {
+		StartupTrace::Start();
+	}
+	const auto conditions = parseResult.value(
+		"-netconditions",
+		{}).join(QString());
+	if (!conditions.isEmpty()) {
+		MTP::details::SetNetworkConditions(
+			MTP::details::ParseNetworkConditions(conditions));
+	}
 	gUseFreeType = parseResult.contains("-freetype");
 	gDebugMode = parseResult.contains("-debug");
 	gManyInstance = parseResult.contains("-many");
@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "data/data_folder.h"
 #include "data/data_histories.h"
+#include "data/data_changes.h"
 #include "dialogs/dialogs_main_list.h"
 #include "ui/ui_utility.h"
 #include "main/main_session.h"
@@ -27,6 +28,18 @@ constexpr auto kRefreshSuggestedTimeout = 7200 * crl::time(1000);
 constexpr auto kLoadExceptionsAfter = 100;
 constexpr auto kLoadExceptionsPerRequest = 100;
 
+[[nodiscard]] ChatFilter::Flags AllFilterFlags() {
+	using Flag = ChatFilter::Flag;
+	return Flag::Contacts
+		| Flag::NonContacts
+		| Flag::Groups
+		| Flag::Channels
+		| Flag::Bots
+		| Flag::NoMuted
+		| Flag::NoRead
+		| Flag::NoArchived;
+}
+
 } // namespace
 
 ChatFilter::ChatFilter(
@@ -217,9 +230,24 @@ bool ChatFilter::contains(not_null<History*> history) const {
 
 ChatFilters::ChatFilters(not_null<Session*> owner) : _owner(owner) {
 	crl::on_main(&owner->session(), [=] { load(); });
+
+	owner->session().changes().peerUpdates(
+		PeerUpdate::Flag::IsContact
+	) | rpl::start_with_next([=](const PeerUpdate &update) {
+		if (const auto history = _owner->historyLoaded(update.peer)) {
+			using Flag = ChatFilter::Flag;
+			refreshHistory(
+				history,
+				Flag::Contacts | Flag::NonContacts | Flag::Bots);
+		}
+	}, _lifetime);
 }
 
-ChatFilters::~ChatFilters() = default;
+ChatFilters::~ChatFilters() {
+	DEBUG_LOG(("Chat Filters: %1 checks requested, %2 done."
+		).arg(_refreshChecksRequested
+		).arg(_refreshChecksDone));
+}
 
 not_null<Dialogs::MainList*> ChatFilters::chatsList(FilterId filterId) {
 	auto &pointer = _chatsLists[filterId];
@@ -563,8 +591,41 @@ bool ChatFilters::loadNextExceptions(bool chatsListLoaded) {
 }
 
 void ChatFilters::refreshHistory(not_null<History*> history) {
-	if (history->inChatList() && !list().empty()) {
-		_owner->refreshChatListEntry(history);
+	refreshHistory(history, AllFilterFlags());
+}
+
+void ChatFilters::refreshHistory(
+		not_null<History*> history,
+		ChatFilter::Flags changed) {
+	if (!history->inChatList() || _list.empty()) {
+		return;
+	}
+	_refreshChecksRequested += _list.size();
+	auto &flags = _refreshes[history];
+	flags |= changed;
+	if (_refreshesScheduled) {
+		return;
+	}
+	_refreshesScheduled = true;
+	crl::on_main(&_owner->session(), [=] {
+		processRefreshes();
+	});
+}
+
+void ChatFilters::processRefreshes() {
+	_refreshesScheduled = false;
+	const auto refreshes = base::take(_refreshes);
+	const auto all = AllFilterFlags();
+	for (const auto &filter : _list) {
+		const auto flags = filter.flags();
+		for (const auto &[history, changed] : refreshes) {
+			// Histories could've been removed from the chats list already.
+			if (((changed == all) || (flags & changed))
+				&& history->inChatList()) {
+				++_refreshChecksDone;
+				_owner->refreshChatListEntry(history, filter);
+			}
+		}
 	}
 }
 
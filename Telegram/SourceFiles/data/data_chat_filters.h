@@ -106,7 +106,12 @@ public:
 
 	bool loadNextExceptions(bool chatsListLoaded);
 
+	// Filters are checked again on the next event loop iteration, only
+	// the ones depending on the changed flags (chat types or conditions).
 	void refreshHistory(not_null<History*> history);
+	void refreshHistory(
+		not_null<History*> history,
+		ChatFilter::Flags changed);
 
 	[[nodiscard]] not_null<Dialogs::MainList*> chatsList(FilterId filterId);
 
@@ -132,6 +137,7 @@ private:
 	bool applyChange(ChatFilter &filter, ChatFilter &&updated);
 	void applyInsert(ChatFilter filter, int position);
 	void applyRemove(int position);
+	void processRefreshes();
 
 	const not_null<Session*> _owner;
 
@@ -151,6 +157,13 @@ private:
 	std::deque<FilterId> _exceptionsToLoad;
 	mtpRequestId _exceptionsLoadRequestId = 0;
 
+	base::flat_map<not_null<History*>, ChatFilter::Flags> _refreshes;
+	bool _refreshesScheduled = false;
+	int64 _refreshChecksRequested = 0;
+	int64 _refreshChecksDone = 0;
+
+	rpl::lifetime _lifetime;
+
 };
 
 } // namespace Data
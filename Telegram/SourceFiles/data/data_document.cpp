@@ -746,6 +746,10 @@ Storage::Cache::Key DocumentData::goodThumbnailCacheKey() const {
 	return Data::DocumentThumbCacheKey(_dc, id);
 }
 
+Storage::Cache::Key DocumentData::waveformCacheKey() const {
+	return Data::DocumentWaveformCacheKey(_dc, id);
+}
+
 bool DocumentData::goodThumbnailChecked() const {
 	return (_goodThumbnailState & GoodThumbnailFlag::Mask)
 		== GoodThumbnailFlag::Checked;
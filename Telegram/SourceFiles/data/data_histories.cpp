@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_scheduled_messages.h"
 #include "main/main_session.h"
 #include "window/notifications_manager.h"
+#include "window/window_session_controller.h"
 #include "history/history.h"
 #include "history/history_item.h"
 #include "history/view/history_view_element.h"
@@ -23,12 +24,68 @@ namespace Data {
 namespace {
 
 constexpr auto kReadRequestTimeout = 3 * crl::time(1000);
+constexpr auto kMemoryCheckDelay = 30 * crl::time(1000);
+
+// Only views are counted and unloaded. Items stay, because they are
+// referenced from the chats list, replies, pinned and shared media.
+constexpr auto kViewsLimit = 30000;
+constexpr auto kReportHistoriesCount = 20;
+
+// Unload a bit more than required, so that we don't do that
+// again right after the next slice is loaded somewhere.
+constexpr auto kUnloadTillPercent = 75;
+
+struct HistoryFootprint {
+	not_null<History*> history;
+	int blocks = 0;
+	int views = 0;
+	crl::time lastShown = 0;
+};
+
+[[nodiscard]] HistoryFootprint CountFootprint(
+		not_null<History*> history,
+		crl::time lastShown) {
+	auto result = HistoryFootprint{
+		.history = history,
+		.blocks = int(history->blocks.size()),
+		.lastShown = lastShown,
+	};
+	for (const auto &block : history->blocks) {
+		result.views += int(block->messages.size());
+	}
+	return result;
+}
+
+template <typename Map>
+[[nodiscard]] std::vector<HistoryFootprint> CollectLoaded(
+		const Map &map,
+		const base::flat_map<not_null<History*>, crl::time> &lastShown) {
+	auto result = std::vector<HistoryFootprint>();
+	for (const auto &[peerId, history] : map) {
+		if (history->blocks.empty()) {
+			continue;
+		}
+		const auto i = lastShown.find(history.get());
+		const auto when = (i != end(lastShown)) ? i->second : 0;
+		result.push_back(CountFootprint(history.get(), when));
+	}
+	return result;
+}
+
+[[nodiscard]] int CountViews(const std::vector<HistoryFootprint> &list) {
+	return ranges::accumulate(
+		list,
+		0,
+		ranges::plus(),
+		&HistoryFootprint::views);
+}
 
 } // namespace
 
 Histories::Histories(not_null<Session*> owner)
 : _owner(owner)
-, _readRequestsTimer([=] { sendReadRequests(); }) {
+, _readRequestsTimer([=] { sendReadRequests(); })
+, _memoryCheckTimer([=] { checkMemory(); }) {
 }
 
 Session &Histories::owner() const {
@@ -63,9 +120,98 @@ void Histories::unloadAll() {
 }
 
 void Histories::clearAll() {
+	_lastShown.clear();
 	_map.clear();
 }
 
+void Histories::shownHistoryChanged(History *was, History *now) {
+	const auto time = crl::now();
+	if (was) {
+		_lastShown[was] = time;
+	}
+	if (now) {
+		_lastShown[now] = time;
+	}
+}
+
+void Histories::historyUnloaded(not_null<History*> history) {
+	_lastShown.remove(history);
+}
+
+void Histories::viewsAdded() {
+	if (!_memoryCheckTimer.isActive()) {
+		_memoryCheckTimer.callOnce(kMemoryCheckDelay);
+	}
+}
+
+bool Histories::unloadLocked(not_null<History*> history) const {
+	// The chat history and the replies section both set the active chat.
+	for (const auto controller : session().windows()) {
+		const auto active = controller->activeChatCurrent().history();
+		if (!active) {
+			continue;
+		}
+		const auto shown = active->migrateToOrMe();
+		if (history == shown || history == shown->migrateFrom()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void Histories::checkMemory() {
+	auto loaded = CollectLoaded(_map, _lastShown);
+	auto total = CountViews(loaded);
+	if (total <= kViewsLimit) {
+		return;
+	}
+	logMemoryReport();
+	ranges::sort(loaded, ranges::less(), &HistoryFootprint::lastShown);
+
+	const auto unloadTill = kViewsLimit * kUnloadTillPercent / 100;
+	const auto wasTotal = total;
+	auto unloaded = 0;
+	for (const auto &footprint : loaded) {
+		if (total <= unloadTill) {
+			break;
+		} else if (unloadLocked(footprint.history)) {
+			continue;
+		}
+		footprint.history->clear(History::ClearType::Unload);
+		total -= footprint.views;
+		++unloaded;
+	}
+	LOG(("Histories: Unloaded %1 of %2 histories, views %3 -> %4."
+		).arg(unloaded
+		).arg(loaded.size()
+		).arg(wasTotal
+		).arg(total));
+}
+
+void Histories::logMemoryReport() const {
+	auto loaded = CollectLoaded(_map, _lastShown);
+	const auto total = CountViews(loaded);
+	ranges::sort(loaded, ranges::greater(), &HistoryFootprint::views);
+
+	LOG(("Histories Memory: %1 histories, %2 loaded, %3 views, limit %4."
+		).arg(_map.size()
+		).arg(loaded.size()
+		).arg(total
+		).arg(kViewsLimit));
+	const auto now = crl::now();
+	const auto count = std::min(int(loaded.size()), kReportHistoriesCount);
+	for (const auto &footprint : loaded | ranges::views::take(count)) {
+		LOG(("Histories Memory: %1 - %2 views in %3 blocks, %4."
+			).arg(footprint.history->peer->name
+			).arg(footprint.views
+			).arg(footprint.blocks
+			).arg(footprint.lastShown
+				? QString("shown %1 s ago"
+				).arg((now - footprint.lastShown) / 1000)
+				: QString("never shown")));
+	}
+}
+
 void Histories::readInbox(not_null<History*> history) {
 	DEBUG_LOG(("Reading: readInbox called."));
 	if (history->lastServerMessageKnown()) {
@@ -44,6 +44,15 @@ public:
 	void unloadAll();
 	void clearAll();
 
+	// Views of histories that were not shown for a long time are unloaded
+	// when all the loaded histories have more views than the limit.
+	// Items and the chats list state are kept, so the history is loaded
+	// again when it is opened, as after any other unload.
+	void shownHistoryChanged(History *was, History *now);
+	void historyUnloaded(not_null<History*> history);
+	void viewsAdded();
+	void logMemoryReport() const;
+
 	void readInbox(not_null<History*> history);
 	void readInboxTill(not_null<HistoryItem*> item);
 	void readInboxTill(not_null<History*> history, MsgId tillId);
@@ -113,6 +122,9 @@ private:
 
 	void sendDialogRequests();
 
+	void checkMemory();
+	[[nodiscard]] bool unloadLocked(not_null<History*> history) const;
+
 	const not_null<Session*> _owner;
 
 	std::unordered_map<PeerId, std::unique_ptr<History>> _map;
@@ -131,6 +143,9 @@ private:
 
 	base::flat_set<not_null<History*>> _fakeChatListRequests;
 
+	base::flat_map<not_null<History*>, crl::time> _lastShown;
+	base::Timer _memoryCheckTimer;
+
 };
 
 } // namespace Data
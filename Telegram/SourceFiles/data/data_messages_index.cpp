@@ -0,0 +1,145 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_messages_index.h"
+
+#include "history/history.h"
+#include "history/history_item.h"
+#include "data/data_peer.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kSlowSearchLog = crl::time(5);
+
+[[nodiscard]] QStringList ItemWords(not_null<HistoryItem*> item) {
+	if (!item->toHistoryMessage()
+		|| item->isAdminLogEntry()
+		|| item->isScheduled()) {
+		return {};
+	}
+	auto result = TextUtilities::PrepareSearchWords(
+		item->originalText().text);
+	result.removeDuplicates();
+	return result;
+}
+
+[[nodiscard]] bool HasPrefixOf(
+		const QStringList &words,
+		const QString &prefix) {
+	return ranges::any_of(words, [&](const QString &word) {
+		return word.startsWith(prefix);
+	});
+}
+
+} // namespace
+
+void MessagesIndex::add(not_null<HistoryItem*> item) {
+	auto words = ItemWords(item);
+	if (words.isEmpty()) {
+		return;
+	}
+	for (const auto &word : words) {
+		_words[word].emplace(item);
+	}
+	_items.emplace(item, std::move(words));
+}
+
+void MessagesIndex::update(not_null<HistoryItem*> item) {
+	remove(item);
+	add(item);
+}
+
+void MessagesIndex::remove(not_null<HistoryItem*> item) {
+	const auto i = _items.find(item);
+	if (i == end(_items)) {
+		return;
+	}
+	for (const auto &word : i->second) {
+		const auto j = _words.find(word);
+		if (j != end(_words)) {
+			j->second.erase(item);
+			if (j->second.empty()) {
+				_words.erase(j);
+			}
+		}
+	}
+	_items.erase(i);
+}
+
+bool MessagesIndex::matches(
+		not_null<HistoryItem*> item,
+		const Query &query) const {
+	if (!IsServerMsgId(item->id)) {
+		return false;
+	}
+	const auto history = item->history();
+	if (query.inHistory) {
+		if (history != query.inHistory && history != query.inMigrated) {
+			return false;
+		}
+	} else if (query.skipArchive && history->folder()) {
+		return false;
+	}
+	return !query.from || (item->from() == query.from);
+}
+
+std::vector<not_null<HistoryItem*>> MessagesIndex::search(
+		const Query &query) const {
+	const auto started = crl::now();
+	const auto words = TextUtilities::PrepareSearchWords(query.text);
+	if (words.isEmpty()) {
+		return {};
+	}
+
+	// Take candidates by the longest word, it has the least matches.
+	const auto &longest = *ranges::max_element(
+		words,
+		ranges::less(),
+		&QString::size);
+	auto result = std::vector<not_null<HistoryItem*>>();
+	for (auto i = _words.lower_bound(longest); i != end(_words); ++i) {
+		if (!i->first.startsWith(longest)) {
+			break;
+		}
+		for (const auto item : i->second) {
+			if (!matches(item, query)) {
+				continue;
+			}
+			const auto &itemWords = _items.find(item)->second;
+			const auto all = ranges::all_of(words, [&](const QString &word) {
+				return HasPrefixOf(itemWords, word);
+			});
+			if (all) {
+				result.push_back(item);
+			}
+		}
+	}
+
+	// One item may be found through several words with the same prefix.
+	ranges::sort(result, std::less<>());
+	result.erase(ranges::unique(result), end(result));
+	ranges::sort(result, [](not_null<HistoryItem*> a, not_null<HistoryItem*> b) {
+		return (a->date() > b->date());
+	});
+	if (query.limit > 0 && int(result.size()) > query.limit) {
+		result.resize(query.limit);
+	}
+
+	const auto duration = crl::now() - started;
+	if (duration >= kSlowSearchLog) {
+		DEBUG_LOG(("Messages Index: "
+			"%1 results in %2 ms, %3 items, %4 words indexed."
+			).arg(result.size()
+			).arg(duration
+			).arg(_items.size()
+			).arg(_words.size()));
+	}
+	return result;
+}
+
+} // namespace Data
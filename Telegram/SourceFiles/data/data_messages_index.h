@@ -0,0 +1,50 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class History;
+class HistoryItem;
+class PeerData;
+
+namespace Data {
+
+// Inverted index of words in texts and captions of all loaded messages,
+// so that message search can show local results before the server ones.
+class MessagesIndex final {
+public:
+	struct Query {
+		QString text;
+		History *inHistory = nullptr;
+		History *inMigrated = nullptr;
+		PeerData *from = nullptr;
+		bool skipArchive = false;
+		int limit = 0;
+	};
+
+	// Items are added on registration in Data::Session.
+	void add(not_null<HistoryItem*> item);
+	void update(not_null<HistoryItem*> item);
+	void remove(not_null<HistoryItem*> item);
+
+	// Newest first, only messages with server ids.
+	[[nodiscard]] std::vector<not_null<HistoryItem*>> search(
+		const Query &query) const;
+
+private:
+	using Items = std::unordered_set<HistoryItem*>;
+
+	[[nodiscard]] bool matches(
+		not_null<HistoryItem*> item,
+		const Query &query) const;
+
+	std::map<QString, Items> _words;
+	std::unordered_map<HistoryItem*, QStringList> _items;
+
+};
+
+} // namespace Data
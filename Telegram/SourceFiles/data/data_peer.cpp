@@ -16,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "data/data_file_origin.h"
 #include "data/data_histories.h"
+#include "data/data_userpic_atlas.h"
 #include "base/unixtime.h"
 #include "base/crc32hash.h"
 #include "lang/lang_keys.h"
@@ -249,13 +250,36 @@ Image *PeerData::currentUserpic(
 	return image;
 }
 
+const QPixmap *PeerData::cachedUserpic(
+		std::shared_ptr<Data::CloudImageView> &view,
+		int size,
+		Data::UserpicShape shape) const {
+	auto &atlas = Core::App().userpicAtlas();
+	const auto &location = _userpic.location();
+	if (location.valid()) {
+		// Don't require the image to be loaded if it was painted before.
+		const auto key = inMemoryKey(location);
+		if (const auto result = atlas.find(key, size, shape)) {
+			return result;
+		}
+		currentUserpic(view);
+		if (const auto userpic = view ? view->image() : nullptr) {
+			return &atlas.prepare(key, userpic, size, shape);
+		}
+	}
+	return nullptr;
+}
+
 void PeerData::paintUserpic(
 		Painter &p,
 		std::shared_ptr<Data::CloudImageView> &view,
 		int x,
 		int y,
 		int size) const {
-	if (const auto userpic = currentUserpic(view)) {
+	const auto shape = Data::UserpicShape::Circle;
+	if (const auto cached = cachedUserpic(view, size, shape)) {
+		p.drawPixmap(x, y, *cached);
+	} else if (const auto userpic = currentUserpic(view)) {
 		p.drawPixmap(x, y, userpic->pixCircled(size, size));
 	} else {
 		ensureEmptyUserpic()->paint(p, x, y, x + size + x, size);
@@ -268,7 +292,10 @@ void PeerData::paintUserpicRounded(
 		int x,
 		int y,
 		int size) const {
-	if (const auto userpic = currentUserpic(view)) {
+	const auto shape = Data::UserpicShape::Rounded;
+	if (const auto cached = cachedUserpic(view, size, shape)) {
+		p.drawPixmap(x, y, *cached);
+	} else if (const auto userpic = currentUserpic(view)) {
 		p.drawPixmap(x, y, userpic->pixRounded(size, size, ImageRoundRadius::Small));
 	} else {
 		ensureEmptyUserpic()->paintRounded(p, x, y, x + size + x, size);
@@ -281,7 +308,10 @@ void PeerData::paintUserpicSquare(
 		int x,
 		int y,
 		int size) const {
-	if (const auto userpic = currentUserpic(view)) {
+	const auto shape = Data::UserpicShape::Square;
+	if (const auto cached = cachedUserpic(view, size, shape)) {
+		p.drawPixmap(x, y, *cached);
+	} else if (const auto userpic = currentUserpic(view)) {
 		p.drawPixmap(x, y, userpic->pix(size, size));
 	} else {
 		ensureEmptyUserpic()->paintSquare(p, x, y, x + size + x, size);
@@ -338,7 +368,10 @@ void PeerData::saveUserpicRounded(
 QPixmap PeerData::genUserpic(
 		std::shared_ptr<Data::CloudImageView> &view,
 		int size) const {
-	if (const auto userpic = currentUserpic(view)) {
+	const auto shape = Data::UserpicShape::Circle;
+	if (const auto cached = cachedUserpic(view, size, shape)) {
+		return *cached;
+	} else if (const auto userpic = currentUserpic(view)) {
 		return userpic->pixCircled(size, size);
 	}
 	auto result = QImage(QSize(size, size) * cIntRetinaFactor(), QImage::Format_ARGB32_Premultiplied);
@@ -354,7 +387,10 @@ QPixmap PeerData::genUserpic(
 QPixmap PeerData::genUserpicRounded(
 		std::shared_ptr<Data::CloudImageView> &view,
 		int size) const {
-	if (const auto userpic = currentUserpic(view)) {
+	const auto shape = Data::UserpicShape::Rounded;
+	if (const auto cached = cachedUserpic(view, size, shape)) {
+		return *cached;
+	} else if (const auto userpic = currentUserpic(view)) {
 		return userpic->pixRounded(size, size, ImageRoundRadius::Small);
 	}
 	auto result = QImage(QSize(size, size) * cIntRetinaFactor(), QImage::Format_ARGB32_Premultiplied);
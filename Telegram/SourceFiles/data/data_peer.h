@@ -30,6 +30,7 @@ namespace Data {
 
 class Session;
 class GroupCall;
+enum class UserpicShape : uchar;
 
 int PeerColorIndex(PeerId peerId);
 int PeerColorIndex(int32 bareId);
@@ -407,6 +408,10 @@ protected:
 private:
 	void fillNames();
 	[[nodiscard]] not_null<Ui::EmptyUserpic*> ensureEmptyUserpic() const;
+	[[nodiscard]] const QPixmap *cachedUserpic(
+		std::shared_ptr<Data::CloudImageView> &view,
+		int size,
+		Data::UserpicShape shape) const;
 	[[nodiscard]] virtual auto unavailableReasons() const
 		-> const std::vector<Data::UnavailableReason> &;
 
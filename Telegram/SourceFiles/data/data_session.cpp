@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "main/main_session.h"
 #include "main/main_session_settings.h"
 #include "main/main_account.h"
+#include "main/main_domain.h"
 #include "apiwrap.h"
 #include "mainwidget.h"
 #include "api/api_text_entities.h"
@@ -29,6 +30,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/history_view_send_action.h"
 #include "inline_bots/inline_bot_layout_item.h"
 #include "storage/storage_account.h"
+#include "storage/storage_domain.h"
 #include "storage/storage_encrypted_file.h"
 #include "media/player/media_player_instance.h" // instance()->play()
 #include "media/audio/media_audio.h"
@@ -56,6 +58,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_streaming.h"
 #include "data/data_media_rotation.h"
 #include "data/data_histories.h"
+#include "data/data_messages_index.h"
 #include "base/platform/base_platform_info.h"
 #include "base/unixtime.h"
 #include "base/call_delayed.h"
@@ -207,12 +210,19 @@ std::vector<UnavailableReason> ExtractUnavailableReasons(
 
 Session::Session(not_null<Main::Session*> session)
 : _session(session)
-, _cache(Core::App().databases().get(
-	_session->local().cachePath(),
-	_session->local().cacheSettings()))
-, _bigFileCache(Core::App().databases().get(
-	_session->local().cacheBigFilePath(),
-	_session->local().cacheBigFileSettings()))
+, _sharedCache(_session->domain().local().sharedCacheEnabled())
+, _cache(_sharedCache
+	? _session->domain().local().sharedCache(
+		_session->local().cacheSettings())
+	: Core::App().databases().get(
+		_session->local().cachePath(),
+		_session->local().cacheSettings()))
+, _bigFileCache(_sharedCache
+	? _session->domain().local().sharedCacheBigFile(
+		_session->local().cacheBigFileSettings())
+	: Core::App().databases().get(
+		_session->local().cacheBigFilePath(),
+		_session->local().cacheBigFileSettings()))
 , _chatsList(
 	session,
 	FilterId(),
@@ -231,14 +241,19 @@ Session::Session(not_null<Main::Session*> session)
 , _cloudThemes(std::make_unique<CloudThemes>(session))
 , _streaming(std::make_unique<Streaming>(this))
 , _mediaRotation(std::make_unique<MediaRotation>())
+, _messagesIndex(std::make_unique<MessagesIndex>())
 , _histories(std::make_unique<Histories>(this))
 , _stickers(std::make_unique<Stickers>(this)) {
-	_cache->open(_session->local().cacheKey());
-	_bigFileCache->open(_session->local().cacheBigFileKey());
+	if (!_sharedCache) {
+		_cache->open(_session->local().cacheKey());
+		_bigFileCache->open(_session->local().cacheBigFileKey());
+	}
 
 	if constexpr (Platform::IsLinux()) {
 		const auto wasVersion = _session->local().oldMapVersion();
-		if (wasVersion >= 1007011 && wasVersion < 1007015) {
+		if (!_sharedCache
+			&& wasVersion >= 1007011
+			&& wasVersion < 1007015) {
 			_bigFileCache->clear();
 			_cache->clearByTag(Data::kImageCacheTag);
 		}
@@ -1072,7 +1087,10 @@ void Session::chatsListDone(Data::Folder *folder) {
 
 void Session::userIsBotChanged(not_null<UserData*> user) {
 	if (const auto history = this->history(user)) {
-		chatsFilters().refreshHistory(history);
+		using Flag = ChatFilter::Flag;
+		chatsFilters().refreshHistory(
+			history,
+			Flag::Contacts | Flag::NonContacts | Flag::Bots);
 	}
 	_userIsBotChanges.fire_copy(user);
 }
@@ -1425,11 +1443,14 @@ rpl::producer<not_null<const HistoryItem*>> Session::itemRepaintRequest() const
 	return _itemRepaintRequest.events();
 }
 
-void Session::requestViewRepaint(not_null<const ViewElement*> view) {
-	_viewRepaintRequest.fire_copy(view);
+void Session::requestViewRepaint(
+		not_null<const ViewElement*> view,
+		QRect rect) {
+	_viewRepaintRequest.fire({ view, rect });
 }
 
-rpl::producer<not_null<const ViewElement*>> Session::viewRepaintRequest() const {
+auto Session::viewRepaintRequest() const
+-> rpl::producer<ViewRepaintRequest> {
 	return _viewRepaintRequest.events();
 }
 
@@ -1942,6 +1963,7 @@ void Session::registerMessage(not_null<HistoryItem*> item) {
 		i->second->destroy();
 	}
 	list->emplace(itemId, item);
+	_messagesIndex->add(item);
 }
 
 void Session::processMessagesDeleted(
@@ -1994,6 +2016,7 @@ void Session::unregisterMessage(not_null<HistoryItem*> item) {
 		Data::MessageUpdate::Flag::Destroyed);
 	groups().unregisterMessage(item);
 	removeDependencyMessage(item);
+	_messagesIndex->remove(item);
 	messagesListForInsert(peerToChannel(peerId))->erase(item->id);
 }
 
@@ -2235,6 +2258,10 @@ rpl::producer<> Session::unreadBadgeChanges() const {
 }
 
 void Session::notifyUnreadBadgeChanged() {
+	if (_bulkUpdatesLevel > 0) {
+		_bulkUnreadBadgeChanged = true;
+		return;
+	}
 	_unreadBadgeChanges.fire({});
 }
 
@@ -3645,28 +3672,25 @@ void Session::refreshChatListEntry(Dialogs::Key key) {
 		event.moved = entry->adjustByPosInChatList(0, mainList);
 	}
 	if (event) {
-		_chatListEntryRefreshes.fire(std::move(event));
+		fireChatListEntryRefresh(std::move(event));
 	}
 	if (!history) {
 		return;
-	}
-	for (const auto &filter : _chatsFilters->list()) {
-		const auto id = filter.id();
-		const auto filterList = chatsFilters().chatsList(id);
-		auto event = ChatListEntryRefresh{ .key = key, .filterId = id };
-		if (filter.contains(history)) {
-			event.existenceChanged = !entry->inChatList(id);
-			if (event.existenceChanged) {
-				entry->addToChatList(id, filterList);
-			} else {
-				event.moved = entry->adjustByPosInChatList(id, filterList);
+	} else if (creating) {
+		_chatsFilters->refreshHistory(history);
+	} else {
+		// Filters are refreshed separately when the conditions change.
+		for (const auto &filter : _chatsFilters->list()) {
+			const auto id = filter.id();
+			if (!entry->inChatList(id)) {
+				continue;
+			}
+			const auto filterList = chatsFilters().chatsList(id);
+			auto event = ChatListEntryRefresh{ .key = key, .filterId = id };
+			event.moved = entry->adjustByPosInChatList(id, filterList);
+			if (event) {
+				fireChatListEntryRefresh(std::move(event));
 			}
-		} else if (entry->inChatList(id)) {
-			entry->removeFromChatList(id, filterList);
-			event.existenceChanged = true;
-		}
-		if (event) {
-			_chatListEntryRefreshes.fire(std::move(event));
 		}
 	}
 
@@ -3679,6 +3703,32 @@ void Session::refreshChatListEntry(Dialogs::Key key) {
 	}
 }
 
+void Session::refreshChatListEntry(
+		not_null<History*> history,
+		const ChatFilter &filter) {
+	Expects(history->inChatList());
+
+	using namespace Dialogs;
+
+	const auto id = filter.id();
+	const auto filterList = chatsFilters().chatsList(id);
+	auto event = ChatListEntryRefresh{ .key = history, .filterId = id };
+	if (filter.contains(history)) {
+		event.existenceChanged = !history->inChatList(id);
+		if (event.existenceChanged) {
+			history->addToChatList(id, filterList);
+		} else {
+			event.moved = history->adjustByPosInChatList(id, filterList);
+		}
+	} else if (history->inChatList(id)) {
+		history->removeFromChatList(id, filterList);
+		event.existenceChanged = true;
+	}
+	if (event) {
+		fireChatListEntryRefresh(std::move(event));
+	}
+}
+
 void Session::removeChatListEntry(Dialogs::Key key) {
 	using namespace Dialogs;
 
@@ -3691,7 +3741,7 @@ void Session::removeChatListEntry(Dialogs::Key key) {
 		const auto id = filter.id();
 		if (entry->inChatList(id)) {
 			entry->removeFromChatList(id, chatsFilters().chatsList(id));
-			_chatListEntryRefreshes.fire(ChatListEntryRefresh{
+			fireChatListEntryRefresh({
 				.key = key,
 				.filterId = id,
 				.existenceChanged = true
@@ -3700,7 +3750,7 @@ void Session::removeChatListEntry(Dialogs::Key key) {
 	}
 	const auto mainList = chatsList(entry->folder());
 	entry->removeFromChatList(0, mainList);
-	_chatListEntryRefreshes.fire(ChatListEntryRefresh{
+	fireChatListEntryRefresh({
 		.key = key,
 		.existenceChanged = true
 	});
@@ -3719,6 +3769,43 @@ auto Session::chatListEntryRefreshes() const
 	return _chatListEntryRefreshes.events();
 }
 
+void Session::fireChatListEntryRefresh(ChatListEntryRefresh &&event) {
+	const auto key = std::make_pair(event.key, event.filterId);
+	if (!_bulkUpdatesLevel) {
+		_chatListEntryRefreshes.fire(std::move(event));
+		return;
+	} else if (event.existenceChanged) {
+		// Rows are created and destroyed right away, so the subscribers
+		// should forget about the destroyed ones right away as well.
+		_bulkChatListEntryRefreshes.remove(key);
+		_chatListEntryRefreshes.fire(std::move(event));
+		return;
+	}
+	const auto i = _bulkChatListEntryRefreshes.find(key);
+	if (i == end(_bulkChatListEntryRefreshes)) {
+		_bulkChatListEntryRefreshes.emplace(key, std::move(event));
+	} else {
+		i->second.moved.to = event.moved.to;
+	}
+}
+
+void Session::finishBulkUpdates() {
+	Expects(_bulkUpdatesLevel > 0);
+
+	if (--_bulkUpdatesLevel > 0) {
+		return;
+	}
+	auto refreshes = base::take(_bulkChatListEntryRefreshes);
+	for (auto &[key, event] : refreshes) {
+		if (event) {
+			_chatListEntryRefreshes.fire(std::move(event));
+		}
+	}
+	if (base::take(_bulkUnreadBadgeChanged)) {
+		_unreadBadgeChanges.fire({});
+	}
+}
+
 
 void Session::dialogsRowReplaced(DialogsRowReplacement replacement) {
 	_dialogsRowReplacements.fire(std::move(replacement));
@@ -4062,6 +4149,10 @@ int32 Session::wallpapersHash() const {
 }
 
 void Session::clearLocalStorage() {
+	if (_sharedCache) {
+		// Other accounts may still use the shared cache.
+		return;
+	}
 	_cache->close();
 	_cache->clear();
 	_bigFileCache->close();
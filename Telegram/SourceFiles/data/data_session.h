@@ -52,11 +52,13 @@ class Folder;
 class LocationPoint;
 class WallPaper;
 class ScheduledMessages;
+class ChatFilter;
 class ChatFilters;
 class CloudThemes;
 class Streaming;
 class MediaRotation;
 class Histories;
+class MessagesIndex;
 class DocumentMedia;
 class PhotoMedia;
 class Stickers;
@@ -105,6 +107,9 @@ public:
 	[[nodiscard]] Stickers &stickers() const {
 		return *_stickers;
 	}
+	[[nodiscard]] MessagesIndex &messagesIndex() const {
+		return *_messagesIndex;
+	}
 	[[nodiscard]] MsgId nextNonHistoryEntryId() {
 		return ++_nonHistoryEntryId;
 	}
@@ -126,6 +131,9 @@ public:
 
 	[[nodiscard]] Storage::Cache::Database &cache();
 	[[nodiscard]] Storage::Cache::Database &cacheBigFile();
+	[[nodiscard]] bool usesSharedCache() const {
+		return _sharedCache;
+	}
 
 	[[nodiscard]] not_null<PeerData*> peer(PeerId id);
 	[[nodiscard]] not_null<PeerData*> peer(UserId id) = delete;
@@ -237,8 +245,15 @@ public:
 	[[nodiscard]] rpl::producer<not_null<HistoryItem*>> unreadItemAdded() const;
 	void requestItemRepaint(not_null<const HistoryItem*> item);
 	[[nodiscard]] rpl::producer<not_null<const HistoryItem*>> itemRepaintRequest() const;
-	void requestViewRepaint(not_null<const ViewElement*> view);
-	[[nodiscard]] rpl::producer<not_null<const ViewElement*>> viewRepaintRequest() const;
+	struct ViewRepaintRequest {
+		not_null<const ViewElement*> view;
+		QRect rect; // In the view coordinates, empty for the whole view.
+	};
+	void requestViewRepaint(
+		not_null<const ViewElement*> view,
+		QRect rect = QRect());
+	[[nodiscard]] auto viewRepaintRequest() const
+		-> rpl::producer<ViewRepaintRequest>;
 	void requestItemResize(not_null<const HistoryItem*> item);
 	[[nodiscard]] rpl::producer<not_null<const HistoryItem*>> itemResizeRequest() const;
 	void requestViewResize(not_null<ViewElement*> view);
@@ -618,10 +633,22 @@ public:
 		}
 	};
 	void refreshChatListEntry(Dialogs::Key key);
+	void refreshChatListEntry(
+		not_null<History*> history,
+		const ChatFilter &filter);
 	void removeChatListEntry(Dialogs::Key key);
 	[[nodiscard]] auto chatListEntryRefreshes() const
 		-> rpl::producer<ChatListEntryRefresh>;
 
+	// While the returned guard is alive the chats list row moves and the
+	// unread badge notifications are collected and sent only once in the
+	// end, when the outermost guard is destroyed. Rows being added or
+	// removed are still notified about immediately.
+	[[nodiscard]] auto bulkUpdates() {
+		++_bulkUpdatesLevel;
+		return gsl::finally([=] { finishBulkUpdates(); });
+	}
+
 	struct DialogsRowReplacement {
 		not_null<Dialogs::Row*> old;
 		Dialogs::Row *now = nullptr;
@@ -682,6 +709,9 @@ private:
 
 	void checkSelfDestructItems();
 
+	void fireChatListEntryRefresh(ChatListEntryRefresh &&event);
+	void finishBulkUpdates();
+
 	int computeUnreadBadge(const Dialogs::UnreadState &state) const;
 	bool computeUnreadBadgeMuted(const Dialogs::UnreadState &state) const;
 
@@ -808,6 +838,7 @@ private:
 
 	const not_null<Main::Session*> _session;
 
+	const bool _sharedCache = false;
 	Storage::DatabasePointer _cache;
 	Storage::DatabasePointer _bigFileCache;
 
@@ -825,7 +856,7 @@ private:
 	rpl::event_stream<not_null<const ViewElement*>> _viewLayoutChanges;
 	rpl::event_stream<not_null<HistoryItem*>> _unreadItemAdded;
 	rpl::event_stream<not_null<const HistoryItem*>> _itemRepaintRequest;
-	rpl::event_stream<not_null<const ViewElement*>> _viewRepaintRequest;
+	rpl::event_stream<ViewRepaintRequest> _viewRepaintRequest;
 	rpl::event_stream<not_null<const HistoryItem*>> _itemResizeRequest;
 	rpl::event_stream<not_null<ViewElement*>> _viewResizeRequest;
 	rpl::event_stream<not_null<HistoryItem*>> _itemViewRefreshRequest;
@@ -842,6 +873,11 @@ private:
 	rpl::event_stream<DialogsRowReplacement> _dialogsRowReplacements;
 	rpl::event_stream<ChatListEntryRefresh> _chatListEntryRefreshes;
 	rpl::event_stream<> _unreadBadgeChanges;
+	base::flat_map<
+		std::pair<Dialogs::Key, FilterId>,
+		ChatListEntryRefresh> _bulkChatListEntryRefreshes;
+	int _bulkUpdatesLevel = 0;
+	bool _bulkUnreadBadgeChanged = false;
 
 	Dialogs::MainList _chatsList;
 	Dialogs::IndexedList _contactsList;
@@ -966,6 +1002,7 @@ private:
 	std::unique_ptr<CloudThemes> _cloudThemes;
 	std::unique_ptr<Streaming> _streaming;
 	std::unique_ptr<MediaRotation> _mediaRotation;
+	std::unique_ptr<MessagesIndex> _messagesIndex;
 	std::unique_ptr<Histories> _histories;
 	base::flat_map<
 		not_null<History*>,
@@ -27,6 +27,17 @@ constexpr auto kUrlCacheTag = 0x0000030000000000ULL;
 constexpr auto kUrlCacheMask = 0x000000FFFFFFFFFFULL;
 constexpr auto kGeoPointCacheTag = 0x0000040000000000ULL;
 constexpr auto kGeoPointCacheMask = 0x000000FFFFFFFFFFULL;
+constexpr auto kTileCacheTag = 0x0000050000000000ULL;
+constexpr auto kTileCacheDocumentFlag = 0x0000000100000000ULL;
+constexpr auto kTileCacheSizeMask = 0x00000000FFFFFFFFULL;
+constexpr auto kInlineResultsCacheTag = 0x0000060000000000ULL;
+constexpr auto kInlineResultsCacheMask = 0x000000FFFFFFFFFFULL;
+constexpr auto kWallPaperCacheTag = 0x0000070000000000ULL;
+constexpr auto kWallPaperCacheParamsMask = 0x00000000FFFFFFFFULL;
+
+// Keeps the 0xFF00 byte zero, it is (type + 3) in location cache keys.
+constexpr auto kDocumentWaveformCacheTag = 0x0000080000000000ULL;
+constexpr auto kDocumentWaveformCacheMask = 0x00000000000000FFULL;
 
 } // namespace
 
@@ -45,6 +56,14 @@ Storage::Cache::Key DocumentThumbCacheKey(int32 dcId, uint64 id) {
 	};
 }
 
+Storage::Cache::Key DocumentWaveformCacheKey(int32 dcId, uint64 id) {
+	const auto part = (uint64(dcId) & Data::kDocumentWaveformCacheMask);
+	return Storage::Cache::Key{
+		Data::kDocumentWaveformCacheTag | part,
+		id
+	};
+}
+
 Storage::Cache::Key WebDocumentCacheKey(const WebFileLocation &location) {
 	const auto CacheDcId = 4; // The default production value. Doesn't matter.
 	const auto dcId = uint64(CacheDcId) & 0xFFULL;
@@ -91,6 +110,51 @@ Storage::Cache::Key GeoPointCacheKey(const GeoPointLocation &location) {
 	};
 }
 
+Storage::Cache::Key PhotoTileCacheKey(uint64 photoId, int size) {
+	return Storage::Cache::Key{
+		Data::kTileCacheTag | (uint64(size) & Data::kTileCacheSizeMask),
+		photoId
+	};
+}
+
+Storage::Cache::Key InlineResultsCacheKey(const QByteArray &query) {
+	const auto hash = openssl::Sha256(bytes::make_span(query));
+	const auto bytes = bytes::make_span(hash);
+	const auto bytes1 = bytes.subspan(0, sizeof(uint32));
+	const auto bytes2 = bytes.subspan(sizeof(uint32), sizeof(uint64));
+	const auto bytes3 = bytes.subspan(
+		sizeof(uint32) + sizeof(uint64),
+		sizeof(uint8));
+	const auto part1 = *reinterpret_cast<const uint32*>(bytes1.data());
+	const auto part2 = *reinterpret_cast<const uint64*>(bytes2.data());
+	const auto part3 = *reinterpret_cast<const uint8*>(bytes3.data());
+	const auto part = ((uint64(part3) << 32) | part1)
+		& Data::kInlineResultsCacheMask;
+	return Storage::Cache::Key{
+		Data::kInlineResultsCacheTag | part,
+		part2
+	};
+}
+
+Storage::Cache::Key PreparedWallPaperCacheKey(
+		uint64 documentId,
+		uint32 params) {
+	return Storage::Cache::Key{
+		Data::kWallPaperCacheTag
+			| (uint64(params) & Data::kWallPaperCacheParamsMask),
+		documentId
+	};
+}
+
+Storage::Cache::Key DocumentTileCacheKey(uint64 documentId, int size) {
+	return Storage::Cache::Key{
+		(Data::kTileCacheTag
+			| Data::kTileCacheDocumentFlag
+			| (uint64(size) & Data::kTileCacheSizeMask)),
+		documentId
+	};
+}
+
 } // namespace Data
 
 uint32 AudioMsgId::CreateExternalPlayId() {
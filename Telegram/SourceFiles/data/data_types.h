@@ -48,9 +48,16 @@ struct UploadState {
 
 Storage::Cache::Key DocumentCacheKey(int32 dcId, uint64 id);
 Storage::Cache::Key DocumentThumbCacheKey(int32 dcId, uint64 id);
+Storage::Cache::Key DocumentWaveformCacheKey(int32 dcId, uint64 id);
 Storage::Cache::Key WebDocumentCacheKey(const WebFileLocation &location);
 Storage::Cache::Key UrlCacheKey(const QString &location);
 Storage::Cache::Key GeoPointCacheKey(const GeoPointLocation &location);
+Storage::Cache::Key PhotoTileCacheKey(uint64 photoId, int size);
+Storage::Cache::Key DocumentTileCacheKey(uint64 documentId, int size);
+Storage::Cache::Key InlineResultsCacheKey(const QByteArray &query);
+Storage::Cache::Key PreparedWallPaperCacheKey(
+	uint64 documentId,
+	uint32 params);
 
 constexpr auto kImageCacheTag = uint8(0x01);
 constexpr auto kStickerCacheTag = uint8(0x02);
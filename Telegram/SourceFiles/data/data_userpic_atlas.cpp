@@ -0,0 +1,105 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_userpic_atlas.h"
+
+#include "ui/image/image.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kBytesLimit = int64(32 * 1024 * 1024);
+constexpr auto kLogStatsEach = 4096;
+
+} // namespace
+
+UserpicAtlas::Key UserpicAtlas::computeKey(
+		const InMemoryKey &unique,
+		int size,
+		UserpicShape shape) const {
+	return { unique, size * cIntRetinaFactor(), shape };
+}
+
+const QPixmap *UserpicAtlas::find(
+		const InMemoryKey &key,
+		int size,
+		UserpicShape shape) {
+	const auto i = _index.find(computeKey(key, size, shape));
+	countLookup(i != end(_index));
+	if (i == end(_index)) {
+		return nullptr;
+	}
+	_entries.splice(begin(_entries), _entries, i->second);
+	return &i->second->pixmap;
+}
+
+const QPixmap &UserpicAtlas::prepare(
+		const InMemoryKey &key,
+		not_null<Image*> image,
+		int size,
+		UserpicShape shape) {
+	const auto full = computeKey(key, size, shape);
+	const auto i = _index.find(full);
+	if (i != end(_index)) {
+		_entries.splice(begin(_entries), _entries, i->second);
+		return i->second->pixmap;
+	}
+	const auto real = size * cIntRetinaFactor();
+	using Option = Images::Option;
+	auto options = Option::Smooth | Option::None;
+	if (shape == UserpicShape::Circle) {
+		options |= Option::Circled;
+	} else if (shape == UserpicShape::Rounded) {
+		options |= Option::RoundedSmall | Option::RoundedAll;
+	}
+	auto pixmap = image->pixNoCache(real, real, options);
+	pixmap.setDevicePixelRatio(cRetinaFactor());
+	const auto bytes = int64(pixmap.width())
+		* pixmap.height()
+		* (pixmap.depth() / 8);
+	_entries.push_front({ full, std::move(pixmap), bytes });
+	_index.emplace(full, begin(_entries));
+	_stats.bytes += bytes;
+	++_stats.count;
+	evict();
+	return _entries.front().pixmap;
+}
+
+void UserpicAtlas::evict() {
+	while (_stats.bytes > kBytesLimit && _entries.size() > 1) {
+		const auto &last = _entries.back();
+		_stats.bytes -= last.bytes;
+		--_stats.count;
+		_index.erase(last.key);
+		_entries.pop_back();
+	}
+}
+
+void UserpicAtlas::countLookup(bool hit) {
+	++(hit ? _stats.hits : _stats.misses);
+	if (((_stats.hits + _stats.misses) % kLogStatsEach) == 0) {
+		logStats();
+	}
+}
+
+void UserpicAtlas::logStats() const {
+	DEBUG_LOG(("Userpic Atlas: %1 hits, %2 misses, %3 entries, %4 KB."
+		).arg(_stats.hits
+		).arg(_stats.misses
+		).arg(_stats.count
+		).arg(_stats.bytes / 1024));
+}
+
+void UserpicAtlas::clear() {
+	logStats();
+	_index.clear();
+	_entries.clear();
+	_stats.bytes = 0;
+	_stats.count = 0;
+}
+
+} // namespace Data
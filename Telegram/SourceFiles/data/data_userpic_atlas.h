@@ -0,0 +1,76 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class Image;
+
+namespace Data {
+
+enum class UserpicShape : uchar {
+	Circle,
+	Rounded,
+	Square,
+};
+
+// Cache of userpics prepared for painting, owned by Core::Application and
+// shared by all the widgets that paint through PeerData::paintUserpic*().
+// Entries outlive the CloudImageView-s of the widgets, so scrolling back
+// to the same senders doesn't scale and round the same images again.
+class UserpicAtlas final {
+public:
+	[[nodiscard]] const QPixmap *find(
+		const InMemoryKey &key,
+		int size,
+		UserpicShape shape);
+	const QPixmap &prepare(
+		const InMemoryKey &key,
+		not_null<Image*> image,
+		int size,
+		UserpicShape shape);
+
+	void clear();
+
+private:
+	struct Stats {
+		int64 hits = 0;
+		int64 misses = 0;
+		int64 bytes = 0;
+		int count = 0;
+	};
+	struct Key {
+		InMemoryKey unique;
+		int size = 0;
+		UserpicShape shape = UserpicShape();
+
+		friend inline bool operator<(const Key &a, const Key &b) {
+			return std::tie(a.unique, a.size, a.shape)
+				< std::tie(b.unique, b.size, b.shape);
+		}
+	};
+	struct Entry {
+		Key key;
+		QPixmap pixmap;
+		int64 bytes = 0;
+	};
+	using Entries = std::list<Entry>;
+
+	[[nodiscard]] Key computeKey(
+		const InMemoryKey &unique,
+		int size,
+		UserpicShape shape) const;
+	void evict();
+	void countLookup(bool hit);
+	void logStats() const;
+
+	Entries _entries; // Most recently used first.
+	std::map<Key, Entries::iterator> _index;
+	Stats _stats;
+
+};
+
+} // namespace Data
@@ -571,6 +571,9 @@ void Stickers::setFaved(not_null<DocumentData*> document, bool faved) {
 }
 
 void Stickers::setsReceived(const QVector<MTPStickerSet> &data, int32 hash) {
+	// Sets with contents still in local storage should not be requested.
+	session().local().readPendingStickerSets();
+
 	auto &setsOrder = setsOrderRef();
 	setsOrder.clear();
 
@@ -950,6 +953,7 @@ std::vector<not_null<DocumentData*>> Stickers::getListByEmoji(
 		TimeId date = 0;
 	};
 	auto result = std::vector<StickerWithDate>();
+	session().local().readPendingStickerSets();
 	auto &sets = setsRef();
 	auto setsToRequest = base::flat_map<uint64, uint64>();
 
@@ -1867,6 +1867,7 @@ void InnerWidget::applyFilterUpdate(QString newFilter, bool force) {
 	newFilter = words.isEmpty() ? QString() : words.join(' ');
 	if (newFilter != _filter || force) {
 		_filter = newFilter;
+		_localSearchResults.clear();
 		if (_filter.isEmpty() && !_searchFromPeer) {
 			clearFilter();
 		} else {
@@ -1935,6 +1936,7 @@ InnerWidget::~InnerWidget() {
 void InnerWidget::clearSearchResults(bool clearPeerSearchResults) {
 	if (clearPeerSearchResults) _peerSearchResults.clear();
 	_searchResults.clear();
+	_localSearchResults.clear();
 	_searchedCount = _searchedMigratedCount = 0;
 	_lastSearchDate = 0;
 	_lastSearchPeer = nullptr;
@@ -1993,6 +1995,12 @@ void InnerWidget::visibleTopBottomUpdated(
 }
 
 void InnerWidget::itemRemoved(not_null<const HistoryItem*> item) {
+	_localSearchResults.erase(
+		ranges::remove_if(_localSearchResults, [&](
+				not_null<HistoryItem*> local) {
+			return (local.get() == item.get());
+		}),
+		end(_localSearchResults));
 	int wasCount = _searchResults.size();
 	for (auto i = _searchResults.begin(); i != _searchResults.end();) {
 		if ((*i)->item() == item) {
@@ -2050,7 +2058,12 @@ bool InnerWidget::searchReceived(
 		SearchRequestType type,
 		int fullCount) {
 	const auto uniquePeers = uniqueSearchResults();
-	if (type == SearchRequestType::FromStart || type == SearchRequestType::PeerFromStart) {
+	const auto fromStart = (type == SearchRequestType::FromStart)
+		|| (type == SearchRequestType::PeerFromStart);
+	auto localResults = fromStart
+		? base::take(_localSearchResults)
+		: std::vector<not_null<HistoryItem*>>();
+	if (fromStart) {
 		clearSearchResults(false);
 	}
 	auto isGlobalSearch = (type == SearchRequestType::FromStart || type == SearchRequestType::FromOffset);
@@ -2109,6 +2122,9 @@ bool InnerWidget::searchReceived(
 	} else {
 		_searchedCount = fullCount;
 	}
+	if (fromStart) {
+		mergeLocalSearchResults(std::move(localResults), lastDateFound);
+	}
 	if (_waitingForSearch
 		&& (!_searchResults.empty()
 			|| !_searchInMigrated
@@ -2122,6 +2138,53 @@ bool InnerWidget::searchReceived(
 	return lastDateFound != 0;
 }
 
+void InnerWidget::localSearchReceived(
+		std::vector<not_null<HistoryItem*>> items) {
+	const auto uniquePeers = uniqueSearchResults();
+	clearSearchResults(false);
+	_localSearchResults = std::move(items);
+	for (const auto item : _localSearchResults) {
+		if (!uniquePeers || !hasHistoryInResults(item->history())) {
+			_searchResults.push_back(
+				std::make_unique<FakeRow>(_searchInChat, item));
+		}
+	}
+	_searchedCount = _searchResults.size();
+	refresh();
+}
+
+void InnerWidget::clearLocalSearchResults() {
+	_localSearchResults.clear();
+}
+
+void InnerWidget::mergeLocalSearchResults(
+		std::vector<not_null<HistoryItem*>> items,
+		TimeId lastDateFound) {
+	const auto uniquePeers = uniqueSearchResults();
+	const auto found = [&](not_null<HistoryItem*> item) {
+		return ranges::find_if(_searchResults, [&](
+				const std::unique_ptr<FakeRow> &row) {
+			return (row->item() == item);
+		}) != end(_searchResults);
+	};
+	for (const auto item : items) {
+		// Older messages will come with the next server results pages.
+		if ((lastDateFound && item->date() < lastDateFound)
+			|| found(item)
+			|| (uniquePeers && hasHistoryInResults(item->history()))) {
+			continue;
+		}
+		const auto date = item->date();
+		const auto i = ranges::find_if(_searchResults, [&](
+				const std::unique_ptr<FakeRow> &row) {
+			return (row->item()->date() < date);
+		});
+		_searchResults.insert(
+			i,
+			std::make_unique<FakeRow>(_searchInChat, item));
+	}
+}
+
 void InnerWidget::peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
@@ -2411,6 +2474,7 @@ void InnerWidget::clearFilter() {
 		_filterResultsGlobal.clear();
 		_peerSearchResults.clear();
 		_searchResults.clear();
+		_localSearchResults.clear();
 		_lastSearchDate = 0;
 		_lastSearchPeer = nullptr;
 		_lastSearchId = _lastSearchMigratedId = 0;
@@ -73,6 +73,10 @@ public:
 		HistoryItem *inject,
 		SearchRequestType type,
 		int fullCount);
+
+	// Shown until the first page of the server results is received.
+	void localSearchReceived(std::vector<not_null<HistoryItem*>> items);
+	void clearLocalSearchResults();
 	void peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
@@ -219,6 +223,9 @@ private:
 			|| (_searchedSelected >= 0);
 	}
 	bool uniqueSearchResults() const;
+	void mergeLocalSearchResults(
+		std::vector<not_null<HistoryItem*>> items,
+		TimeId lastDateFound);
 	bool hasHistoryInResults(not_null<History*> history) const;
 
 	int defaultRowTop(not_null<Row*> row) const;
@@ -383,6 +390,7 @@ private:
 	int _peerSearchPressed = -1;
 
 	std::vector<std::unique_ptr<FakeRow>> _searchResults;
+	std::vector<not_null<HistoryItem*>> _localSearchResults;
 	int _searchedCount = 0;
 	int _searchedMigratedCount = 0;
 	int _searchedSelected = -1;
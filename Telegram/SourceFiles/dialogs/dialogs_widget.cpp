@@ -41,6 +41,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_user.h"
 #include "data/data_folder.h"
 #include "data/data_histories.h"
+#include "data/data_messages_index.h"
 #include "data/data_changes.h"
 #include "facades.h"
 #include "app.h"
@@ -54,6 +55,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Dialogs {
 namespace {
 
+// Shorter queries match too many messages to scan the index for them.
+constexpr auto kMinLocalSearchQueryLength = 2;
+
 QString SwitchToChooseFromQuery() {
 	return qsl("from:");
 }
@@ -819,6 +823,7 @@ bool Widget::onSearchMessages(bool searchCache) {
 			result = true;
 		}
 	} else if (_searchQuery != q || _searchQueryFrom != _searchFromAuthor) {
+		showLocalSearchResults(q);
 		_searchQuery = q;
 		_searchQueryFrom = _searchFromAuthor;
 		_searchNextRate = 0;
@@ -1282,6 +1287,10 @@ void Widget::searchFailed(
 			requestId);
 	} else if (_searchRequest == requestId) {
 		_searchRequest = 0;
+		if (type == SearchRequestType::FromStart
+			|| type == SearchRequestType::PeerFromStart) {
+			_inner->clearLocalSearchResults();
+		}
 		if (type == SearchRequestType::MigratedFromStart || type == SearchRequestType::MigratedFromOffset) {
 			_searchFullMigrated = true;
 		} else {
@@ -1464,6 +1473,7 @@ void Widget::clearSearchCache() {
 	_searchQuery = QString();
 	_searchQueryFrom = nullptr;
 	cancelSearchRequest();
+	_inner->clearLocalSearchResults();
 }
 
 void Widget::showJumpToDate() {
@@ -1762,6 +1772,23 @@ void Widget::scrollToEntry(const RowDescriptor &entry) {
 	_inner->scrollToEntry(entry);
 }
 
+void Widget::showLocalSearchResults(const QString &query) {
+	const auto peer = _searchInChat.peer();
+	if (query.size() < kMinLocalSearchQueryLength
+		|| (_searchInChat && !peer)) {
+		return;
+	}
+	const auto history = peer ? session().data().history(peer).get() : nullptr;
+	_inner->localSearchReceived(session().data().messagesIndex().search({
+		.text = query,
+		.inHistory = history,
+		.inMigrated = _searchInMigrated,
+		.from = _searchFromAuthor,
+		.skipArchive = session().settings().skipArchiveInSearch(),
+		.limit = SearchPerPage,
+	}));
+}
+
 void Widget::cancelSearchRequest() {
 	session().api().request(base::take(_searchRequest)).cancel();
 	session().data().histories().cancelRequest(
@@ -136,6 +136,7 @@ private:
 		mtpRequestId requestId);
 	void escape();
 	void cancelSearchRequest();
+	void showLocalSearchResults(const QString &query);
 
 	void setupSupportMode();
 	void setupConnectingWidget();
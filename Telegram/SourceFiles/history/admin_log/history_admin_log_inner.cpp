@@ -240,9 +240,9 @@ InnerWidget::InnerWidget(
 	setMouseTracking(true);
 	_scrollDateHideTimer.setCallback([=] { scrollDateHideByTimer(); });
 	session().data().viewRepaintRequest(
-	) | rpl::start_with_next([=](auto view) {
-		if (view->delegate() == this) {
-			repaintItem(view);
+	) | rpl::start_with_next([=](auto request) {
+		if (request.view->delegate() == this) {
+			repaintItem(request.view, request.rect);
 		}
 	}, lifetime());
 	session().data().viewResizeRequest(
@@ -1763,13 +1763,17 @@ int InnerWidget::itemTop(not_null<const Element*> view) const {
 	return _itemsTop + view->y();
 }
 
-void InnerWidget::repaintItem(const Element *view) {
+void InnerWidget::repaintItem(const Element *view, QRect rect) {
 	if (!view) {
 		return;
 	}
 	const auto top = itemTop(view);
-	const auto range = view->verticalRepaintRange();
-	update(0, top + range.top, width(), range.height);
+	if (!rect.isEmpty()) {
+		update(rect.translated(0, top));
+	} else {
+		const auto range = view->verticalRepaintRange();
+		update(0, top + range.top, width(), range.height);
+	}
 }
 
 void InnerWidget::resizeItem(not_null<Element*> view) {
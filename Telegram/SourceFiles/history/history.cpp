@@ -634,7 +634,9 @@ void History::setUnreadMentionsCount(int count) {
 	_unreadMentionsCount = count;
 	const auto has = (count > 0);
 	if (has != had) {
-		owner().chatsFilters().refreshHistory(this);
+		owner().chatsFilters().refreshHistory(
+			this,
+			Data::ChatFilter::Flag::NoMuted | Data::ChatFilter::Flag::NoRead);
 		updateChatListEntry();
 	}
 }
@@ -1192,6 +1194,7 @@ void History::addItemToBlock(not_null<HistoryItem*> item) {
 		HistoryInner::ElementDelegate()));
 	const auto view = block->messages.back().get();
 	view->attachToBlock(block, block->messages.size() - 1);
+	owner().histories().viewsAdded();
 
 	if (isBuildingFrontBlock() && _buildingFrontBlock->expectedItemsCount > 0) {
 		--_buildingFrontBlock->expectedItemsCount;
@@ -1622,7 +1625,9 @@ void History::setUnreadCount(int newUnreadCount) {
 	const auto wasForBadge = (unreadCountForBadge() > 0);
 	const auto refresher = gsl::finally([&] {
 		if (wasForBadge != (unreadCountForBadge() > 0)) {
-			owner().chatsFilters().refreshHistory(this);
+			owner().chatsFilters().refreshHistory(
+				this,
+				Data::ChatFilter::Flag::NoRead);
 		}
 		session().changes().historyUpdated(this, UpdateFlag::UnreadView);
 	});
@@ -1658,7 +1663,9 @@ void History::setUnreadMark(bool unread) {
 	const auto noUnreadMessages = !unreadCount();
 	const auto refresher = gsl::finally([&] {
 		if (inChatList() && noUnreadMessages) {
-			owner().chatsFilters().refreshHistory(this);
+			owner().chatsFilters().refreshHistory(
+				this,
+				Data::ChatFilter::Flag::NoRead);
 			updateChatListEntry();
 		}
 		session().changes().historyUpdated(this, UpdateFlag::UnreadView);
@@ -1681,7 +1688,9 @@ void History::setFakeUnreadWhileOpened(bool enabled) {
 		return;
 	}
 	_fakeUnreadWhileOpened = enabled;
-	owner().chatsFilters().refreshHistory(this);
+	owner().chatsFilters().refreshHistory(
+		this,
+		Data::ChatFilter::Flag::NoRead);
 }
 
 [[nodiscard]] bool History::fakeUnreadWhileOpened() const {
@@ -1698,7 +1707,9 @@ bool History::changeMute(bool newMute) {
 	}
 	const auto refresher = gsl::finally([&] {
 		if (inChatList()) {
-			owner().chatsFilters().refreshHistory(this);
+			owner().chatsFilters().refreshHistory(
+				this,
+				Data::ChatFilter::Flag::NoMuted);
 			updateChatListEntry();
 		}
 		session().changes().peerUpdated(
@@ -1790,7 +1801,10 @@ void History::setFolderPointer(Data::Folder *folder) {
 	if (wasInList) {
 		addToChatList(0, owner().chatsList(folder));
 
-		owner().chatsFilters().refreshHistory(this);
+		owner().chatsFilters().refreshHistory(
+			this,
+			(Data::ChatFilter::Flag::NoMuted
+				| Data::ChatFilter::Flag::NoArchived));
 		updateChatListEntry();
 
 		owner().chatsListChanged(was);
@@ -1946,6 +1960,7 @@ not_null<HistoryItem*> History::addNewInTheMiddle(
 		item->createView(
 			HistoryInner::ElementDelegate()));
 	(*it)->attachToBlock(block.get(), itemIndex);
+	owner().histories().viewsAdded();
 	if (itemIndex + 1 < block->messages.size()) {
 		for (auto i = itemIndex + 1, l = int(block->messages.size()); i != l; ++i) {
 			block->messages[i]->setIndexInBlock(i);
@@ -3028,6 +3043,7 @@ void History::clear(ClearType type) {
 
 	forgetScrollState();
 	blocks.clear();
+	owner().histories().historyUnloaded(this);
 	owner().notifyHistoryUnloaded(this);
 	lastKeyboardInited = false;
 	if (type == ClearType::Unload) {
@@ -76,6 +76,7 @@ namespace {
 constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kUnloadHeavyPartsPages = 2;
 constexpr auto kClearUserpicsAfter = 50;
+constexpr auto kSlowPaintDuration = crl::time(16);
 
 // Helper binary search for an item in a list that is not completely
 // above the given top of the visible area or below the given bottom of the visible area
@@ -192,8 +193,8 @@ HistoryInner::HistoryInner(
 		mouseActionCancel();
 	}, lifetime());
 	session().data().viewRepaintRequest(
-	) | rpl::start_with_next([this](not_null<const Element*> view) {
-		repaintItem(view);
+	) | rpl::start_with_next([this](auto request) {
+		repaintItem(request.view, request.rect);
 	}, lifetime());
 	session().data().viewLayoutChanged(
 	) | rpl::filter([](not_null<const Element*> view) {
@@ -250,12 +251,16 @@ void HistoryInner::repaintItem(const HistoryItem *item) {
 	repaintItem(item->mainView());
 }
 
-void HistoryInner::repaintItem(const Element *view) {
+void HistoryInner::repaintItem(const Element *view, QRect rect) {
 	if (_widget->skipItemRepaint()) {
 		return;
 	}
 	const auto top = itemTop(view);
-	if (top >= 0) {
+	if (top < 0) {
+		return;
+	} else if (!rect.isEmpty()) {
+		update(rect.translated(0, top));
+	} else {
 		const auto range = view->verticalRepaintRange();
 		update(0, top + range.top, width(), range.height);
 	}
@@ -547,6 +552,30 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 	auto clip = e->rect();
 	auto ms = crl::now();
 
+	// Separate repaint requests of several elements are merged in one
+	// paint event, skip the elements between them in the bounding rect.
+	const auto &region = e->region();
+	const auto intersects = [&](not_null<const Element*> view, int top) {
+		const auto range = view->verticalRepaintRange();
+		return region.intersects(
+			QRect(0, top + range.top, width(), range.height));
+	};
+	auto painted = 0;
+	auto skipped = 0;
+	const auto logSlow = gsl::finally([&] {
+		const auto duration = crl::now() - ms;
+		if (duration >= kSlowPaintDuration) {
+			DEBUG_LOG(("Chat: slow paint of %1 elements (%2 skipped) "
+				"in %3 ms, %4 rects, %5x%6 bounding."
+				).arg(painted
+				).arg(skipped
+				).arg(duration
+				).arg(region.rectCount()
+				).arg(clip.width()
+				).arg(clip.height()));
+		}
+	});
+
 	const auto historyDisplayedEmpty = _history->isDisplayedEmpty()
 		&& (!_migrated || _migrated->isDisplayedEmpty());
 	bool noHistoryDisplayed = _firstLoading || historyDisplayedEmpty;
@@ -602,11 +631,16 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 			p.save();
 			p.translate(0, y);
 			if (clip.y() < y + view->height()) while (y < drawToY) {
-				const auto selection = itemRenderSelection(
-					view,
-					selfromy - mtop,
-					seltoy - mtop);
-				view->draw(p, clip.translated(0, -y), selection, ms);
+				if (intersects(view, y)) {
+					const auto selection = itemRenderSelection(
+						view,
+						selfromy - mtop,
+						seltoy - mtop);
+					view->draw(p, clip.translated(0, -y), selection, ms);
+					++painted;
+				} else {
+					++skipped;
+				}
 
 				if (item->hasViews()) {
 					_controller->content()->scheduleViewIncrement(item);
@@ -648,11 +682,20 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 			while (y < drawToY) {
 				const auto h = view->height();
 				if (hclip.y() < y + h && hdrawtop < y + h) {
-					const auto selection = itemRenderSelection(
-						view,
-						selfromy - htop,
-						seltoy - htop);
-					view->draw(p, hclip.translated(0, -y), selection, ms);
+					if (intersects(view, y)) {
+						const auto selection = itemRenderSelection(
+							view,
+							selfromy - htop,
+							seltoy - htop);
+						view->draw(
+							p,
+							hclip.translated(0, -y),
+							selection,
+							ms);
+						++painted;
+					} else {
+						++skipped;
+					}
 
 					const auto middle = y + h / 2;
 					const auto bottom = y + h;
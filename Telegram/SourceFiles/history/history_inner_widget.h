@@ -68,7 +68,7 @@ public:
 	void updateSize();
 
 	void repaintItem(const HistoryItem *item);
-	void repaintItem(const Element *view);
+	void repaintItem(const Element *view, QRect rect = QRect());
 
 	bool canCopySelected() const;
 	bool canDeleteSelected() const;
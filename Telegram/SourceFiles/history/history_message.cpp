@@ -1510,6 +1510,8 @@ void HistoryMessage::setText(const TextWithEntities &textWithEntities) {
 
 	_textWidth = -1;
 	_textHeight = 0;
+
+	updateSearchIndex();
 }
 
 void HistoryMessage::reapplyText() {
@@ -1526,6 +1528,15 @@ void HistoryMessage::setEmptyText() {
 
 	_textWidth = -1;
 	_textHeight = 0;
+
+	updateSearchIndex();
+}
+
+void HistoryMessage::updateSearchIndex() {
+	auto &owner = history()->owner();
+	if (owner.message(fullId()) == this) {
+		owner.messagesIndex().update(this);
+	}
 }
 
 void HistoryMessage::clearIsolatedEmoji() {
@@ -212,6 +212,7 @@ private:
 	[[nodiscard]] bool checkCommentsLinkedChat(ChannelId id) const;
 
 	void clearIsolatedEmoji();
+	void updateSearchIndex();
 	void checkIsolatedEmoji();
 
 	// For an invoice button we replace the button text with a "Receipt" key.
@@ -652,6 +652,10 @@ auto Element::verticalRepaintRange() const -> VerticalRepaintRange {
 	};
 }
 
+QRect Element::innerGeometry() const {
+	return QRect(0, 0, width(), height());
+}
+
 bool Element::hasHeavyPart() const {
 	return false;
 }
@@ -297,6 +297,10 @@ public:
 	};
 	[[nodiscard]] virtual VerticalRepaintRange verticalRepaintRange() const;
 
+	// The part of the view that media progress and animation frames
+	// are painted in, so that only this part is repainted for them.
+	[[nodiscard]] virtual QRect innerGeometry() const;
+
 	virtual bool hasHeavyPart() const;
 	virtual void unloadHeavyPart();
 	void checkHeavyPart();
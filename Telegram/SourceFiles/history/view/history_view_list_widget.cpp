@@ -56,6 +56,7 @@ constexpr auto kPreloadIfLessThanScreens = 2;
 constexpr auto kPreloadedScreensCountFull
 	= kPreloadedScreensCount + 1 + kPreloadedScreensCount;
 constexpr auto kClearUserpicsAfter = 50;
+constexpr auto kSlowPaintDuration = crl::time(16);
 
 } // namespace
 
@@ -257,9 +258,9 @@ ListWidget::ListWidget(
 	setMouseTracking(true);
 	_scrollDateHideTimer.setCallback([this] { scrollDateHideByTimer(); });
 	session().data().viewRepaintRequest(
-	) | rpl::start_with_next([this](auto view) {
-		if (view->delegate() == this) {
-			repaintItem(view);
+	) | rpl::start_with_next([this](auto request) {
+		if (request.view->delegate() == this) {
+			repaintItem(request.view, request.rect);
 		}
 	}, lifetime());
 	session().data().viewResizeRequest(
@@ -1455,6 +1456,25 @@ void ListWidget::paintEvent(QPaintEvent *e) {
 	auto ms = crl::now();
 	auto clip = e->rect();
 
+	// Separate repaint requests of several elements are merged in one
+	// paint event, skip the elements between them in the bounding rect.
+	const auto &region = e->region();
+	auto painted = 0;
+	auto skipped = 0;
+	const auto logSlow = gsl::finally([&] {
+		const auto duration = crl::now() - ms;
+		if (duration >= kSlowPaintDuration) {
+			DEBUG_LOG(("Chat: slow paint of %1 elements (%2 skipped) "
+				"in %3 ms, %4 rects, %5x%6 bounding."
+				).arg(painted
+				).arg(skipped
+				).arg(duration
+				).arg(region.rectCount()
+				).arg(clip.width()
+				).arg(clip.height()));
+		}
+	});
+
 	auto from = std::lower_bound(begin(_items), end(_items), clip.top(), [this](auto &elem, int top) {
 		return this->itemTop(elem) + elem->height() <= top;
 	});
@@ -1466,11 +1486,18 @@ void ListWidget::paintEvent(QPaintEvent *e) {
 		p.translate(0, top);
 		for (auto i = from; i != to; ++i) {
 			const auto view = *i;
-			view->draw(
-				p,
-				clip.translated(0, -top),
-				itemRenderSelection(view),
-				ms);
+			const auto range = view->verticalRepaintRange();
+			if (region.intersects(
+					QRect(0, top + range.top, width(), range.height))) {
+				view->draw(
+					p,
+					clip.translated(0, -top),
+					itemRenderSelection(view),
+					ms);
+				++painted;
+			} else {
+				++skipped;
+			}
 			const auto height = view->height();
 			top += height;
 			p.translate(0, height);
@@ -2569,13 +2596,17 @@ int ListWidget::itemTop(not_null<const Element*> view) const {
 	return _itemsTop + view->y();
 }
 
-void ListWidget::repaintItem(const Element *view) {
+void ListWidget::repaintItem(const Element *view, QRect rect) {
 	if (!view) {
 		return;
 	}
 	const auto top = itemTop(view);
-	const auto range = view->verticalRepaintRange();
-	update(0, top + range.top, width(), range.height);
+	if (!rect.isEmpty()) {
+		update(rect.translated(0, top));
+	} else {
+		const auto range = view->verticalRepaintRange();
+		update(0, top + range.top, width(), range.height);
+	}
 }
 
 void ListWidget::repaintItem(FullMsgId itemId) {
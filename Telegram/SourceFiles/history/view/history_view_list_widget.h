@@ -339,7 +339,7 @@ private:
 	style::cursor computeMouseCursor() const;
 	int itemTop(not_null<const Element*> view) const;
 	void repaintItem(FullMsgId itemId);
-	void repaintItem(const Element *view);
+	void repaintItem(const Element *view, QRect rect = QRect());
 	void resizeItem(not_null<Element*> view);
 	void refreshItem(not_null<const Element*> view);
 	void itemRemoved(not_null<const HistoryItem*> item);
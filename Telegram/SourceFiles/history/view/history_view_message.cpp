@@ -1973,6 +1973,12 @@ auto Message::verticalRepaintRange() const -> VerticalRepaintRange {
 	};
 }
 
+QRect Message::innerGeometry() const {
+	const auto media = this->media();
+	const auto add = media ? media->bubbleRollRepaintMargins() : QMargins();
+	return countGeometry().marginsAdded(add);
+}
+
 void Message::refreshDataIdHook() {
 	if (base::take(_rightActionLink)) {
 		_rightActionLink = rightActionLink();
@@ -108,6 +108,7 @@ public:
 	int infoWidth() const override;
 
 	VerticalRepaintRange verticalRepaintRange() const override;
+	QRect innerGeometry() const override;
 
 	void applyGroupAdminChanges(
 		const base::flat_set<UserId> &changes) override;
@@ -778,7 +778,7 @@ void Document::updatePressed(QPoint point) {
 			const auto nameleft = st.padding.left() + st.thumbSize + st.padding.right();
 			const auto nameright = st.padding.left();
 			voice->setSeekingCurrent(snap((point.x() - nameleft) / float64(width() - nameleft - nameright), 0., 1.));
-			history()->owner().requestViewRepaint(_parent);
+			repaint();
 		}
 	}
 }
@@ -990,7 +990,7 @@ bool Document::voiceProgressAnimationCallback(crl::time now) {
 			} else {
 				voice->_playback->progress.update(qMin(dt, 1.), anim::linear);
 			}
-			history()->owner().requestViewRepaint(_parent);
+			repaint();
 			return (dt < 1.);
 		}
 	}
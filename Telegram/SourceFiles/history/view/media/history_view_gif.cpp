@@ -1476,7 +1476,7 @@ void Gif::repaintStreamedContent() {
 		&& !activeRoundStreamed()) {
 		return;
 	}
-	history()->owner().requestViewRepaint(_parent);
+	repaint();
 }
 
 void Gif::streamingReady(::Media::Streaming::Information &&info) {
@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lottie/lottie_single_player.h"
 #include "storage/storage_shared_media.h"
 #include "data/data_document.h"
+#include "data/data_session.h"
 #include "ui/item_text_options.h"
 #include "core/ui_integration.h"
 #include "styles/style_chat.h"
@@ -122,6 +123,10 @@ bool Media::isDisplayed() const {
 	return true;
 }
 
+void Media::repaint() const {
+	history()->owner().requestViewRepaint(_parent, _parent->innerGeometry());
+}
+
 QSize Media::countCurrentSize(int newWidth) {
 	return QSize(qMin(newWidth, maxWidth()), minHeight());
 }
@@ -299,6 +299,9 @@ protected:
 	virtual void playAnimation(bool autoplay) {
 	}
 
+	// For progress and animation frames, that never leave the bubble.
+	void repaint() const;
+
 	const not_null<Element*> _parent;
 	MediaInBubbleState _inBubbleState = MediaInBubbleState::None;
 
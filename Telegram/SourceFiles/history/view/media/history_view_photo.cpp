@@ -738,7 +738,7 @@ void Photo::repaintStreamedContent() {
 	} else if (_parent->delegate()->elementIsGifPaused()) {
 		return;
 	}
-	history()->owner().requestViewRepaint(_parent);
+	repaint();
 }
 
 void Photo::streamingReady(::Media::Streaming::Information &&info) {
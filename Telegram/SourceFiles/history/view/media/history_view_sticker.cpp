@@ -30,6 +30,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_file_origin.h"
 #include "lottie/lottie_single_player.h"
 #include "chat_helpers/stickers_lottie.h"
+#include "chat_helpers/stickers_emoji_pack.h"
 #include "styles/style_chat.h"
 
 namespace HistoryView {
@@ -116,7 +117,7 @@ QSize Sticker::size() {
 }
 
 bool Sticker::readyToDrawLottie() {
-	if (!_lastDiceFrame.isNull()) {
+	if (!_lastDiceFrame.isNull() || !_stillFrame.isNull()) {
 		return true;
 	}
 	const auto sticker = _data->sticker();
@@ -128,6 +129,15 @@ bool Sticker::readyToDrawLottie() {
 	_dataMedia->checkStickerLarge();
 	const auto loaded = _dataMedia->loaded();
 	if (sticker->animated && !_lottie && loaded) {
+		if (_lottieOncePlayed && isEmojiSticker()) {
+			_stillFrame = _data->session().emojiStickersPack().stillFrame(
+				_data,
+				_replacements,
+				size() * cIntRetinaFactor());
+			if (!_stillFrame.isNull()) {
+				return true;
+			}
+		}
 		setupLottie();
 	}
 	return (_lottie && _lottie->ready());
@@ -170,10 +180,11 @@ void Sticker::paintLottie(Painter &p, const QRect &r, bool selected) {
 		_nextLastDiceFrame = false;
 		_lastDiceFrame = CacheDiceImage(_diceEmoji, _diceIndex, frame.image);
 	}
-	const auto &image = _lastDiceFrame.isNull()
-		? frame.image
+	const auto &still = _lastDiceFrame.isNull()
+		? _stillFrame
 		: _lastDiceFrame;
-	const auto prepared = (!_lastDiceFrame.isNull() && selected)
+	const auto &image = still.isNull() ? frame.image : still;
+	const auto prepared = (!still.isNull() && selected)
 		? Images::prepareColored(st::msgStickerOverlay->c, image)
 		: image;
 	const auto size = prepared.size() / cIntRetinaFactor();
@@ -184,7 +195,7 @@ void Sticker::paintLottie(Painter &p, const QRect &r, bool selected) {
 				r.y() + (r.height() - size.height()) / 2),
 			size),
 		prepared);
-	if (!_lastDiceFrame.isNull()) {
+	if (!still.isNull()) {
 		return;
 	}
 
@@ -196,6 +207,16 @@ void Sticker::paintLottie(Painter &p, const QRect &r, bool selected) {
 		: (isEmojiSticker()
 			|| !Core::App().settings().loopAnimatedStickers());
 	const auto count = _lottie->information().framesCount;
+	if (_lottieOncePlayed
+		&& !frame.index
+		&& !selected
+		&& isEmojiSticker()) {
+		_data->session().emojiStickersPack().rememberStillFrame(
+			_data,
+			_replacements,
+			request.box,
+			frame.image);
+	}
 	_frameIndex = frame.index;
 	_framesCount = count;
 	_nextLastDiceFrame = !paused
@@ -266,6 +287,7 @@ void Sticker::refreshLink() {
 				return;
 			}
 			that->_lottieOncePlayed = false;
+			that->_stillFrame = QImage();
 			that->_parent->history()->owner().requestViewRepaint(
 				that->_parent);
 		});
@@ -319,7 +341,9 @@ void Sticker::lottieCreated() {
 		v::match(update.data, [&](const Lottie::Information &information) {
 			_parent->history()->owner().requestViewResize(_parent);
 		}, [&](const Lottie::DisplayFrameRequest &request) {
-			_parent->history()->owner().requestViewRepaint(_parent);
+			_parent->history()->owner().requestViewRepaint(
+				_parent,
+				_parent->innerGeometry());
 		});
 	}, _lifetime);
 }
@@ -330,6 +354,7 @@ bool Sticker::hasHeavyPart() const {
 
 void Sticker::unloadHeavyPart() {
 	unloadLottie();
+	_stillFrame = QImage();
 	_dataMedia = nullptr;
 }
 
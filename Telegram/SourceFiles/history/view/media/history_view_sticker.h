@@ -49,6 +49,7 @@ public:
 	}
 	void stickerClearLoopPlayed() override {
 		_lottieOncePlayed = false;
+		_stillFrame = QImage();
 	}
 	std::unique_ptr<Lottie::SinglePlayer> stickerTakeLottie(
 		not_null<DocumentData*> data,
@@ -102,6 +103,7 @@ private:
 	ClickHandlerPtr _link;
 	QSize _size;
 	QImage _lastDiceFrame;
+	QImage _stillFrame;
 	QString _diceEmoji;
 	int _diceIndex = -1;
 	mutable int _frameIndex = -1;
@@ -69,15 +69,7 @@ PhotoData *ItemBase::getPreviewPhoto() const {
 void ItemBase::preload() const {
 	const auto origin = fileOrigin();
 	if (_result) {
-		if (const auto photo = _result->_photo) {
-			if (photo->hasExact(Data::PhotoSize::Thumbnail)) {
-				photo->load(Data::PhotoSize::Thumbnail, origin);
-			}
-		} else if (const auto document = _result->_document) {
-			document->loadThumbnail(origin);
-		} else if (auto &thumb = _result->_thumbnail; !thumb.empty()) {
-			thumb.load(_result->_session, origin);
-		}
+		_result->preloadThumbnail(origin);
 	} else if (_document) {
 		_document->loadThumbnail(origin);
 	} else if (_photo && _photo->hasExact(Data::PhotoSize::Thumbnail)) {
@@ -361,6 +361,18 @@ bool Result::hasThumbDisplay() const {
 	return false;
 };
 
+void Result::preloadThumbnail(Data::FileOrigin origin) {
+	if (_photo) {
+		if (_photo->hasExact(Data::PhotoSize::Thumbnail)) {
+			_photo->load(Data::PhotoSize::Thumbnail, origin);
+		}
+	} else if (_document) {
+		_document->loadThumbnail(origin);
+	} else if (!_thumbnail.empty()) {
+		_thumbnail.load(_session, origin);
+	}
+}
+
 void Result::addToHistory(
 		History *history,
 		MTPDmessage::Flags flags,
@@ -16,6 +16,7 @@ class UserData;
 
 namespace Data {
 class LocationPoint;
+struct FileOrigin;
 } // namespace Data
 
 namespace InlineBots {
@@ -58,6 +59,7 @@ public:
 	void cancelFile();
 
 	bool hasThumbDisplay() const;
+	void preloadThumbnail(Data::FileOrigin origin);
 
 	void addToHistory(
 		History *history,
@@ -0,0 +1,348 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "inline_bots/inline_bot_results_cache.h"
+
+#include "inline_bots/inline_bot_result.h"
+#include "data/data_session.h"
+#include "data/data_user.h"
+#include "data/data_file_origin.h"
+#include "storage/cache/storage_cache_database.h"
+#include "main/main_session.h"
+#include "base/unixtime.h"
+#include "base/call_delayed.h"
+
+namespace InlineBots {
+namespace {
+
+constexpr auto kMemoryEntriesLimit = 64;
+constexpr auto kPreloadThumbnailsDelay = crl::time(1000);
+
+[[nodiscard]] char PeerTypeKey(not_null<PeerData*> peer) {
+	if (peer->isSelf()) {
+		return 's';
+	} else if (const auto user = peer->asUser()) {
+		return user->isBot() ? 'b' : 'u';
+	} else if (peer->isBroadcast()) {
+		return 'c';
+	}
+	return 'g';
+}
+
+[[nodiscard]] QByteArray Serialize(
+		const MTPmessages_BotResults &result,
+		TimeId expires) {
+	auto buffer = mtpBuffer();
+	buffer.push_back(mtpPrime(expires));
+	result.write(buffer);
+	return QByteArray(
+		reinterpret_cast<const char*>(buffer.constData()),
+		buffer.size() * sizeof(mtpPrime));
+}
+
+[[nodiscard]] std::optional<MTPmessages_BotResults> Deserialize(
+		const QByteArray &value,
+		TimeId &expires) {
+	if (value.size() <= sizeof(mtpPrime)
+		|| (value.size() % sizeof(mtpPrime))) {
+		return std::nullopt;
+	}
+	auto from = reinterpret_cast<const mtpPrime*>(value.constData());
+	const auto end = from + (value.size() / sizeof(mtpPrime));
+	expires = TimeId(*from++);
+	auto result = MTPmessages_BotResults();
+	if (!result.read(from, end) || from != end) {
+		return std::nullopt;
+	}
+	return result;
+}
+
+[[nodiscard]] TimeId ComputeExpires(const MTPmessages_BotResults &result) {
+	return result.match([&](const MTPDmessages_botResults &data) {
+		const auto cacheTime = data.vcache_time().v;
+		return (cacheTime > 0) ? (base::unixtime::now() + cacheTime) : 0;
+	});
+}
+
+[[nodiscard]] QString NextOffset(const MTPmessages_BotResults &result) {
+	return result.match([&](const MTPDmessages_botResults &data) {
+		return qs(data.vnext_offset().value_or_empty());
+	});
+}
+
+} // namespace
+
+ResultsCache::ResultsCache(not_null<Main::Session*> session)
+: _session(session)
+, _api(&session->mtp()) {
+}
+
+ResultsCache::~ResultsCache() {
+	const auto total = _stats.memoryHits + _stats.diskHits + _stats.misses;
+	DEBUG_LOG(("Inline Cache: %1 memory hits, %2 disk hits, %3 misses, "
+		"hit ratio %4%."
+		).arg(_stats.memoryHits
+		).arg(_stats.diskHits
+		).arg(_stats.misses
+		).arg(total
+			? ((_stats.memoryHits + _stats.diskHits) * 100 / total)
+			: 0));
+}
+
+QByteArray ResultsCache::computeKey(const Query &query) const {
+	auto result = QByteArray();
+	result.reserve(64 + (query.query.size() + query.offset.size()) * 2);
+	result.append(QByteArray::number(_session->userId()));
+	result.append(':');
+	result.append(QByteArray::number(query.bot->bareId()));
+	result.append(':');
+	result.append(PeerTypeKey(query.peer));
+	result.append(':');
+	result.append(query.offset.toUtf8());
+	result.append(':');
+	result.append(query.query.toUtf8());
+	return result;
+}
+
+uint64 ResultsCache::request(
+		not_null<UserData*> bot,
+		not_null<PeerData*> peer,
+		const QString &query,
+		const QString &offset,
+		Done done,
+		Fail fail) {
+	return add(
+		{ bot, peer, query, offset },
+		{ .done = std::move(done), .fail = std::move(fail) });
+}
+
+uint64 ResultsCache::add(const Query &query, Request &&request) {
+	const auto key = computeKey(query);
+	const auto requestId = ++_requestIdAutoIncrement;
+	request.key = key;
+	request.query = query;
+	const auto prefetch = request.prefetch;
+	_requests.emplace(requestId, std::move(request));
+
+	const auto i = _entries.find(key);
+	if (i != end(_entries) && i->second.expires > base::unixtime::now()) {
+		if (!prefetch) {
+			++_stats.memoryHits;
+		}
+		i->second.used = ++_usedCounter;
+		crl::on_main(this, [=, result = i->second.result] {
+			deliver(requestId, result);
+		});
+		return requestId;
+	}
+	auto &loading = _loading[key];
+	loading.waiting.push_back(requestId);
+	if (loading.waiting.size() == 1) {
+		lookupDisk(key, query);
+	}
+	return requestId;
+}
+
+void ResultsCache::cancel(uint64 requestId) {
+	const auto i = _requests.find(requestId);
+	if (i == end(_requests)) {
+		return;
+	}
+	const auto key = base::take(i->second.key);
+	_requests.erase(i);
+
+	const auto j = _loading.find(key);
+	if (j == end(_loading)) {
+		return;
+	}
+	auto &waiting = j->second.waiting;
+	waiting.erase(ranges::remove(waiting, requestId), end(waiting));
+	if (waiting.empty()) {
+		_api.request(j->second.requestId).cancel();
+		_loading.erase(j);
+	}
+}
+
+void ResultsCache::lookupDisk(const QByteArray &key, const Query &query) {
+	const auto weak = base::make_weak(this);
+	_session->data().cache().get(
+		Data::InlineResultsCacheKey(key),
+		[=](QByteArray &&value) {
+			crl::on_main(weak, [=, value = std::move(value)] {
+				diskLoaded(key, query, value);
+			});
+		});
+}
+
+void ResultsCache::diskLoaded(
+		const QByteArray &key,
+		const Query &query,
+		const QByteArray &value) {
+	if (!_loading.contains(key)) {
+		return;
+	}
+	auto expires = TimeId();
+	const auto result = value.isEmpty()
+		? std::nullopt
+		: Deserialize(value, expires);
+	if (result && expires > base::unixtime::now()) {
+		remember(key, *result, expires);
+		received(key, *result, true);
+	} else {
+		if (!value.isEmpty()) {
+			_session->data().cache().remove(
+				Data::InlineResultsCacheKey(key));
+		}
+		send(key, query);
+	}
+}
+
+void ResultsCache::send(const QByteArray &key, const Query &query) {
+	const auto i = _loading.find(key);
+	if (i == end(_loading)) {
+		return;
+	}
+	i->second.requestId = _api.request(MTPmessages_GetInlineBotResults(
+		MTP_flags(0),
+		query.bot->inputUser,
+		query.peer->input,
+		MTPInputGeoPoint(),
+		MTP_string(query.query),
+		MTP_string(query.offset)
+	)).done([=](const MTPmessages_BotResults &result) {
+		if (const auto expires = ComputeExpires(result)) {
+			remember(key, result, expires);
+			_session->data().cache().put(
+				Data::InlineResultsCacheKey(key),
+				Serialize(result, expires));
+		}
+		received(key, result, false);
+	}).fail([=](const RPCError &error) {
+		failed(key);
+	}).handleAllErrors().send();
+}
+
+void ResultsCache::received(
+		const QByteArray &key,
+		const MTPmessages_BotResults &result,
+		bool fromDisk) {
+	auto loading = _loading.take(key);
+	if (!loading) {
+		return;
+	}
+	for (const auto requestId : loading->waiting) {
+		const auto i = _requests.find(requestId);
+		if (i != end(_requests) && !i->second.prefetch) {
+			if (fromDisk) {
+				++_stats.diskHits;
+			} else {
+				++_stats.misses;
+			}
+		}
+		deliver(requestId, result);
+	}
+}
+
+void ResultsCache::failed(const QByteArray &key) {
+	auto loading = _loading.take(key);
+	if (!loading) {
+		return;
+	}
+	for (const auto requestId : loading->waiting) {
+		const auto i = _requests.find(requestId);
+		if (i == end(_requests)) {
+			continue;
+		}
+		const auto fail = std::move(i->second.fail);
+		_requests.erase(i);
+		if (fail) {
+			fail();
+		}
+	}
+}
+
+void ResultsCache::remember(
+		const QByteArray &key,
+		const MTPmessages_BotResults &result,
+		TimeId expires) {
+	_entries[key] = Entry{
+		.result = result,
+		.expires = expires,
+		.used = ++_usedCounter,
+	};
+	if (_entries.size() <= kMemoryEntriesLimit) {
+		return;
+	}
+	const auto now = base::unixtime::now();
+	for (auto i = begin(_entries); i != end(_entries);) {
+		if (i->second.expires <= now) {
+			i = _entries.erase(i);
+		} else {
+			++i;
+		}
+	}
+	while (_entries.size() > kMemoryEntriesLimit) {
+		_entries.erase(ranges::min_element(
+			_entries,
+			ranges::less(),
+			[](const auto &pair) { return pair.second.used; }));
+	}
+}
+
+void ResultsCache::deliver(
+		uint64 requestId,
+		const MTPmessages_BotResults &result) {
+	const auto i = _requests.find(requestId);
+	if (i == end(_requests)) {
+		return;
+	}
+	auto request = std::move(i->second);
+	_requests.erase(i);
+
+	if (request.prefetch) {
+		preloadThumbnails(result);
+		return;
+	} else if (!request.query->offset.isEmpty()) {
+		// The user scrolls through the pages, prefetch one more.
+		const auto next = NextOffset(result);
+		if (!next.isEmpty()) {
+			prefetch(*request.query, next);
+		}
+	}
+	request.done(result);
+}
+
+void ResultsCache::prefetch(const Query &query, const QString &offset) {
+	auto next = query;
+	next.offset = offset;
+	const auto key = computeKey(next);
+	if (_entries.contains(key) || _loading.contains(key)) {
+		return;
+	}
+	add(next, { .prefetch = true });
+}
+
+void ResultsCache::preloadThumbnails(const MTPmessages_BotResults &result) {
+	// There are no download priorities, so let the shown page
+	// thumbnails start loading first.
+	base::call_delayed(kPreloadThumbnailsDelay, this, [=] {
+		result.match([&](const MTPDmessages_botResults &data) {
+			_session->data().processUsers(data.vusers());
+			const auto queryId = data.vquery_id().v;
+			for (const auto &item : data.vresults().v) {
+				if (const auto parsed = Result::Create(
+						_session,
+						queryId,
+						item)) {
+					parsed->preloadThumbnail(Data::FileOrigin());
+				}
+			}
+		});
+	});
+}
+
+} // namespace InlineBots
@@ -0,0 +1,107 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+#include "mtproto/sender.h"
+
+class UserData;
+class PeerData;
+
+namespace Main {
+class Session;
+} // namespace Main
+
+namespace InlineBots {
+
+// Inline bot results pages for the whole session, kept in memory and
+// in the cache database for the cache_time the bot has asked for.
+//
+// When the user scrolls to the next page, one more page is requested
+// ahead of time, with its thumbnails preloaded a bit later.
+class ResultsCache final : public base::has_weak_ptr {
+public:
+	using Done = Fn<void(const MTPmessages_BotResults &result)>;
+	using Fail = Fn<void()>;
+
+	explicit ResultsCache(not_null<Main::Session*> session);
+	~ResultsCache();
+
+	// Callbacks are never called before request() returns.
+	[[nodiscard]] uint64 request(
+		not_null<UserData*> bot,
+		not_null<PeerData*> peer,
+		const QString &query,
+		const QString &offset,
+		Done done,
+		Fail fail);
+	void cancel(uint64 requestId);
+
+private:
+	struct Query {
+		not_null<UserData*> bot;
+		not_null<PeerData*> peer;
+		QString query;
+		QString offset;
+	};
+	struct Entry {
+		MTPmessages_BotResults result;
+		TimeId expires = 0;
+		uint64 used = 0;
+	};
+	struct Request {
+		QByteArray key;
+		std::optional<Query> query;
+		Done done;
+		Fail fail;
+		bool prefetch = false;
+	};
+	struct Loading {
+		mtpRequestId requestId = 0;
+		std::vector<uint64> waiting;
+	};
+	struct Stats {
+		int memoryHits = 0;
+		int diskHits = 0;
+		int misses = 0;
+	};
+
+	[[nodiscard]] QByteArray computeKey(const Query &query) const;
+	uint64 add(const Query &query, Request &&request);
+	void lookupDisk(const QByteArray &key, const Query &query);
+	void diskLoaded(
+		const QByteArray &key,
+		const Query &query,
+		const QByteArray &value);
+	void send(const QByteArray &key, const Query &query);
+	void received(
+		const QByteArray &key,
+		const MTPmessages_BotResults &result,
+		bool fromDisk);
+	void failed(const QByteArray &key);
+	void remember(
+		const QByteArray &key,
+		const MTPmessages_BotResults &result,
+		TimeId expires);
+	void deliver(uint64 requestId, const MTPmessages_BotResults &result);
+	void prefetch(const Query &query, const QString &offset);
+	void preloadThumbnails(const MTPmessages_BotResults &result);
+
+	const not_null<Main::Session*> _session;
+	MTP::Sender _api;
+
+	base::flat_map<QByteArray, Entry> _entries;
+	base::flat_map<QByteArray, Loading> _loading;
+	base::flat_map<uint64, Request> _requests;
+	uint64 _requestIdAutoIncrement = 0;
+	uint64 _usedCounter = 0;
+	Stats _stats;
+
+};
+
+} // namespace InlineBots
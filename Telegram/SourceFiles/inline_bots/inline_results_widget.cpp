@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_user.h"
 #include "data/data_session.h"
 #include "inline_bots/inline_bot_result.h"
+#include "inline_bots/inline_bot_results_cache.h"
 #include "inline_bots/inline_results_inner.h"
 #include "main/main_session.h"
 #include "window/window_session_controller.h"
@@ -32,7 +33,6 @@ Widget::Widget(
 	not_null<Window::SessionController*> controller)
 : RpWidget(parent)
 , _controller(controller)
-, _api(&_controller->session().mtp())
 , _contentMaxHeight(st::emojiPanMaxHeight)
 , _contentHeight(_contentMaxHeight)
 , _scroll(this, st::inlineBotsScroll)
@@ -332,7 +332,10 @@ void Widget::inlineBotChanged() {
 		hideAnimated();
 	}
 
-	_api.request(base::take(_inlineRequestId)).cancel();
+	if (_inlineRequestId) {
+		_controller->session().inlineResultsCache().cancel(
+			base::take(_inlineRequestId));
+	}
 	_inlineQuery = _inlineNextQuery = _inlineNextOffset = QString();
 	_inlineBot = nullptr;
 	_inlineCache.clear();
@@ -408,8 +411,8 @@ void Widget::queryInlineBot(UserData *bot, PeerData *peer, QString query) {
 
 	if (_inlineQuery != query || force) {
 		if (_inlineRequestId) {
-			_api.request(_inlineRequestId).cancel();
-			_inlineRequestId = 0;
+			_controller->session().inlineResultsCache().cancel(
+				base::take(_inlineRequestId));
 			_requesting.fire(false);
 		}
 		if (_inlineCache.find(query) != _inlineCache.cend()) {
@@ -436,20 +439,19 @@ void Widget::onInlineRequest() {
 		}
 	}
 	_requesting.fire(true);
-	_inlineRequestId = _api.request(MTPmessages_GetInlineBotResults(
-		MTP_flags(0),
-		_inlineBot->inputUser,
-		_inlineQueryPeer->input,
-		MTPInputGeoPoint(),
-		MTP_string(_inlineQuery),
-		MTP_string(nextOffset)
-	)).done([=](const MTPmessages_BotResults &result) {
-		inlineResultsDone(result);
-	}).fail([=](const RPCError &error) {
-		// show error?
-		_requesting.fire(false);
-		_inlineRequestId = 0;
-	}).handleAllErrors().send();
+	_inlineRequestId = _controller->session().inlineResultsCache().request(
+		_inlineBot,
+		_inlineQueryPeer,
+		_inlineQuery,
+		nextOffset,
+		crl::guard(this, [=](const MTPmessages_BotResults &result) {
+			inlineResultsDone(result);
+		}),
+		crl::guard(this, [=] {
+			// show error?
+			_requesting.fire(false);
+			_inlineRequestId = 0;
+		}));
 }
 
 bool Widget::refreshInlineRows(int *added) {
@@ -13,7 +13,6 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/effects/animations.h"
 #include "ui/effects/panel_animation.h"
 #include "base/timer.h"
-#include "mtproto/sender.h"
 #include "inline_bots/inline_bot_layout_item.h"
 
 namespace Api {
@@ -124,7 +123,6 @@ private:
 	void inlineResultsDone(const MTPmessages_BotResults &result);
 
 	const not_null<Window::SessionController*> _controller;
-	MTP::Sender _api;
 
 	int _contentMaxHeight = 0;
 	int _contentHeight = 0;
@@ -151,7 +149,7 @@ private:
 	UserData *_inlineBot = nullptr;
 	PeerData *_inlineQueryPeer = nullptr;
 	QString _inlineQuery, _inlineNextQuery, _inlineNextOffset;
-	mtpRequestId _inlineRequestId = 0;
+	uint64 _inlineRequestId = 0;
 
 	rpl::event_stream<bool> _requesting;
 
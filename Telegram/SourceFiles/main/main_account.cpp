@@ -35,6 +35,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Main {
 namespace {
 
+// Endpoint stats change on every connect and failure of every session,
+// they are only hints for the next start and may be written rarely.
+constexpr auto kEndpointStatsSaveDelay = 10 * crl::time(1000);
+
 [[nodiscard]] QString ComposeDataString(const QString &dataName, int index) {
 	auto result = dataName;
 	result.replace('#', QString());
@@ -418,6 +422,16 @@ void Account::startMtp(std::unique_ptr<MTP::Config> config) {
 		});
 	}, _lifetime);
 
+	const auto writingStats = _lifetime.make_state<base::Timer>([=] {
+		local().writeMtpConfig();
+	});
+	_mtp->dcOptions().endpointStatsChanged(
+	) | rpl::filter([=] {
+		return !writingStats->isActive();
+	}) | rpl::start_with_next([=] {
+		writingStats->callOnce(kEndpointStatsSaveDelay);
+	}, _lifetime);
+
 	_mtpFields.mainDcId = _mtp->mainDcId();
 
 	_mtp->setUpdatesHandler(::rpcDone([=](
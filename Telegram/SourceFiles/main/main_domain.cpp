@@ -63,13 +63,28 @@ Storage::StartResult Domain::start(const QByteArray &passcode) {
 	Expects(!started());
 
 	const auto result = _local->start(passcode);
+	startFinished(result);
+	return result;
+}
+
+void Domain::start(
+		const QByteArray &passcode,
+		Fn<void(Storage::StartResult)> done) {
+	Expects(!started());
+
+	_local->start(passcode, [=](Storage::StartResult result) {
+		startFinished(result);
+		done(result);
+	});
+}
+
+void Domain::startFinished(Storage::StartResult result) {
 	if (result == Storage::StartResult::Success) {
 		activateAfterStarting();
 		crl::on_main(&Core::App(), [=] { suggestExportIfNeeded(); });
 	} else {
 		Assert(!started());
 	}
-	return result;
 }
 
 void Domain::finish() {
@@ -37,6 +37,9 @@ public:
 
 	[[nodiscard]] bool started() const;
 	[[nodiscard]] Storage::StartResult start(const QByteArray &passcode);
+	void start(
+		const QByteArray &passcode,
+		Fn<void(Storage::StartResult)> done);
 	void resetWithForgottenPasscode();
 	void finish();
 
@@ -73,6 +76,7 @@ public:
 	[[nodiscard]] int activeForStorage() const;
 
 private:
+	void startFinished(Storage::StartResult result);
 	void activateAfterStarting();
 	void activateAuthedAccount();
 	bool removePasscodeIfEmpty();
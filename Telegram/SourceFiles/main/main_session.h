@@ -53,6 +53,10 @@ class EmojiPack;
 class DicePacks;
 } // namespace Stickers;
 
+namespace InlineBots {
+class ResultsCache;
+} // namespace InlineBots
+
 namespace Main {
 
 class Account;
@@ -106,6 +110,9 @@ public:
 	[[nodiscard]] Stickers::DicePacks &diceStickersPacks() const {
 		return *_diceStickersPacks;
 	}
+	[[nodiscard]] InlineBots::ResultsCache &inlineResultsCache() const {
+		return *_inlineResultsCache;
+	}
 	[[nodiscard]] Data::Changes &changes() const {
 		return *_changes;
 	}
@@ -179,6 +186,7 @@ private:
 	// _emojiStickersPack depends on _data.
 	const std::unique_ptr<Stickers::EmojiPack> _emojiStickersPack;
 	const std::unique_ptr<Stickers::DicePacks> _diceStickersPacks;
+	const std::unique_ptr<InlineBots::ResultsCache> _inlineResultsCache;
 
 	const std::unique_ptr<Support::Helper> _supportHelper;
 
@@ -1210,7 +1210,7 @@ void MainWidget::setReadyChatBackground(
 		? Data::DefaultWallPaper()
 		: background;
 
-	Background()->set(ready, std::move(image));
+	Background()->setAsync(ready, std::move(image));
 	const auto tile = Data::IsLegacy1DefaultWallPaper(ready);
 	Background()->setTile(tile);
 	Ui::ForceFullRepaint(this);
@@ -26,6 +26,13 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include <numeric>
 
+#if defined __SSE2__ \
+	|| defined _M_X64 \
+	|| (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TDESKTOP_AUDIO_USE_SSE2
+#endif // __SSE2__ || _M_X64 || _M_IX86_FP >= 2
+
 Q_DECLARE_METATYPE(AudioMsgId);
 Q_DECLARE_METATYPE(VoiceWaveform);
 
@@ -1733,13 +1740,25 @@ public:
 
 		auto fmt = format();
 		auto peak = uint16(0);
-		auto callback = [&](uint16 sample) {
-			accumulate_max(peak, sample);
-			sumbytes += Media::Player::kWaveformSamplesCount;
-			if (sumbytes >= countbytes) {
-				sumbytes -= countbytes;
-				peaks.push_back(peak);
-				peak = 0;
+
+		// Each sample adds kWaveformSamplesCount to sumbytes and a peak is
+		// pushed each time it reaches countbytes, so instead of checking
+		// it per sample we find the whole ranges between the pushes.
+		const auto process = [&](auto samples) {
+			const auto step = int64(Media::Player::kWaveformSamplesCount);
+			while (!samples.empty()) {
+				const auto till = (countbytes - sumbytes + step - 1) / step;
+				const auto count = std::min(int64(samples.size()), till);
+				accumulate_max(
+					peak,
+					Media::Audio::MaxSample(samples.subspan(0, count)));
+				samples = samples.subspan(count);
+				sumbytes += count * step;
+				if (sumbytes >= countbytes) {
+					sumbytes -= countbytes;
+					peaks.push_back(peak);
+					peak = 0;
+				}
 			}
 		};
 		while (processed < countbytes) {
@@ -1754,11 +1773,14 @@ public:
 				continue;
 			}
 
-			auto sampleBytes = bytes::make_span(buffer);
 			if (fmt == AL_FORMAT_MONO8 || fmt == AL_FORMAT_STEREO8) {
-				Media::Audio::IterateSamples<uchar>(sampleBytes, callback);
+				process(gsl::make_span(
+					reinterpret_cast<const uchar*>(buffer.constData()),
+					buffer.size()));
 			} else if (fmt == AL_FORMAT_MONO16 || fmt == AL_FORMAT_STEREO16) {
-				Media::Audio::IterateSamples<int16>(sampleBytes, callback);
+				process(gsl::make_span(
+					reinterpret_cast<const int16*>(buffer.constData()),
+					buffer.size() / sizeof(int16)));
 			}
 			processed += sampleSize() * samples;
 		}
@@ -1793,6 +1815,81 @@ private:
 
 };
 
+namespace Audio {
+
+uint16 MaxSample(gsl::span<const uchar> samples) {
+	const auto data = samples.data();
+	const auto count = samples.size();
+	auto maximum = uchar(0x80);
+	auto minimum = uchar(0x80);
+	auto i = decltype(count)(0);
+#ifdef TDESKTOP_AUDIO_USE_SSE2
+	constexpr auto kBlock = sizeof(__m128i);
+	if (count >= kBlock) {
+		auto maximums = _mm_set1_epi8(char(0x80));
+		auto minimums = maximums;
+		for (; i + kBlock <= count; i += kBlock) {
+			const auto values = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(data + i));
+			maximums = _mm_max_epu8(maximums, values);
+			minimums = _mm_min_epu8(minimums, values);
+		}
+		alignas(16) uchar maximumsData[kBlock];
+		alignas(16) uchar minimumsData[kBlock];
+		_mm_store_si128(reinterpret_cast<__m128i*>(maximumsData), maximums);
+		_mm_store_si128(reinterpret_cast<__m128i*>(minimumsData), minimums);
+		for (const auto value : maximumsData) {
+			accumulate_max(maximum, value);
+		}
+		for (const auto value : minimumsData) {
+			accumulate_min(minimum, value);
+		}
+	}
+#endif // TDESKTOP_AUDIO_USE_SSE2
+	for (; i != count; ++i) {
+		accumulate_max(maximum, data[i]);
+		accumulate_min(minimum, data[i]);
+	}
+	return std::max(ReadOneSample(maximum), ReadOneSample(minimum));
+}
+
+uint16 MaxSample(gsl::span<const int16> samples) {
+	const auto data = samples.data();
+	const auto count = samples.size();
+	auto maximum = int16(0);
+	auto minimum = int16(0);
+	auto i = decltype(count)(0);
+#ifdef TDESKTOP_AUDIO_USE_SSE2
+	constexpr auto kBlock = sizeof(__m128i) / sizeof(int16);
+	if (count >= kBlock) {
+		auto maximums = _mm_setzero_si128();
+		auto minimums = maximums;
+		for (; i + kBlock <= count; i += kBlock) {
+			const auto values = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(data + i));
+			maximums = _mm_max_epi16(maximums, values);
+			minimums = _mm_min_epi16(minimums, values);
+		}
+		alignas(16) int16 maximumsData[kBlock];
+		alignas(16) int16 minimumsData[kBlock];
+		_mm_store_si128(reinterpret_cast<__m128i*>(maximumsData), maximums);
+		_mm_store_si128(reinterpret_cast<__m128i*>(minimumsData), minimums);
+		for (const auto value : maximumsData) {
+			accumulate_max(maximum, value);
+		}
+		for (const auto value : minimumsData) {
+			accumulate_min(minimum, value);
+		}
+	}
+#endif // TDESKTOP_AUDIO_USE_SSE2
+	for (; i != count; ++i) {
+		accumulate_max(maximum, data[i]);
+		accumulate_min(minimum, data[i]);
+	}
+	return std::max(ReadOneSample(maximum), ReadOneSample(minimum));
+}
+
+} // namespace Audio
 } // namespace Media
 
 VoiceWaveform audioCountWaveform(
@@ -404,6 +404,10 @@ TG_FORCE_INLINE uint16 ReadOneSample(int16 data) {
 	return qAbs(data);
 }
 
+// Maximum of ReadOneSample() over all the samples, vectorized if possible.
+[[nodiscard]] uint16 MaxSample(gsl::span<const uchar> samples);
+[[nodiscard]] uint16 MaxSample(gsl::span<const int16> samples);
+
 template <typename SampleType, typename Callback>
 void IterateSamples(bytes::const_span bytes, Callback &&callback) {
 	auto samplesPointer = reinterpret_cast<const SampleType*>(bytes.data());
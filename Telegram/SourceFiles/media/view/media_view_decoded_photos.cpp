@@ -0,0 +1,102 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "media/view/media_view_decoded_photos.h"
+
+namespace Media {
+namespace View {
+namespace {
+
+constexpr auto kBytesLimit = int64(128 * 1024 * 1024);
+
+[[nodiscard]] QImage PrepareForScreen(QImage original, QSize fit) {
+	if (original.width() <= fit.width()
+		&& original.height() <= fit.height()) {
+		return original;
+	}
+	return original.scaled(
+		fit,
+		Qt::KeepAspectRatio,
+		Qt::SmoothTransformation);
+}
+
+[[nodiscard]] uint64 SerializeFit(QSize fit) {
+	return (uint64(uint32(fit.width())) << 32) | uint64(uint32(fit.height()));
+}
+
+} // namespace
+
+DecodedPhotos::DecodedPhotos(Fn<void(not_null<PhotoData*>)> ready)
+: _ready(std::move(ready)) {
+}
+
+void DecodedPhotos::prepare(
+		not_null<PhotoData*> photo,
+		const QImage &original,
+		QSize fit) {
+	Expects(!original.isNull());
+
+	auto &entry = _entries[Key(photo, SerializeFit(fit))];
+	entry.used = ++_usedCounter;
+	if (entry.preparing || !entry.image.isNull()) {
+		return;
+	}
+	entry.preparing = true;
+
+	const auto weak = base::make_weak(this);
+	crl::async([=, original = original]() mutable {
+		auto image = PrepareForScreen(std::move(original), fit);
+		crl::on_main(weak, [=, image = std::move(image)]() mutable {
+			ready(photo, fit, std::move(image));
+		});
+	});
+}
+
+QImage DecodedPhotos::lookup(not_null<PhotoData*> photo, QSize fit) {
+	const auto i = _entries.find(Key(photo, SerializeFit(fit)));
+	if (i == end(_entries)) {
+		return QImage();
+	}
+	i->second.used = ++_usedCounter;
+	return i->second.image;
+}
+
+void DecodedPhotos::clear() {
+	_entries.clear();
+	_bytes = 0;
+}
+
+void DecodedPhotos::ready(
+		not_null<PhotoData*> photo,
+		QSize fit,
+		QImage image) {
+	const auto i = _entries.find(Key(photo, SerializeFit(fit)));
+	if (i == end(_entries)) {
+		return;
+	}
+	auto &entry = i->second;
+	_bytes -= entry.image.sizeInBytes();
+	entry.image = std::move(image);
+	entry.preparing = false;
+	_bytes += entry.image.sizeInBytes();
+	checkLimit();
+	_ready(photo);
+}
+
+void DecodedPhotos::checkLimit() {
+	while (_bytes > kBytesLimit && _entries.size() > 1) {
+		const auto oldest = ranges::min_element(
+			_entries,
+			ranges::less(),
+			[](const auto &pair) { return pair.second.used; });
+		_bytes -= oldest->second.image.sizeInBytes();
+		_entries.erase(oldest);
+	}
+}
+
+} // namespace View
+} // namespace Media
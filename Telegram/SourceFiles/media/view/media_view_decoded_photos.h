@@ -0,0 +1,54 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+
+namespace Media {
+namespace View {
+
+// Large photos scaled to the screen size on a background thread,
+// so that switching to a big photo in the viewer doesn't stall
+// the main thread. Full resolution images for zooming in are
+// prepared the same way, as one more size of the same photo.
+//
+// Least recently used images are dropped when the total size
+// of all images exceeds the limit.
+class DecodedPhotos final : public base::has_weak_ptr {
+public:
+	explicit DecodedPhotos(Fn<void(not_null<PhotoData*>)> ready);
+
+	// Does nothing if the image is ready or being prepared for that size.
+	void prepare(
+		not_null<PhotoData*> photo,
+		const QImage &original,
+		QSize fit);
+	[[nodiscard]] QImage lookup(not_null<PhotoData*> photo, QSize fit);
+
+	void clear();
+
+private:
+	using Key = std::pair<not_null<PhotoData*>, uint64>;
+	struct Entry {
+		QImage image;
+		uint64 used = 0;
+		bool preparing = false;
+	};
+
+	void ready(not_null<PhotoData*> photo, QSize fit, QImage image);
+	void checkLimit();
+
+	const Fn<void(not_null<PhotoData*>)> _ready;
+	base::flat_map<Key, Entry> _entries;
+	int64 _bytes = 0;
+	uint64 _usedCounter = 0;
+
+};
+
+} // namespace View
+} // namespace Media
@@ -82,6 +82,8 @@ namespace View {
 namespace {
 
 constexpr auto kPreloadCount = 3;
+constexpr auto kPreloadCountMax = 8;
+constexpr auto kPreloadDecodeCount = 2;
 constexpr auto kMaxZoomLevel = 7; // x8
 constexpr auto kZoomToScreenLevel = 1024;
 constexpr auto kOverlayLoaderPriority = 2;
@@ -316,6 +318,11 @@ OverlayWidget::PipWrap::PipWrap(
 OverlayWidget::OverlayWidget()
 : OverlayParent(nullptr)
 , _transparentBrush(style::transparentPlaceholderBrush())
+, _decodedPhotos([=](not_null<PhotoData*> photo) {
+	if (_photo == photo) {
+		update();
+	}
+})
 , _docDownload(this, tr::lng_media_download(tr::now), st::mediaviewFileLink)
 , _docSaveAs(this, tr::lng_mediaview_save_as(tr::now), st::mediaviewFileLink)
 , _docCancel(this, tr::lng_cancel(tr::now), st::mediaviewFileLink)
@@ -2191,6 +2198,8 @@ void OverlayWidget::displayPhoto(not_null<PhotoData*> photo, HistoryItem *item)
 	refreshCaption(item);
 
 	_blurred = true;
+	_fullStaticContent = false;
+	_displayStarted = crl::now();
 	_down = OverNone;
 	if (!_staticContent.isNull()) {
 		// Video thumbnail.
@@ -3022,8 +3031,56 @@ void OverlayWidget::validatePhotoImage(Image *image, bool blurred) {
 	_blurred = blurred;
 }
 
+void OverlayWidget::validatePhotoLargeImage(not_null<Image*> image) {
+	const auto shown = flipSizeByRotation({ _w, _h }) * cIntRetinaFactor();
+	if (_fullStaticContent) {
+		return;
+	} else if (!_blurred) {
+		if (shown.width() <= _staticContent.width()
+			&& shown.height() <= _staticContent.height()) {
+			return;
+		}
+
+		// Zoomed in further than the screen-sized image allows.
+		// The screen-sized image is shown until the full one is ready.
+		const auto full = flipSizeByRotation({ _width, _height })
+			* cIntRetinaFactor();
+		auto decoded = _decodedPhotos.lookup(_photo, full);
+		if (decoded.isNull()) {
+			_decodedPhotos.prepare(_photo, image->original(), full);
+			return;
+		}
+		_staticContent = App::pixmapFromImageInPlace(std::move(decoded));
+		_staticContent.setDevicePixelRatio(cRetinaFactor());
+		_fullStaticContent = true;
+		return;
+	}
+	const auto fit = photoScreenFit(_photo);
+	auto decoded = _decodedPhotos.lookup(_photo, fit);
+	if (decoded.isNull()) {
+		_decodedPhotos.prepare(_photo, image->original(), fit);
+		return;
+	}
+	_staticContent = App::pixmapFromImageInPlace(std::move(decoded));
+	_staticContent.setDevicePixelRatio(cRetinaFactor());
+	_blurred = false;
+	if (_displayStarted) {
+		DEBUG_LOG(("Media View: Photo %1 shown in %2 ms."
+			).arg(_photo->id
+			).arg(crl::now() - _displayStarted));
+		_displayStarted = 0;
+	}
+}
+
+QSize OverlayWidget::photoScreenFit(not_null<PhotoData*> photo) const {
+	const auto rotation = photo->owner().mediaRotation().get(photo);
+	return FlipSizeByRotation(size(), rotation) * cIntRetinaFactor();
+}
+
 void OverlayWidget::validatePhotoCurrentImage() {
-	validatePhotoImage(_photoMedia->image(Data::PhotoSize::Large), false);
+	if (const auto large = _photoMedia->image(Data::PhotoSize::Large)) {
+		validatePhotoLargeImage(large);
+	}
 	validatePhotoImage(_photoMedia->image(Data::PhotoSize::Thumbnail), true);
 	validatePhotoImage(_photoMedia->image(Data::PhotoSize::Small), true);
 	validatePhotoImage(_photoMedia->thumbnailInline(), true);
@@ -3826,24 +3883,56 @@ void OverlayWidget::preloadData(int delta) {
 	if (!_index) {
 		return;
 	}
-	auto from = *_index + (delta ? delta : -1);
-	auto till = *_index + (delta ? delta * kPreloadCount : 1);
-	if (from > till) std::swap(from, till);
+
+	// When moving in one direction several times in a row we preload
+	// further ahead. Full files are loaded only for the nearest items,
+	// the others get just thumbnails, nearest are requested first.
+	const auto sameDirection = delta
+		&& _preloadDirection
+		&& ((delta > 0) == (_preloadDirection > 0));
+	if (sameDirection) {
+		++_preloadStreak;
+	} else {
+		_preloadStreak = delta ? 1 : 0;
+	}
+	_preloadDirection = delta;
+
+	auto indices = std::vector<int>();
+	if (delta) {
+		const auto count = std::min(
+			kPreloadCount + _preloadStreak - 1,
+			kPreloadCountMax);
+		for (auto i = 1; i <= count; ++i) {
+			indices.push_back(*_index + delta * i);
+		}
+	} else {
+		indices = { *_index, *_index + 1, *_index - 1 };
+	}
 
 	auto photos = base::flat_set<std::shared_ptr<Data::PhotoMedia>>();
 	auto documents = base::flat_set<std::shared_ptr<Data::DocumentMedia>>();
-	for (auto index = from; index != till + 1; ++index) {
-		auto entity = entityByIndex(index);
+	for (auto distance = 0; distance != int(indices.size()); ++distance) {
+		const auto full = (distance < kPreloadCount);
+		auto entity = entityByIndex(indices[distance]);
 		if (auto photo = std::get_if<not_null<PhotoData*>>(&entity.data)) {
 			const auto [i, ok] = photos.emplace((*photo)->createMediaView());
 			(*i)->wanted(Data::PhotoSize::Small, fileOrigin(entity));
-			(*photo)->load(fileOrigin(entity), LoadFromCloudOrLocal, true);
+			if (full) {
+				(*photo)->load(fileOrigin(entity), LoadFromCloudOrLocal, true);
+			}
+			const auto large = (*i)->image(Data::PhotoSize::Large);
+			if (large && distance < kPreloadDecodeCount) {
+				_decodedPhotos.prepare(
+					*photo,
+					large->original(),
+					photoScreenFit(*photo));
+			}
 		} else if (auto document = std::get_if<not_null<DocumentData*>>(
 				&entity.data)) {
 			const auto [i, ok] = documents.emplace(
 				(*document)->createMediaView());
 			(*i)->thumbnailWanted(fileOrigin(entity));
-			if (!(*i)->canBePlayed()) {
+			if (full && !(*i)->canBePlayed()) {
 				(*i)->automaticLoad(fileOrigin(entity), entity.item);
 			}
 		}
@@ -4305,6 +4394,8 @@ void OverlayWidget::setVisibleHook(bool visible) {
 		assignMediaPointer(nullptr);
 		_preloadPhotos.clear();
 		_preloadDocuments.clear();
+		_preloadDirection = _preloadStreak = 0;
+		_decodedPhotos.clear();
 		if (_menu) _menu->hideMenu(true);
 		_controlsHideTimer.stop();
 		_controlsState = ControlsShown;
@@ -16,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_web_page.h"
 #include "data/data_cloud_themes.h" // Data::CloudTheme.
 #include "media/view/media_view_playback_controls.h"
+#include "media/view/media_view_decoded_photos.h"
 
 namespace Data {
 class PhotoMedia;
@@ -353,7 +354,9 @@ private:
 	void initGroupThumbs();
 
 	void validatePhotoImage(Image *image, bool blurred);
+	void validatePhotoLargeImage(not_null<Image*> image);
 	void validatePhotoCurrentImage();
+	[[nodiscard]] QSize photoScreenFit(not_null<PhotoData*> photo) const;
 
 	[[nodiscard]] QSize flipSizeByRotation(QSize size) const;
 
@@ -384,6 +387,8 @@ private:
 	std::shared_ptr<Data::DocumentMedia> _documentMedia;
 	base::flat_set<std::shared_ptr<Data::PhotoMedia>> _preloadPhotos;
 	base::flat_set<std::shared_ptr<Data::DocumentMedia>> _preloadDocuments;
+	int _preloadDirection = 0;
+	int _preloadStreak = 0;
 	int _rotation = 0;
 	std::unique_ptr<SharedMedia> _sharedMedia;
 	std::optional<SharedMediaWithLastSlice> _sharedMediaData;
@@ -430,6 +435,9 @@ private:
 	int32 _dragging = 0;
 	QPixmap _staticContent;
 	bool _blurred = true;
+	bool _fullStaticContent = false;
+	DecodedPhotos _decodedPhotos;
+	crl::time _displayStarted = 0;
 
 	std::unique_ptr<Streamed> _streamed;
 	std::unique_ptr<PipWrap> _pip;
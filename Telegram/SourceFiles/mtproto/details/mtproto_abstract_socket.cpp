@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "mtproto/details/mtproto_abstract_socket.h"
 
+#include "mtproto/details/mtproto_conditioned_socket.h"
 #include "mtproto/details/mtproto_tcp_socket.h"
 #include "mtproto/details/mtproto_tls_socket.h"
 
@@ -16,11 +17,19 @@ std::unique_ptr<AbstractSocket> AbstractSocket::Create(
 		not_null<QThread*> thread,
 		const bytes::vector &secret,
 		const QNetworkProxy &proxy) {
+	auto result = std::unique_ptr<AbstractSocket>();
 	if (secret.size() >= 21 && secret[0] == bytes::type(0xEE)) {
-		return std::make_unique<TlsSocket>(thread, secret, proxy);
+		result = std::make_unique<TlsSocket>(thread, secret, proxy);
 	} else {
-		return std::make_unique<TcpSocket>(thread, proxy);
+		result = std::make_unique<TcpSocket>(thread, proxy);
 	}
+	if (const auto conditions = CurrentNetworkConditions()) {
+		return std::make_unique<ConditionedSocket>(
+			thread,
+			std::move(result),
+			conditions);
+	}
+	return result;
 }
 
 } // namespace MTP::details
@@ -0,0 +1,290 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/details/mtproto_conditioned_socket.h"
+
+#include "base/openssl_help.h"
+
+#include <mutex>
+
+namespace MTP::details {
+namespace {
+
+constexpr auto kReadChunkSize = 64 * 1024;
+constexpr auto kMinRetransmitTimeout = crl::time(200);
+constexpr auto kMaxRetransmits = 8;
+
+NetworkConditions GlobalConditions;
+
+// Transfers of all the sockets are paced together.
+struct SharedLink {
+	std::mutex mutex;
+	crl::time lastIncoming = 0;
+	crl::time lastOutgoing = 0;
+};
+SharedLink GlobalLink;
+
+} // namespace
+
+NetworkConditions ParseNetworkConditions(const QString &value) {
+	const auto parts = value.split(':');
+	const auto part = [&](int index) {
+		return (index < parts.size()) ? parts[index].toLongLong() : 0LL;
+	};
+	return {
+		.latency = std::max(crl::time(part(0)), crl::time(0)),
+		.lossPercent = int(std::clamp(part(1), 0LL, 100LL)),
+		.bandwidth = std::max(int64(part(2)), int64(0)),
+	};
+}
+
+void SetNetworkConditions(NetworkConditions conditions) {
+	GlobalConditions = conditions;
+	if (conditions) {
+		LOG(("Network Conditions: latency %1 ms, loss %2%, bandwidth %3 B/s"
+			).arg(conditions.latency
+			).arg(conditions.lossPercent
+			).arg(conditions.bandwidth));
+	}
+}
+
+NetworkConditions CurrentNetworkConditions() {
+	return GlobalConditions;
+}
+
+ConditionedSocket::ConditionedSocket(
+	not_null<QThread*> thread,
+	std::unique_ptr<AbstractSocket> wrapped,
+	NetworkConditions conditions)
+: AbstractSocket(thread)
+, _wrapped(std::move(wrapped))
+, _conditions(conditions)
+, _timer(thread, [=] { processQueues(); }) {
+	_wrapped->connected(
+	) | rpl::start_with_next([=] {
+		_connectedAt = crl::now() + _conditions.latency;
+		scheduleQueues();
+	}, _lifetime);
+
+	_wrapped->disconnected(
+	) | rpl::start_with_next([=] {
+		wrappedDisconnected();
+	}, _lifetime);
+
+	_wrapped->readyRead(
+	) | rpl::start_with_next([=] {
+		wrappedReadyRead();
+	}, _lifetime);
+
+	_wrapped->error(
+	) | rpl::start_to_stream(_error, _lifetime);
+
+	_wrapped->syncTimeRequests(
+	) | rpl::start_to_stream(_syncTimeRequests, _lifetime);
+}
+
+ConditionedSocket::~ConditionedSocket() {
+	if (!_started) {
+		return;
+	}
+	const auto duration = std::max(crl::now() - _started, crl::time(1));
+	DEBUG_LOG(("Network Conditions: socket finished, "
+		"sent %1 bytes, received %2 bytes in %3 ms, %4 KB/s in."
+		).arg(_bytesSent
+		).arg(_bytesReceived
+		).arg(duration
+		).arg(_bytesReceived * 1000 / (duration * 1024)));
+}
+
+void ConditionedSocket::connectToHost(const QString &address, int port) {
+	_started = crl::now();
+	_wrapped->connectToHost(address, port);
+}
+
+bool ConditionedSocket::isGoodStartNonce(bytes::const_span nonce) {
+	return _wrapped->isGoodStartNonce(nonce);
+}
+
+void ConditionedSocket::timedOut() {
+	_wrapped->timedOut();
+}
+
+bool ConditionedSocket::isConnected() {
+	return _connectedFired && (_disconnectedAt || _wrapped->isConnected());
+}
+
+bool ConditionedSocket::hasBytesAvailable() {
+	return (_availableOffset < _available.size());
+}
+
+int64 ConditionedSocket::read(bytes::span buffer) {
+	const auto left = int(_available.size()) - _availableOffset;
+	const auto count = std::min(int(buffer.size()), left);
+	if (count > 0) {
+		bytes::copy(
+			buffer,
+			bytes::make_span(_available).subspan(_availableOffset, count));
+		_availableOffset += count;
+		if (_availableOffset == _available.size()) {
+			_available.clear();
+			_availableOffset = 0;
+		}
+	}
+	return count;
+}
+
+void ConditionedSocket::write(
+		bytes::const_span prefix,
+		bytes::const_span buffer) {
+	Expects(!buffer.empty());
+
+	if (_disconnectedAt) {
+		return;
+	}
+	auto data = bytes::vector(prefix.size() + buffer.size());
+	bytes::copy(data, prefix);
+	bytes::copy(bytes::make_span(data).subspan(prefix.size()), buffer);
+	_bytesSent += data.size();
+	enqueue(_outgoing, true, std::move(data));
+}
+
+int32 ConditionedSocket::debugState() {
+	return _wrapped->debugState();
+}
+
+void ConditionedSocket::wrappedReadyRead() {
+	while (_wrapped->hasBytesAvailable()) {
+		auto data = bytes::vector(kReadChunkSize);
+		const auto read = _wrapped->read(data);
+		if (read <= 0) {
+			break;
+		}
+		data.resize(read);
+		_bytesReceived += read;
+		enqueue(_incoming, false, std::move(data));
+	}
+}
+
+void ConditionedSocket::wrappedDisconnected() {
+	// Deliver everything received before the disconnect first.
+	_disconnectedAt = std::max(
+		crl::now() + _conditions.latency,
+		_incoming.empty() ? crl::time(0) : _incoming.back().when);
+	if (!_outgoing.empty()) {
+		auto lost = int64();
+		for (const auto &chunk : base::take(_outgoing)) {
+			lost += chunk.data.size();
+		}
+		DEBUG_LOG(("Network Conditions: "
+			"disconnected with %1 bytes not yet sent.").arg(lost));
+	}
+	scheduleQueues();
+}
+
+void ConditionedSocket::enqueue(
+		std::deque<Chunk> &queue,
+		bool outgoing,
+		bytes::vector &&data) {
+	// Chunks in one direction are transferred one after another,
+	// so with a limited bandwidth each one waits for the previous,
+	// even if it was sent by another socket.
+	// A lost chunk is sent again by TCP, delaying all the next ones.
+	auto &last = outgoing ? _lastOutgoing : _lastIncoming;
+	const auto start = std::max(crl::now(), last) + retransmitDelay();
+	last = [&] {
+		const auto bandwidth = _conditions.bandwidth;
+		if (!bandwidth) {
+			return start;
+		}
+		auto &link = GlobalLink;
+		std::lock_guard<std::mutex> lock(link.mutex);
+		auto &busy = outgoing ? link.lastOutgoing : link.lastIncoming;
+		busy = std::max(start, busy) + int64(data.size()) * 1000 / bandwidth;
+		return busy;
+	}();
+	queue.push_back({
+		.data = std::move(data),
+		.when = last + _conditions.latency,
+	});
+	scheduleQueues();
+}
+
+crl::time ConditionedSocket::retransmitDelay() const {
+	if (!_conditions.lossPercent) {
+		return 0;
+	}
+	const auto lost = [&] {
+		return (openssl::RandomValue<uint32>() % 100)
+			< uint32(_conditions.lossPercent);
+	};
+
+	// Each retransmit waits twice as long as the previous one.
+	auto result = crl::time(0);
+	auto timeout = std::max(kMinRetransmitTimeout, 2 * _conditions.latency);
+	for (auto i = 0; i != kMaxRetransmits && lost(); ++i) {
+		result += timeout;
+		timeout *= 2;
+	}
+	return result;
+}
+
+void ConditionedSocket::processQueues() {
+	const auto now = crl::now();
+	if (_connectedAt && _connectedAt <= now) {
+		_connectedAt = 0;
+		_connectedFired = true;
+		_connected.fire({});
+	}
+	while (!_outgoing.empty() && _outgoing.front().when <= now) {
+		_wrapped->write({}, _outgoing.front().data);
+		_outgoing.pop_front();
+	}
+	auto received = false;
+	while (!_incoming.empty() && _incoming.front().when <= now) {
+		const auto &data = _incoming.front().data;
+		_available.insert(end(_available), begin(data), end(data));
+		_incoming.pop_front();
+		received = true;
+	}
+	const auto disconnected = _disconnectedAt
+		&& (_disconnectedAt <= now)
+		&& _incoming.empty();
+	if (disconnected) {
+		_disconnectedAt = 0;
+	}
+	scheduleQueues();
+	if (received) {
+		_readyRead.fire({});
+	}
+	if (disconnected) {
+		_disconnected.fire({});
+	}
+}
+
+void ConditionedSocket::scheduleQueues() {
+	auto next = std::optional<crl::time>();
+	const auto check = [&](crl::time when) {
+		if (when && (!next || *next > when)) {
+			next = when;
+		}
+	};
+	check(_connectedAt);
+	check(_disconnectedAt);
+	if (!_outgoing.empty()) {
+		check(_outgoing.front().when);
+	}
+	if (!_incoming.empty()) {
+		check(_incoming.front().when);
+	}
+	if (!next) {
+		_timer.cancel();
+	} else {
+		_timer.callOnce(std::max(*next - crl::now(), crl::time(0)));
+	}
+}
+
+} // namespace MTP::details
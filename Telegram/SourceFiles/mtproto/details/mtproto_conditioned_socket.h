@@ -0,0 +1,95 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "mtproto/details/mtproto_abstract_socket.h"
+#include "base/timer.h"
+
+#include <deque>
+
+namespace MTP::details {
+
+// Artificial network conditions for measuring the network stack locally.
+// The bandwidth is shared by all the sockets, like a single network link.
+struct NetworkConditions {
+	crl::time latency = 0; // Added to each direction.
+	int lossPercent = 0; // Chance to lose each chunk in each direction.
+	int64 bandwidth = 0; // Bytes per second in each direction, 0 - no limit.
+
+	[[nodiscard]] bool empty() const {
+		return !latency && !lossPercent && !bandwidth;
+	}
+	[[nodiscard]] explicit operator bool() const {
+		return !empty();
+	}
+};
+
+// Parses "latency:loss:bandwidth", for example "300:2:65536".
+[[nodiscard]] NetworkConditions ParseNetworkConditions(const QString &value);
+
+// Should be called before any connection is created.
+void SetNetworkConditions(NetworkConditions conditions);
+[[nodiscard]] NetworkConditions CurrentNetworkConditions();
+
+class ConditionedSocket final : public AbstractSocket {
+public:
+	ConditionedSocket(
+		not_null<QThread*> thread,
+		std::unique_ptr<AbstractSocket> wrapped,
+		NetworkConditions conditions);
+	~ConditionedSocket();
+
+	void connectToHost(const QString &address, int port) override;
+	bool isGoodStartNonce(bytes::const_span nonce) override;
+	void timedOut() override;
+	bool isConnected() override;
+	bool hasBytesAvailable() override;
+	int64 read(bytes::span buffer) override;
+	void write(bytes::const_span prefix, bytes::const_span buffer) override;
+
+	int32 debugState() override;
+
+private:
+	struct Chunk {
+		bytes::vector data;
+		crl::time when = 0;
+	};
+
+	void wrappedReadyRead();
+	void wrappedDisconnected();
+	void enqueue(
+		std::deque<Chunk> &queue,
+		bool outgoing,
+		bytes::vector &&data);
+	[[nodiscard]] crl::time retransmitDelay() const;
+	void processQueues();
+	void scheduleQueues();
+
+	const std::unique_ptr<AbstractSocket> _wrapped;
+	const NetworkConditions _conditions;
+	base::Timer _timer;
+
+	std::deque<Chunk> _incoming;
+	std::deque<Chunk> _outgoing;
+	crl::time _lastIncoming = 0;
+	crl::time _lastOutgoing = 0;
+	crl::time _connectedAt = 0;
+	crl::time _disconnectedAt = 0;
+	bool _connectedFired = false;
+	bytes::vector _available;
+	int _availableOffset = 0;
+
+	crl::time _started = 0;
+	int64 _bytesSent = 0;
+	int64 _bytesReceived = 0;
+
+	rpl::lifetime _lifetime;
+
+};
+
+} // namespace MTP::details
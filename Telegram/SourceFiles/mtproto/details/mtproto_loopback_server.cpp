@@ -0,0 +1,707 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "mtproto/details/mtproto_loopback_server.h"
+
+#include "base/openssl_help.h"
+#include "base/unixtime.h"
+
+#include <QtNetwork/QHostAddress>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+namespace MTP::details {
+namespace {
+
+constexpr auto kStartSize = 64;
+constexpr auto kAbridgedProtocolId = 0xEFEFEFEFU;
+constexpr auto kPaddedProtocolId = 0xDDDDDDDDU;
+constexpr auto kPacketSizeMax = int(0x01000000 * sizeof(mtpPrime));
+constexpr auto kUnknownSize = -1;
+constexpr auto kInvalidSize = -2;
+constexpr auto kReadChunkSize = 64 * 1024;
+constexpr auto kExternalHeaderInts = 6; // auth_key_id, msg_key
+constexpr auto kEncryptedHeaderInts = 8; // salt, session, id, seq, length
+constexpr auto kMinPaddingInts = 3;
+
+[[nodiscard]] bool IsPaddedSecret(bytes::const_span secret) {
+	return (secret.size() == 17) && (secret[0] == bytes::type(0xDD));
+}
+
+[[nodiscard]] MTPint128 ComputeMsgKey(
+		const AuthKeyPtr &key,
+		bool fromClient,
+		const void *data,
+		uint32 size) {
+	uchar msgKeyLarge[32];
+
+	SHA256_CTX context;
+	SHA256_Init(&context);
+	SHA256_Update(&context, key->partForMsgKey(fromClient), 32);
+	SHA256_Update(&context, data, size);
+	SHA256_Final(msgKeyLarge, &context);
+
+	auto result = MTPint128();
+	memcpy(&result, msgKeyLarge + 8, sizeof(result));
+	return result;
+}
+
+template <typename Type>
+[[nodiscard]] mtpBuffer Serialize(const Type &object) {
+	auto result = mtpBuffer();
+	object.write(result);
+	return result;
+}
+
+} // namespace
+
+LoopbackTransport::LoopbackTransport(Side side, bytes::const_span secret)
+: _side(side)
+, _secret(IsPaddedSecret(secret)
+	? bytes::make_vector(secret.subspan(1))
+	: bytes::make_vector(secret))
+, _padded((side == Side::Client) && IsPaddedSecret(secret)) {
+	Expects(_secret.empty() || _secret.size() == 16);
+}
+
+void LoopbackTransport::prepareKey(
+		bytes::span key,
+		bytes::const_span source) const {
+	if (_secret.empty()) {
+		bytes::copy(key, source);
+	} else {
+		const auto payload = bytes::concatenate(source, _secret);
+		bytes::copy(key, openssl::Sha256(payload));
+	}
+}
+
+void LoopbackTransport::prepareKeys(bytes::const_span nonce) {
+	// The client sends with the direct key and receives with the reversed.
+	const auto direct = nonce.subspan(8, 48);
+	auto reversedBytes = bytes::make_vector(direct);
+	std::reverse(reversedBytes.begin(), reversedBytes.end());
+	const auto reversed = bytes::const_span(reversedBytes);
+
+	const auto prepare = [&](
+			bytes::span key,
+			CTRState &state,
+			bytes::const_span source) {
+		prepareKey(key, source.subspan(0, CTRState::KeySize));
+		bytes::copy(
+			bytes::make_span(state.ivec),
+			source.subspan(CTRState::KeySize, CTRState::IvecSize));
+	};
+	const auto client = (_side == Side::Client);
+	prepare(
+		bytes::make_span(_sendKey),
+		_sendState,
+		client ? direct : reversed);
+	prepare(
+		bytes::make_span(_receiveKey),
+		_receiveState,
+		client ? reversed : direct);
+}
+
+bytes::vector LoopbackTransport::prepareStart(
+		int16 dcId,
+		Fn<bool(bytes::const_span)> goodNonce) {
+	Expects(_side == Side::Client);
+
+	auto result = bytes::vector(kStartSize);
+	do {
+		bytes::set_random(result);
+	} while (!goodNonce(result));
+
+	prepareKeys(result);
+
+	const auto protocol = reinterpret_cast<uint32*>(result.data() + 56);
+	*protocol = _padded ? kPaddedProtocolId : kAbridgedProtocolId;
+	const auto protocolDcId = reinterpret_cast<int16*>(result.data() + 60);
+	*protocolDcId = dcId;
+
+	// Only the protocol and dc ids are sent encrypted.
+	auto encrypted = result;
+	aesCtrEncrypt(encrypted, _sendKey, &_sendState);
+	bytes::copy(
+		bytes::make_span(result).subspan(56),
+		bytes::make_span(encrypted).subspan(56));
+	return result;
+}
+
+bool LoopbackTransport::readStart(bytes::const_span start) {
+	Expects(_side == Side::Server);
+	Expects(start.size() == kStartSize);
+
+	prepareKeys(start);
+
+	auto decrypted = bytes::make_vector(start);
+	aesCtrEncrypt(decrypted, _receiveKey, &_receiveState);
+	const auto protocol = *reinterpret_cast<const uint32*>(
+		decrypted.data() + 56);
+	if (protocol == kPaddedProtocolId && !_secret.empty()) {
+		_padded = true;
+		return true;
+	}
+	return (protocol == kAbridgedProtocolId);
+}
+
+bytes::vector LoopbackTransport::wrap(const mtpBuffer &packet) {
+	Expects(!packet.isEmpty() && packet.size() < 0x1000000);
+
+	const auto ints = uint32(packet.size());
+	const auto size = int(ints * sizeof(mtpPrime));
+	const auto padding = _padded
+		? int(openssl::RandomValue<uint32>() & 0x0F)
+		: 0;
+	const auto header = (_padded || ints >= 0x7F) ? 4 : 1;
+	auto result = bytes::vector(header + size + padding);
+	const auto data = reinterpret_cast<uchar*>(result.data());
+	if (_padded) {
+		const auto length = uint32(size + padding);
+		memcpy(data, &length, sizeof(length));
+	} else if (header == 1) {
+		data[0] = uchar(ints);
+	} else {
+		data[0] = uchar(0x7F);
+		data[1] = uchar(ints & 0xFF);
+		data[2] = uchar((ints >> 8) & 0xFF);
+		data[3] = uchar((ints >> 16) & 0xFF);
+	}
+	const auto body = bytes::make_span(result).subspan(header);
+	bytes::copy(body, bytes::make_span(packet));
+	if (padding) {
+		bytes::set_random(body.subspan(size));
+	}
+	aesCtrEncrypt(result, _sendKey, &_sendState);
+	return result;
+}
+
+int LoopbackTransport::packetLength(
+		bytes::const_span data,
+		int &header) const {
+	const auto raw = reinterpret_cast<const uchar*>(data.data());
+	if (_padded) {
+		header = 4;
+		if (data.size() < 4) {
+			return kUnknownSize;
+		}
+		const auto length = *reinterpret_cast<const uint32*>(raw);
+		return (length >= 4 && length < kPacketSizeMax)
+			? int(length) + header
+			: kInvalidSize;
+	} else if (data.empty()) {
+		return kUnknownSize;
+	} else if (raw[0] == 0x7F) {
+		header = 4;
+		if (data.size() < 4) {
+			return kUnknownSize;
+		}
+		const auto ints = uint32(raw[1])
+			| (uint32(raw[2]) << 8)
+			| (uint32(raw[3]) << 16);
+		return (ints >= 0x7F)
+			? int(ints * sizeof(mtpPrime)) + header
+			: kInvalidSize;
+	} else if (raw[0] > 0 && raw[0] < 0x7F) {
+		header = 1;
+		return int(raw[0] * sizeof(mtpPrime)) + header;
+	}
+	return kInvalidSize;
+}
+
+bool LoopbackTransport::feed(
+		bytes::const_span data,
+		const Fn<void(mtpBuffer&&)> &packet) {
+	const auto was = int(_received.size());
+	_received.resize(was + data.size());
+	const auto added = bytes::make_span(_received).subspan(was);
+	bytes::copy(added, data);
+	aesCtrEncrypt(added, _receiveKey, &_receiveState);
+
+	auto offset = 0;
+	while (true) {
+		const auto available = bytes::make_span(_received).subspan(offset);
+		auto header = 0;
+		const auto length = packetLength(available, header);
+		if (length == kInvalidSize) {
+			return false;
+		} else if (length == kUnknownSize || length > available.size()) {
+			break;
+		}
+		// Padded packets may have up to 15 random bytes in the end.
+		const auto body = available.subspan(header, length - header);
+		auto ints = mtpBuffer(body.size() / sizeof(mtpPrime));
+		bytes::copy(
+			bytes::make_span(ints),
+			body.subspan(0, ints.size() * sizeof(mtpPrime)));
+		offset += length;
+		packet(std::move(ints));
+	}
+	if (offset > 0) {
+		_received.erase(begin(_received), begin(_received) + offset);
+	}
+	return true;
+}
+
+mtpBuffer LoopbackEncrypt(
+		const AuthKeyPtr &key,
+		bool fromClient,
+		const mtpBuffer &message) {
+	Expects(message.size() > kEncryptedHeaderInts);
+
+	// At least 12 bytes of padding, the full size is divisible by 16.
+	const auto paddingInts = kMinPaddingInts
+		+ ((4 - ((message.size() + kMinPaddingInts) % 4)) % 4);
+	auto plain = message;
+	plain.resize(message.size() + paddingInts);
+	bytes::set_random(bytes::make_span(plain).subspan(
+		message.size() * sizeof(mtpPrime)));
+
+	const auto size = uint32(plain.size() * sizeof(mtpPrime));
+	const auto msgKey = ComputeMsgKey(
+		key,
+		fromClient,
+		plain.constData(),
+		size);
+
+	MTPint256 aesKey, aesIV;
+	key->prepareAES(msgKey, aesKey, aesIV, fromClient);
+
+	auto result = mtpBuffer(kExternalHeaderInts + plain.size());
+	const auto keyId = key->keyId();
+	memcpy(result.data(), &keyId, sizeof(keyId));
+	memcpy(result.data() + 2, &msgKey, sizeof(msgKey));
+	aesIgeEncryptRaw(
+		plain.constData(),
+		result.data() + kExternalHeaderInts,
+		size,
+		&aesKey,
+		&aesIV);
+	return result;
+}
+
+std::optional<mtpBuffer> LoopbackDecrypt(
+		const AuthKeyPtr &key,
+		bool fromClient,
+		const mtpBuffer &packet) {
+	constexpr auto kMinInts = kExternalHeaderInts
+		+ kEncryptedHeaderInts
+		+ 4;
+	if (packet.size() < kMinInts
+		|| *reinterpret_cast<const uint64*>(packet.constData())
+			!= key->keyId()) {
+		return std::nullopt;
+	}
+	const auto ints = (packet.size() - kExternalHeaderInts) & ~0x03;
+	const auto size = uint32(ints * sizeof(mtpPrime));
+	auto msgKey = MTPint128();
+	memcpy(&msgKey, packet.constData() + 2, sizeof(msgKey));
+
+	MTPint256 aesKey, aesIV;
+	key->prepareAES(msgKey, aesKey, aesIV, fromClient);
+
+	auto result = mtpBuffer(ints);
+	aesIgeDecryptRaw(
+		packet.constData() + kExternalHeaderInts,
+		result.data(),
+		size,
+		&aesKey,
+		&aesIV);
+
+	const auto check = ComputeMsgKey(
+		key,
+		fromClient,
+		result.constData(),
+		size);
+	if (memcmp(&check, &msgKey, sizeof(msgKey)) != 0) {
+		return std::nullopt;
+	}
+	const auto length = uint32(result[7]);
+	const auto full = kEncryptedHeaderInts * sizeof(mtpPrime)
+		+ length
+		+ kMinPaddingInts * sizeof(mtpPrime);
+	if ((length & 0x03) || full > size) {
+		return std::nullopt;
+	}
+	result.resize(kEncryptedHeaderInts + length / sizeof(mtpPrime));
+	return result;
+}
+
+AuthKeyPtr LoopbackAuthKey(DcId dcId) {
+	auto data = AuthKey::Data();
+	for (auto i = 0; i != AuthKey::kSize; ++i) {
+		data[i] = bytes::type(uchar(i * 7 + dcId));
+	}
+	return std::make_shared<AuthKey>(AuthKey::Type::Generated, dcId, data);
+}
+
+class LoopbackServer::Connection final : public QObject {
+public:
+	Connection(
+		not_null<QTcpServer*> server,
+		not_null<QTcpSocket*> socket,
+		AuthKeyPtr key,
+		bytes::const_span secret,
+		LoopbackResponses responses);
+
+private:
+	void read();
+	void fail(const QString &reason);
+	void handlePacket(const mtpBuffer &packet);
+	void handleNotSecure(const mtpBuffer &packet);
+	void handleMessage(
+		mtpMsgId msgId,
+		uint32 seqNo,
+		const mtpPrime *from,
+		const mtpPrime *end);
+	void respond(
+		mtpBuffer &to,
+		const mtpPrime *from,
+		const mtpPrime *end) const;
+	void sendMessage(const mtpBuffer &body, bool contentRelated);
+	void sendPacket(const mtpBuffer &packet);
+	[[nodiscard]] mtpMsgId nextMessageId();
+
+	const not_null<QTcpSocket*> _socket;
+	const AuthKeyPtr _key;
+	const LoopbackResponses _responses;
+	LoopbackTransport _transport;
+
+	bytes::vector _start;
+	bool _started = false;
+	bool _failed = false;
+
+	uint64 _salt = 0;
+	uint64 _sessionId = 0;
+	mtpMsgId _lastMessageId = 0;
+	uint32 _seqNo = 0;
+
+};
+
+LoopbackServer::Connection::Connection(
+	not_null<QTcpServer*> server,
+	not_null<QTcpSocket*> socket,
+	AuthKeyPtr key,
+	bytes::const_span secret,
+	LoopbackResponses responses)
+: QObject(server)
+, _socket(socket)
+, _key(std::move(key))
+, _responses(responses)
+, _transport(LoopbackTransport::Side::Server, secret) {
+	socket->setParent(this);
+	connect(socket, &QTcpSocket::readyRead, this, [=] { read(); });
+	connect(socket, &QTcpSocket::disconnected, this, [=] {
+		deleteLater();
+	});
+}
+
+void LoopbackServer::Connection::read() {
+	auto buffer = bytes::vector(kReadChunkSize);
+	while (!_failed && _socket->bytesAvailable() > 0) {
+		const auto read = _socket->read(
+			reinterpret_cast<char*>(buffer.data()),
+			buffer.size());
+		if (read <= 0) {
+			break;
+		}
+		auto data = bytes::make_span(buffer).subspan(0, read);
+		if (!_started) {
+			const auto take = std::min(
+				kStartSize - int(_start.size()),
+				int(data.size()));
+			_start.insert(end(_start), data.begin(), data.begin() + take);
+			data = data.subspan(take);
+			if (int(_start.size()) < kStartSize) {
+				continue;
+			} else if (!_transport.readStart(_start)) {
+				return fail("unknown protocol");
+			}
+			_started = true;
+		}
+		const auto handle = [&](mtpBuffer &&packet) {
+			if (!_failed) {
+				handlePacket(packet);
+			}
+		};
+		if (!_transport.feed(data, handle)) {
+			return fail("bad packet length");
+		}
+	}
+}
+
+void LoopbackServer::Connection::fail(const QString &reason) {
+	LOG(("Loopback Error: %1, closing the connection.").arg(reason));
+	_failed = true;
+	_socket->abort();
+	deleteLater();
+}
+
+void LoopbackServer::Connection::handlePacket(const mtpBuffer &packet) {
+	if (packet.size() > 2 && !packet[0] && !packet[1]) {
+		handleNotSecure(packet);
+		return;
+	}
+	const auto message = LoopbackDecrypt(_key, true, packet);
+	if (!message) {
+		return fail("bad encrypted packet");
+	}
+	const auto ints = message->constData();
+	const auto sessionId = *reinterpret_cast<const uint64*>(ints + 2);
+	const auto msgId = *reinterpret_cast<const uint64*>(ints + 4);
+	const auto seqNo = uint32(ints[6]);
+	_salt = *reinterpret_cast<const uint64*>(ints);
+	if (_sessionId != sessionId) {
+		_sessionId = sessionId;
+		_seqNo = 0;
+		sendMessage(Serialize(MTP_new_session_created(
+			MTP_long(msgId),
+			MTP_long(openssl::RandomValue<uint64>()),
+			MTP_long(_salt))), true);
+	}
+	handleMessage(
+		msgId,
+		seqNo,
+		ints + kEncryptedHeaderInts,
+		ints + message->size());
+}
+
+void LoopbackServer::Connection::handleNotSecure(const mtpBuffer &packet) {
+	// auth_key_id, msg_id, length and req_pq with a nonce.
+	constexpr auto kHeaderInts = 5;
+	if (packet.size() < kHeaderInts + 5) {
+		return fail("bad not secure packet");
+	}
+	const auto type = mtpTypeId(packet[kHeaderInts]);
+	if (type != mtpc_req_pq && type != mtpc_req_pq_multi) {
+		return fail("auth key exchange is not supported");
+	}
+	auto from = packet.constData() + kHeaderInts + 1;
+	auto nonce = MTPint128();
+	if (!nonce.read(from, packet.constData() + packet.size())) {
+		return fail("bad req_pq");
+	}
+	auto answer = mtpBuffer(kHeaderInts);
+	const auto msgId = nextMessageId();
+	answer[0] = answer[1] = 0;
+	memcpy(answer.data() + 2, &msgId, sizeof(msgId));
+	MTP_resPQ(
+		nonce,
+		rand_value<MTPint128>(),
+		MTP_bytes(QByteArray(8, char(0x17))),
+		MTP_vector<MTPlong>(QVector<MTPlong>(1, MTP_long(0)))
+	).write(answer);
+	answer[4] = (answer.size() - kHeaderInts) * sizeof(mtpPrime);
+	sendPacket(answer);
+}
+
+void LoopbackServer::Connection::handleMessage(
+		mtpMsgId msgId,
+		uint32 seqNo,
+		const mtpPrime *from,
+		const mtpPrime *end) {
+	if (from >= end) {
+		return;
+	}
+	const auto type = mtpTypeId(*from);
+	if (type == mtpc_msg_container) {
+		if (end - from < 2) {
+			return fail("bad container");
+		}
+		auto count = uint32(from[1]);
+		from += 2;
+		while (count-- > 0) {
+			if (end - from < 4) {
+				return fail("bad container");
+			}
+			const auto innerId = *reinterpret_cast<const uint64*>(from);
+			const auto innerSeqNo = uint32(from[2]);
+			const auto innerEnd = from + 4 + (uint32(from[3]) >> 2);
+			if (innerEnd > end) {
+				return fail("bad container");
+			}
+			handleMessage(innerId, innerSeqNo, from + 4, innerEnd);
+			from = innerEnd;
+		}
+		return;
+	} else if (!(seqNo & 0x01)) {
+		// Acks and other messages not requiring an answer.
+		return;
+	} else if (type == mtpc_ping || type == mtpc_ping_delay_disconnect) {
+		if (end - from >= 3) {
+			const auto pingId = *reinterpret_cast<const uint64*>(from + 1);
+			sendMessage(Serialize(MTP_pong(
+				MTP_long(msgId),
+				MTP_long(pingId))), true);
+		}
+		return;
+	}
+	auto result = mtpBuffer(3);
+	result[0] = mtpc_rpc_result;
+	memcpy(result.data() + 1, &msgId, sizeof(msgId));
+	respond(result, from, end);
+	sendMessage(result, true);
+}
+
+void LoopbackServer::Connection::respond(
+		mtpBuffer &to,
+		const mtpPrime *from,
+		const mtpPrime *end) const {
+	const auto count = int(end - from);
+	switch (mtpTypeId(*from)) {
+	case mtpc_invokeWithLayer:
+		if (count > 2) {
+			return respond(to, from + 2, end);
+		}
+		break;
+	case mtpc_invokeWithoutUpdates:
+		if (count > 1) {
+			return respond(to, from + 1, end);
+		}
+		break;
+	case mtpc_upload_getFile:
+		if (count > 4) {
+			// The limit is the last field of the request.
+			const auto limit = std::clamp(
+				int(end[-1]),
+				0,
+				_responses.fileLimit);
+			MTP_upload_file(
+				MTP_storage_filePartial(),
+				MTP_int(0),
+				MTP_bytes(QByteArray(limit, char(0)))
+			).write(to);
+			return;
+		}
+		break;
+	case mtpc_upload_saveFilePart:
+		MTP_boolTrue().write(to);
+		return;
+	case mtpc_messages_getHistory:
+		if (count > 8) {
+			// The limit is followed by max_id, min_id and hash.
+			const auto limit = std::clamp(
+				int(end[-4]),
+				0,
+				_responses.historyLimit);
+			const auto text = QString(_responses.textLength, QChar('a'));
+			const auto date = base::unixtime::now();
+			auto messages = QVector<MTPMessage>();
+			messages.reserve(limit);
+			for (auto i = 0; i != limit; ++i) {
+				messages.push_back(MTP_message(
+					MTP_flags(MTPDmessage::Flag::f_from_id),
+					MTP_int(limit - i),
+					MTP_peerUser(MTP_int(1)),
+					MTP_peerUser(MTP_int(2)),
+					MTPMessageFwdHeader(),
+					MTPint(), // via_bot_id
+					MTPMessageReplyHeader(),
+					MTP_int(date - i),
+					MTP_string(text),
+					MTPMessageMedia(),
+					MTPReplyMarkup(),
+					MTPVector<MTPMessageEntity>(),
+					MTPint(), // views
+					MTPint(), // forwards
+					MTPMessageReplies(),
+					MTPint(), // edit_date
+					MTPstring(), // post_author
+					MTPlong(), // grouped_id
+					MTPVector<MTPRestrictionReason>()));
+			}
+			MTP_messages_messages(
+				MTP_vector<MTPMessage>(std::move(messages)),
+				MTP_vector<MTPChat>(0),
+				MTP_vector<MTPUser>(0)
+			).write(to);
+			return;
+		}
+		break;
+	}
+	MTP_rpc_error(
+		MTP_int(400),
+		MTP_string("LOOPBACK_METHOD_UNSUPPORTED")
+	).write(to);
+}
+
+void LoopbackServer::Connection::sendMessage(
+		const mtpBuffer &body,
+		bool contentRelated) {
+	auto message = mtpBuffer(kEncryptedHeaderInts);
+	message.reserve(kEncryptedHeaderInts + body.size());
+	const auto msgId = nextMessageId();
+	memcpy(message.data(), &_salt, sizeof(_salt));
+	memcpy(message.data() + 2, &_sessionId, sizeof(_sessionId));
+	memcpy(message.data() + 4, &msgId, sizeof(msgId));
+	message[6] = contentRelated ? (_seqNo++ * 2 + 1) : (_seqNo * 2);
+	message[7] = body.size() * sizeof(mtpPrime);
+	message.append(body);
+	sendPacket(LoopbackEncrypt(_key, false, message));
+}
+
+void LoopbackServer::Connection::sendPacket(const mtpBuffer &packet) {
+	const auto bytes = _transport.wrap(packet);
+	_socket->write(
+		reinterpret_cast<const char*>(bytes.data()),
+		bytes.size());
+}
+
+mtpMsgId LoopbackServer::Connection::nextMessageId() {
+	// Answers from the server have msg_id % 4 == 1.
+	const auto now = mtpMsgId(base::unixtime::now());
+	_lastMessageId = std::max((now << 32) | 1ULL, _lastMessageId + 4);
+	return _lastMessageId;
+}
+
+LoopbackServer::LoopbackServer(
+	AuthKeyPtr key,
+	bytes::vector secret,
+	LoopbackResponses responses)
+: _key(std::move(key))
+, _secret(std::move(secret))
+, _responses(responses)
+, _server(new QTcpServer()) {
+	if (!_server->listen(QHostAddress::LocalHost)) {
+		LOG(("Loopback Error: could not listen, %1"
+			).arg(_server->errorString()));
+		delete base::take(_server);
+		return;
+	}
+	_port = _server->serverPort();
+
+	QObject::connect(_server, &QTcpServer::newConnection, _server, [=] {
+		accept();
+	});
+	QObject::connect(
+		&_thread,
+		&QThread::finished,
+		_server,
+		&QObject::deleteLater);
+	_server->moveToThread(&_thread);
+	_thread.start();
+}
+
+LoopbackServer::~LoopbackServer() {
+	_thread.quit();
+	_thread.wait();
+}
+
+int LoopbackServer::port() const {
+	return _port;
+}
+
+void LoopbackServer::accept() {
+	while (const auto socket = _server->nextPendingConnection()) {
+		socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+		// Owned by the server, deleted when the socket disconnects.
+		new Connection(_server, socket, _key, _secret, _responses);
+	}
+}
+
+} // namespace MTP::details
@@ -0,0 +1,115 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "mtproto/mtproto_auth_key.h"
+#include "base/basic_types.h"
+
+#include <QtCore/QThread>
+
+class QTcpServer;
+
+namespace MTP::details {
+
+// Both ends of the obfuscated TCP transport of a loopback connection.
+// Supports the framing of TcpConnection::Protocol::Version0/1/D:
+// an empty secret selects Version0, sixteen bytes select Version1,
+// the 0xDD byte followed by sixteen bytes selects VersionD.
+class LoopbackTransport final {
+public:
+	enum class Side {
+		Client,
+		Server,
+	};
+	LoopbackTransport(Side side, bytes::const_span secret);
+
+	// Client side, returns the 64 bytes to start the connection with.
+	[[nodiscard]] bytes::vector prepareStart(
+		int16 dcId,
+		Fn<bool(bytes::const_span)> goodNonce);
+
+	// Server side, false if the start bytes are not recognized.
+	[[nodiscard]] bool readStart(bytes::const_span start);
+
+	[[nodiscard]] bytes::vector wrap(const mtpBuffer &packet);
+
+	// Decrypts the received bytes, false if the framing was broken.
+	[[nodiscard]] bool feed(
+		bytes::const_span data,
+		const Fn<void(mtpBuffer&&)> &packet);
+
+private:
+	void prepareKey(bytes::span key, bytes::const_span source) const;
+	void prepareKeys(bytes::const_span nonce);
+	[[nodiscard]] int packetLength(
+		bytes::const_span data,
+		int &header) const;
+
+	const Side _side;
+	bytes::vector _secret;
+	bool _padded = false;
+
+	uchar _sendKey[CTRState::KeySize] = { 0 };
+	CTRState _sendState;
+	uchar _receiveKey[CTRState::KeySize] = { 0 };
+	CTRState _receiveState;
+
+	bytes::vector _received;
+
+};
+
+// MTProto 2.0 encryption of messages with a known key, without
+// any of the salt, time and sequence checks of the real sessions.
+[[nodiscard]] mtpBuffer LoopbackEncrypt(
+	const AuthKeyPtr &key,
+	bool fromClient,
+	const mtpBuffer &message);
+[[nodiscard]] std::optional<mtpBuffer> LoopbackDecrypt(
+	const AuthKeyPtr &key,
+	bool fromClient,
+	const mtpBuffer &packet);
+
+// Same key for the server and the client, no key exchange is done.
+[[nodiscard]] AuthKeyPtr LoopbackAuthKey(DcId dcId);
+
+// Contents of the generated answers, the requests are not validated.
+struct LoopbackResponses {
+	int fileLimit = 1024 * 1024; // Max bytes in upload.file.
+	int historyLimit = 100; // Max messages in messages.messages.
+	int textLength = 100; // Characters in each message text.
+};
+
+// Fake data center on 127.0.0.1 serving on its own thread.
+// Answers the fake req_pq of TcpConnection, ping, upload.getFile,
+// upload.saveFilePart and messages.getHistory, other requests fail.
+class LoopbackServer final {
+public:
+	LoopbackServer(
+		AuthKeyPtr key,
+		bytes::vector secret,
+		LoopbackResponses responses = LoopbackResponses());
+	~LoopbackServer();
+
+	[[nodiscard]] int port() const; // Zero if could not listen.
+
+private:
+	class Connection;
+
+	void accept();
+
+	const AuthKeyPtr _key;
+	const bytes::vector _secret;
+	const LoopbackResponses _responses;
+
+	QThread _thread;
+	QTcpServer *_server = nullptr; // Lives in _thread.
+	int _port = 0;
+
+};
+
+} // namespace MTP::details
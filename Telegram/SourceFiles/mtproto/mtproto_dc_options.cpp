@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/connection_tcp.h"
 #include "storage/serialize_common.h"
 #include "base/qt_adapters.h"
+#include "base/unixtime.h"
 
 #include <QtCore/QFile>
 #include <QtCore/QRegularExpression>
@@ -152,6 +153,8 @@ DcOptions::DcOptions(const DcOptions &other)
 , _publicKeys(other._publicKeys)
 , _cdnPublicKeys(other._cdnPublicKeys)
 , _immutable(other._immutable) {
+	QReadLocker lock(&other._endpointStatsLock);
+	_endpointStats = other._endpointStats;
 }
 
 DcOptions::~DcOptions() = default;
@@ -460,6 +463,15 @@ QByteArray DcOptions::serialize() const {
 		}
 	}
 
+	QReadLocker statsLock(&_endpointStatsLock);
+	size += sizeof(qint32);
+	for (const auto &[key, stats] : _endpointStats) {
+		// id + port + ip + connectTime + successes + failures + lastFailure
+		size += sizeof(qint32) * 2
+			+ sizeof(qint32) + std::get<1>(key).size()
+			+ sizeof(qint32) * 4;
+	}
+
 	constexpr auto kVersion = 1;
 
 	auto result = QByteArray();
@@ -495,6 +507,18 @@ QByteArray DcOptions::serialize() const {
 				<< Serialize::bytes(key.n)
 				<< Serialize::bytes(key.e);
 		}
+
+		// Endpoint stats, older versions just don't read them.
+		stream << qint32(_endpointStats.size());
+		for (const auto &[key, stats] : _endpointStats) {
+			const auto &[dcId, ip, port] = key;
+			stream << qint32(dcId) << qint32(port) << qint32(ip.size());
+			stream.writeRawData(ip.data(), ip.size());
+			stream << qint32(stats.connectTime)
+				<< qint32(stats.successes)
+				<< qint32(stats.failures)
+				<< qint32(stats.lastFailure);
+		}
 	}
 	return result;
 }
@@ -590,9 +614,87 @@ bool DcOptions::constructFromSerialized(const QByteArray &serialized) {
 			}
 		}
 	}
+
+	if (!stream.atEnd()) {
+		readEndpointStats(stream);
+	}
 	return true;
 }
 
+void DcOptions::readEndpointStats(QDataStream &stream) {
+	auto count = qint32(0);
+	stream >> count;
+	if (stream.status() != QDataStream::Ok || count < 0) {
+		LOG(("MTP Error: Bad data for endpoint stats in DcOptions."));
+		return;
+	}
+	auto result = base::flat_map<EndpointKey, EndpointStats>();
+	for (auto i = 0; i != count; ++i) {
+		qint32 dcId = 0, port = 0, ipSize = 0;
+		stream >> dcId >> port >> ipSize;
+
+		constexpr auto kMaxIpSize = 45;
+		if (stream.status() != QDataStream::Ok
+			|| ipSize <= 0
+			|| ipSize > kMaxIpSize) {
+			LOG(("MTP Error: Bad data inside endpoint stats in DcOptions."));
+			return;
+		}
+		auto ip = std::string(ipSize, ' ');
+		stream.readRawData(ip.data(), ipSize);
+
+		qint32 connectTime = 0, successes = 0, failures = 0, lastFailure = 0;
+		stream >> connectTime >> successes >> failures >> lastFailure;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("MTP Error: Bad data inside endpoint stats in DcOptions."));
+			return;
+		}
+		result.emplace(
+			EndpointKey{ DcId(dcId), std::move(ip), int(port) },
+			EndpointStats{ connectTime, successes, failures, lastFailure });
+	}
+	QWriteLocker lock(&_endpointStatsLock);
+	_endpointStats = std::move(result);
+}
+
+auto DcOptions::endpointStats(
+		DcId dcId,
+		const std::string &ip,
+		int port) const -> EndpointStats {
+	QReadLocker lock(&_endpointStatsLock);
+	const auto i = _endpointStats.find(EndpointKey{ dcId, ip, port });
+	return (i != end(_endpointStats)) ? i->second : EndpointStats();
+}
+
+void DcOptions::endpointConnected(
+		DcId dcId,
+		const std::string &ip,
+		int port,
+		crl::time connectTime) {
+	QWriteLocker lock(&_endpointStatsLock);
+	auto &stats = _endpointStats[EndpointKey{ dcId, ip, port }];
+	stats.connectTime = stats.connectTime
+		? ((stats.connectTime * 3 + connectTime) / 4)
+		: std::max(connectTime, crl::time(1));
+	stats.successes = std::min(stats.successes + 1, 0xFFFF);
+	stats.failures = 0;
+	stats.lastFailure = 0;
+}
+
+void DcOptions::endpointFailed(
+		DcId dcId,
+		const std::string &ip,
+		int port) {
+	QWriteLocker lock(&_endpointStatsLock);
+	auto &stats = _endpointStats[EndpointKey{ dcId, ip, port }];
+	stats.failures = std::min(stats.failures + 1, 0xFFFF);
+	stats.lastFailure = base::unixtime::now();
+}
+
+void DcOptions::notifyEndpointStatsChanged() {
+	_endpointStatsChanged.fire({});
+}
+
 rpl::producer<DcId> DcOptions::changed() const {
 	return _changed.events();
 }
@@ -601,6 +703,10 @@ rpl::producer<> DcOptions::cdnConfigChanged() const {
 	return _cdnConfigChanged.events();
 }
 
+rpl::producer<> DcOptions::endpointStatsChanged() const {
+	return _endpointStatsChanged.events();
+}
+
 std::vector<DcId> DcOptions::configEnumDcIds() const {
 	auto result = std::vector<DcId>();
 	{
@@ -59,6 +59,14 @@ public:
 
 	};
 
+	// Connection results for an endpoint, persisted with the options.
+	struct EndpointStats {
+		crl::time connectTime = 0; // Smoothed, zero if never connected.
+		int successes = 0;
+		int failures = 0; // Since the last success.
+		TimeId lastFailure = 0; // Unixtime of the last failure.
+	};
+
 	explicit DcOptions(Environment environment);
 	DcOptions(const DcOptions &other);
 	~DcOptions();
@@ -81,6 +89,7 @@ public:
 
 	[[nodiscard]] rpl::producer<DcId> changed() const;
 	[[nodiscard]] rpl::producer<> cdnConfigChanged() const;
+	[[nodiscard]] rpl::producer<> endpointStatsChanged() const;
 	void setFromList(const MTPVector<MTPDcOption> &options);
 	void addFromList(const MTPVector<MTPDcOption> &options);
 	void addFromOther(DcOptions &&options);
@@ -106,6 +115,21 @@ public:
 		bool throughProxy) const;
 	[[nodiscard]] DcType dcType(ShiftedDcId shiftedDcId) const;
 
+	[[nodiscard]] EndpointStats endpointStats(
+		DcId dcId,
+		const std::string &ip,
+		int port) const;
+	void endpointConnected(
+		DcId dcId,
+		const std::string &ip,
+		int port,
+		crl::time connectTime);
+	void endpointFailed(DcId dcId, const std::string &ip, int port);
+
+	// Stats are updated from the connection threads,
+	// the changes should be announced from the main thread.
+	void notifyEndpointStatsChanged();
+
 	void setCDNConfig(const MTPDcdnConfig &config);
 	[[nodiscard]] bool hasCDNKeysForDc(DcId dcId) const;
 	[[nodiscard]] details::RSAPublicKey getDcRSAKey(
@@ -141,6 +165,9 @@ private:
 	void computeCdnDcIds();
 
 	void readBuiltInPublicKeys();
+	void readEndpointStats(QDataStream &stream);
+
+	using EndpointKey = std::tuple<DcId, std::string, int>;
 
 	class WriteLocker;
 	friend class WriteLocker;
@@ -156,9 +183,12 @@ private:
 		DcId,
 		base::flat_map<uint64, details::RSAPublicKey>> _cdnPublicKeys;
 	mutable QReadWriteLock _useThroughLockers;
+	base::flat_map<EndpointKey, EndpointStats> _endpointStats;
+	mutable QReadWriteLock _endpointStatsLock;
 
 	rpl::event_stream<DcId> _changed;
 	rpl::event_stream<> _cdnConfigChanged;
+	rpl::event_stream<> _endpointStatsChanged;
 
 	// True when we have overriden options from a .tdesktop-endpoints file.
 	bool _immutable = false;
@@ -363,7 +363,7 @@ void Session::cancel(mtpRequestId requestId, mtpMsgId msgId) {
 	}
 	if (msgId) {
 		QWriteLocker locker(_data->haveSentMutex());
-		_data->haveSentMap().remove(msgId);
+		_data->haveSentMap().erase(msgId);
 	}
 }
 
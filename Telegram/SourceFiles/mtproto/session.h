@@ -29,6 +29,10 @@ class SessionPrivate;
 enum class TemporaryKeyType;
 enum class CreatingKeyType;
 
+// Requests stay in the sent map until acked, so with many requests in
+// flight the lookups on each received message should not degrade.
+using SentRequestsMap = std::unordered_map<mtpMsgId, SerializedRequest>;
+
 struct SessionOptions {
 	SessionOptions() = default;
 	SessionOptions(
@@ -81,7 +85,7 @@ public:
 	base::flat_map<mtpRequestId, SerializedRequest> &toSendMap() {
 		return _toSend;
 	}
-	base::flat_map<mtpMsgId, SerializedRequest> &haveSentMap() {
+	SentRequestsMap &haveSentMap() {
 		return _haveSent;
 	}
 	base::flat_map<mtpRequestId, mtpBuffer> &haveReceivedResponses() {
@@ -125,7 +129,7 @@ private:
 	base::flat_map<mtpRequestId, SerializedRequest> _toSend; // map of request_id -> request, that is waiting to be sent
 	QReadWriteLock _toSendLock;
 
-	base::flat_map<mtpMsgId, SerializedRequest> _haveSent; // map of msg_id -> request, that was sent
+	SentRequestsMap _haveSent; // map of msg_id -> request, that was sent
 	QReadWriteLock _haveSentLock;
 
 	base::flat_map<mtpRequestId, mtpBuffer> _receivedResponses; // map of request_id -> response that should be processed in the main thread
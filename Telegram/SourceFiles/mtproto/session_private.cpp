@@ -27,6 +27,18 @@ namespace {
 
 constexpr auto kIntSize = static_cast<int>(sizeof(mtpPrime));
 constexpr auto kWaitForBetterTimeout = crl::time(2000);
+
+// Endpoints that failed so many times in a row are tested only if all
+// the others failed as well, and we don't wait for them to connect.
+// They are probed again after some time since their last failure.
+constexpr auto kUnreliableEndpointFailures = 3;
+constexpr auto kUnreliableEndpointRetry = TimeId(15 * 60);
+
+// The endpoint that connected fastest before is tried alone for twice
+// its usual connect time, only then the other endpoints are tested.
+constexpr auto kMinDelayOthersTimeout = crl::time(200);
+constexpr auto kMaxDelayOthersTimeout = crl::time(1000);
+
 constexpr auto kMinConnectedTimeout = crl::time(1000);
 constexpr auto kMaxConnectedTimeout = crl::time(8000);
 constexpr auto kMinReceiveTimeout = crl::time(4000);
@@ -84,7 +96,7 @@ using namespace details;
 void WrapInvokeAfter(
 		SerializedRequest &to,
 		const SerializedRequest &from,
-		const base::flat_map<mtpMsgId, SerializedRequest> &haveSent,
+		const SentRequestsMap &haveSent,
 		int32 skipBeforeRequest = 0) {
 	const auto afterId = *(mtpMsgId*)(from->after->data() + 4);
 	const auto i = afterId ? haveSent.find(afterId) : haveSent.end();
@@ -139,6 +151,7 @@ SessionPrivate::SessionPrivate(
 , _waitForConnectedTimer(thread, [=] { waitConnectedFailed(); })
 , _waitForReceivedTimer(thread, [=] { waitReceivedFailed(); })
 , _waitForBetterTimer(thread, [=] { waitBetterFailed(); })
+, _startDelayedTimer(thread, [=] { startDelayedTestConnections(); })
 , _waitForReceived(kMinReceiveTimeout)
 , _waitForConnected(kMinConnectedTimeout)
 , _pingSender(thread, [=] { sendPingByTimer(); })
@@ -166,20 +179,26 @@ void SessionPrivate::appendTestConnection(
 		DcOptions::Variants::Protocol protocol,
 		const QString &ip,
 		int port,
-		const bytes::vector &protocolSecret) {
+		const bytes::vector &protocolSecret,
+		bool unreliable,
+		bool delayed) {
 	QWriteLocker lock(&_stateMutex);
 
 	const auto priority = (qthelp::is_ipv6(ip) ? 0 : 1)
 		+ (protocol == DcOptions::Variants::Tcp ? 1 : 0)
 		+ (protocolSecret.empty() ? 0 : 1);
 	_testConnections.push_back({
-		AbstractConnection::Create(
+		.data = AbstractConnection::Create(
 			_instance,
 			protocol,
 			thread(),
 			protocolSecret,
 			_options->proxy),
-		priority
+		.priority = priority,
+		.ip = ip.toStdString(),
+		.port = port,
+		.secret = protocolSecret,
+		.unreliable = unreliable,
 	});
 	const auto weak = _testConnections.back().data.get();
 	connect(weak, &AbstractConnection::error, [=](int errorCode) {
@@ -206,12 +225,51 @@ void SessionPrivate::appendTestConnection(
 		});
 	});
 
+	if (!delayed) {
+		startTestConnection(_testConnections.back());
+	}
+}
+
+void SessionPrivate::startTestConnection(TestConnection &test) {
+	Expects(!test.started);
+
+	test.started = crl::now();
+
+	const auto weak = test.data.get();
+	const auto ip = QString::fromStdString(test.ip);
+	const auto port = test.port;
+	const auto secret = test.secret;
 	const auto protocolDcId = getProtocolDcId();
-	InvokeQueued(_testConnections.back().data, [=] {
-		weak->connectToServer(ip, port, protocolSecret, protocolDcId);
+	InvokeQueued(weak, [=] {
+		weak->connectToServer(ip, port, secret, protocolDcId);
 	});
 }
 
+void SessionPrivate::startDelayedTestConnections() {
+	_startDelayedTimer.cancel();
+
+	auto started = false;
+	for (auto &test : _testConnections) {
+		if (!test.started) {
+			startTestConnection(test);
+			started = true;
+		}
+	}
+	if (started && _waitForConnectedTimer.isActive()) {
+		_waitForConnectedTimer.callOnce(_waitForConnected);
+	}
+}
+
+void SessionPrivate::startDelayedIfAllFailed() {
+	const auto started = [](const TestConnection &test) {
+		return (test.started != 0);
+	};
+	if (!ranges::any_of(_testConnections, started)) {
+		DEBUG_LOG(("MTP Info: best endpoint failed, testing the others."));
+		startDelayedTestConnections();
+	}
+}
+
 int16 SessionPrivate::getProtocolDcId() const {
 	const auto dcId = BareDcId(_shiftedDcId);
 	const auto simpleDcId = isTemporaryDcId(dcId)
@@ -289,6 +347,7 @@ void SessionPrivate::destroyAllConnections() {
 	_waitForBetterTimer.cancel();
 	_waitForReceivedTimer.cancel();
 	_waitForConnectedTimer.cancel();
+	_startDelayedTimer.cancel();
 	_testConnections.clear();
 	_connection = nullptr;
 }
@@ -990,6 +1049,12 @@ void SessionPrivate::connectToServer(bool afterConfig) {
 			: !useHttp
 			? Variants::Http
 			: Variants::ProtocolCount;
+		struct Candidate {
+			Variants::Protocol protocol = Variants::Protocol();
+			not_null<const DcOptions::Endpoint*> endpoint;
+			DcOptions::EndpointStats stats;
+		};
+		auto candidates = std::vector<Candidate>();
 		for (auto address = 0; address != Variants::AddressTypeCount; ++address) {
 			if (address == skipAddress) {
 				continue;
@@ -999,14 +1064,66 @@ void SessionPrivate::connectToServer(bool afterConfig) {
 					continue;
 				}
 				for (const auto &endpoint : variants.data[address][protocol]) {
-					appendTestConnection(
-						static_cast<Variants::Protocol>(protocol),
-						QString::fromStdString(endpoint.ip),
-						endpoint.port,
-						endpoint.secret);
+					const auto stats = _instance->dcOptions().endpointStats(
+						bareDc,
+						endpoint.ip,
+						endpoint.port);
+					candidates.push_back({
+						.protocol = static_cast<Variants::Protocol>(protocol),
+						.endpoint = &endpoint,
+						.stats = stats,
+					});
 				}
 			}
 		}
+
+		// Start from the endpoints that connected fastest before,
+		// don't try the ones that keep failing, if there are others.
+		const auto now = base::unixtime::now();
+		const auto unreliable = [&](const Candidate &candidate) {
+			return (candidate.stats.failures
+				>= kUnreliableEndpointFailures)
+				&& (now - candidate.stats.lastFailure
+					< kUnreliableEndpointRetry);
+		};
+		const auto allUnreliable = ranges::all_of(candidates, unreliable);
+		ranges::stable_sort(candidates, std::less<>(), [](
+				const Candidate &candidate) {
+			const auto time = candidate.stats.connectTime;
+			return std::make_pair(
+				candidate.stats.failures,
+				time ? time : std::numeric_limits<crl::time>::max());
+		});
+		auto delayOthers = crl::time(0);
+		for (const auto &candidate : candidates) {
+			const auto bad = unreliable(candidate);
+			if (bad && !allUnreliable) {
+				DEBUG_LOG(("MTP Info: "
+					"skipping %1:%2 after %3 failures in a row."
+					).arg(QString::fromStdString(candidate.endpoint->ip)
+					).arg(candidate.endpoint->port
+					).arg(candidate.stats.failures));
+				continue;
+			}
+			const auto first = _testConnections.empty();
+			appendTestConnection(
+				candidate.protocol,
+				QString::fromStdString(candidate.endpoint->ip),
+				candidate.endpoint->port,
+				candidate.endpoint->secret,
+				bad,
+				(delayOthers > 0));
+			const auto &stats = candidate.stats;
+			if (first && stats.connectTime && !stats.failures) {
+				delayOthers = std::clamp(
+					stats.connectTime * 2,
+					kMinDelayOthersTimeout,
+					kMaxDelayOthersTimeout);
+			}
+		}
+		if (delayOthers > 0 && _testConnections.size() > 1) {
+			_startDelayedTimer.callOnce(delayOthers);
+		}
 	}
 	if (_testConnections.empty()) {
 		if (_instance->isKeysDestroyer()) {
@@ -1187,11 +1304,35 @@ void SessionPrivate::waitBetterFailed() {
 
 void SessionPrivate::connectingTimedOut() {
 	for (const auto &connection : _testConnections) {
+		if (!connection.started) {
+			continue;
+		}
 		connection.data->timedOut();
+		testConnectionFailed(connection);
 	}
 	doDisconnect();
 }
 
+void SessionPrivate::testConnectionFailed(const TestConnection &test) {
+	if (test.ip.empty()) {
+		// Connection through MTProto proxy.
+		return;
+	} else if (!test.started) {
+		return;
+	}
+	_instance->dcOptions().endpointFailed(
+		BareDcId(_shiftedDcId),
+		test.ip,
+		test.port);
+	endpointStatsChanged();
+}
+
+void SessionPrivate::endpointStatsChanged() {
+	InvokeQueued(_instance, [instance = _instance] {
+		instance->dcOptions().notifyEndpointStatsChanged();
+	});
+}
+
 void SessionPrivate::doDisconnect() {
 	destroyAllConnections();
 	setState(DisconnectedState);
@@ -1834,13 +1975,12 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 			const auto &haveSent = _sessionData->haveSentMap();
 			toResend.reserve(haveSent.size());
 			for (const auto &[msgId, request] : haveSent) {
-				if (msgId >= firstMsgId) {
-					break;
-				} else if (request->requestId) {
+				if (msgId < firstMsgId && request->requestId) {
 					toResend.push_back(msgId);
 				}
 			}
 		}
+		ranges::sort(toResend);
 		for (const auto msgId : toResend) {
 			resend(msgId, 10, true);
 		}
@@ -2240,21 +2380,43 @@ void SessionPrivate::onConnected(
 	_waitForConnected = kMinConnectedTimeout;
 	_waitForConnectedTimer.cancel();
 
+	// The endpoints kept in reserve are not needed anymore.
+	_startDelayedTimer.cancel();
+	_testConnections.erase(
+		ranges::remove(_testConnections, 0, &TestConnection::started),
+		end(_testConnections));
+
 	const auto i = ranges::find(
 		_testConnections,
 		connection.get(),
 		[](const TestConnection &test) { return test.data.get(); });
 	Assert(i != end(_testConnections));
+	const auto connectTime = crl::now() - i->started;
+	if (!i->ip.empty()) {
+		_instance->dcOptions().endpointConnected(
+			BareDcId(_shiftedDcId),
+			i->ip,
+			i->port,
+			connectTime);
+		endpointStatsChanged();
+	}
 	const auto my = i->priority;
 	const auto j = ranges::find_if(
 		_testConnections,
-		[&](const TestConnection &test) { return test.priority > my; });
+		[&](const TestConnection &test) {
+			return (test.priority > my) && !test.unreliable;
+		});
 	if (j != end(_testConnections)) {
 		DEBUG_LOG(("MTP Info: connection %1 succeed, "
 			"waiting for %2.").arg(i->data->tag()).arg(j->data->tag()));
 		_waitForBetterTimer.callOnce(kWaitForBetterTimeout);
 	} else {
-		DEBUG_LOG(("MTP Info: connection through IPv4 succeed."));
+		const auto better = ranges::any_of(
+			_testConnections,
+			[&](const TestConnection &test) { return test.priority > my; });
+		logChosenConnection(*i, better
+			? "better endpoints keep failing"
+			: "best endpoint available");
 		_waitForBetterTimer.cancel();
 		_connection = std::move(i->data);
 		_testConnections.clear();
@@ -2270,6 +2432,7 @@ void SessionPrivate::onDisconnected(
 		destroyAllConnections();
 		restart();
 	} else {
+		startDelayedIfAllFailed();
 		confirmBestConnection();
 	}
 }
@@ -2289,8 +2452,13 @@ void SessionPrivate::confirmBestConnection() {
 		return;
 	}
 
-	DEBUG_LOG(("MTP Info: can't connect through better, using %1."
-		).arg(i->data->tag()));
+	// Better endpoints didn't connect in time, remember that.
+	for (const auto &test : _testConnections) {
+		if (test.priority > i->priority && !test.data->isConnected()) {
+			testConnectionFailed(test);
+		}
+	}
+	logChosenConnection(*i, "better endpoints didn't connect in time");
 
 	_connection = std::move(i->data);
 	_testConnections.clear();
@@ -2298,8 +2466,27 @@ void SessionPrivate::confirmBestConnection() {
 	checkAuthKey();
 }
 
+void SessionPrivate::logChosenConnection(
+		const TestConnection &test,
+		const char *reason) const {
+	LOG(("MTP Info: DC %1 connected through %2 in %3 ms "
+		"(%4 ms since started connecting), reason: %5."
+		).arg(_shiftedDcId
+		).arg(test.data->tag()
+		).arg(crl::now() - test.started
+		).arg(_startedConnectingAt ? (crl::now() - _startedConnectingAt) : 0
+		).arg(reason));
+}
+
 void SessionPrivate::removeTestConnection(
 		not_null<AbstractConnection*> connection) {
+	const auto i = ranges::find(
+		_testConnections,
+		connection.get(),
+		[](const TestConnection &test) { return test.data.get(); });
+	if (i != end(_testConnections)) {
+		testConnectionFailed(*i);
+	}
 	_testConnections.erase(
 		ranges::remove(
 			_testConnections,
@@ -2535,6 +2722,7 @@ void SessionPrivate::onError(
 	if (_testConnections.empty()) {
 		handleError(errorCode);
 	} else {
+		startDelayedIfAllFailed();
 		confirmBestConnection();
 	}
 }
@@ -57,6 +57,11 @@ private:
 	struct TestConnection {
 		ConnectionPointer data;
 		int priority = 0;
+		std::string ip;
+		int port = 0;
+		bytes::vector secret;
+		crl::time started = 0; // Zero while delayed.
+		bool unreliable = false;
 	};
 	struct SentContainer {
 		crl::time sent = 0;
@@ -91,6 +96,7 @@ private:
 	void waitConnectedFailed();
 	void waitReceivedFailed();
 	void waitBetterFailed();
+	void startDelayedTestConnections();
 	void markConnectionOld();
 	void sendPingByTimer();
 	void destroyAllConnections();
@@ -134,7 +140,16 @@ private:
 		DcOptions::Variants::Protocol protocol,
 		const QString &ip,
 		int port,
-		const bytes::vector &protocolSecret);
+		const bytes::vector &protocolSecret,
+		bool unreliable = false,
+		bool delayed = false);
+	void startTestConnection(TestConnection &test);
+	void startDelayedIfAllFailed();
+	void testConnectionFailed(const TestConnection &test);
+	void endpointStatsChanged();
+	void logChosenConnection(
+		const TestConnection &test,
+		const char *reason) const;
 
 	// if badTime received - search for ids in sessionData->haveSent and sessionData->wereAcked and sync time/salt, return true if found
 	bool requestsFixTimeSalt(const QVector<MTPlong> &ids, int32 serverTime, uint64 serverSalt);
@@ -198,6 +213,7 @@ private:
 	base::Timer _waitForConnectedTimer;
 	base::Timer _waitForReceivedTimer;
 	base::Timer _waitForBetterTimer;
+	base::Timer _startDelayedTimer;
 	crl::time _waitForReceived = 0;
 	crl::time _waitForConnected = 0;
 	crl::time _firstSentAt = -1;
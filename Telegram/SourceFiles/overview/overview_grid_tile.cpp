@@ -0,0 +1,188 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "overview/overview_grid_tile.h"
+
+#include "data/data_session.h"
+#include "storage/cache/storage_cache_database.h"
+#include "ui/image/image_prepare.h"
+#include "app.h"
+
+#include <QtCore/QBuffer>
+
+namespace Overview::Layout {
+namespace {
+
+constexpr auto kFadeDuration = crl::time(200);
+constexpr auto kJpegQuality = 87;
+constexpr auto kSizeStep = 64;
+
+[[nodiscard]] int RoundSize(int size) {
+	return ((size + kSizeStep - 1) / kSizeStep) * kSizeStep;
+}
+
+[[nodiscard]] QImage PrepareTile(QImage original, int size, bool blurred) {
+	if (blurred) {
+		original = Images::prepareBlur(std::move(original));
+	}
+	const auto width = original.width();
+	const auto height = original.height();
+	if (width != height) {
+		const auto side = std::min(width, height);
+		original = original.copy(
+			(width - side) / 2,
+			(height - side) / 2,
+			side,
+			side);
+	}
+	if (original.width() != size) {
+		original = original.scaled(
+			size,
+			size,
+			Qt::IgnoreAspectRatio,
+			Qt::SmoothTransformation);
+	}
+	original.setDevicePixelRatio(cRetinaFactor());
+	return original;
+}
+
+[[nodiscard]] QByteArray SerializeTile(const QImage &image) {
+	auto result = QByteArray();
+	auto buffer = QBuffer(&result);
+	buffer.open(QIODevice::WriteOnly);
+	if (!image.save(&buffer, "JPG", kJpegQuality)) {
+		return QByteArray();
+	}
+	return result;
+}
+
+} // namespace
+
+GridTile::GridTile(
+	not_null<Data::Session*> owner,
+	Fn<Storage::Cache::Key(int size)> cacheKey,
+	Fn<void()> repaint)
+: _owner(owner)
+, _cacheKey(std::move(cacheKey))
+, _repaint(std::move(repaint)) {
+}
+
+bool GridTile::goodRequested(int size) {
+	size = RoundSize(size);
+	if ((_size == size && _quality == Quality::Good)
+		|| _requestedSize == size) {
+		return true;
+	} else if (_checkedSize != size) {
+		lookup(size);
+		return true;
+	}
+	return false;
+}
+
+bool GridTile::hasImage() const {
+	return (_quality != Quality::None);
+}
+
+void GridTile::lookup(int size) {
+	_requestedSize = size;
+	const auto weak = base::make_weak(this);
+	_owner->cache().get(_cacheKey(size), [=](QByteArray &&value) {
+		auto image = value.isEmpty()
+			? QImage()
+			: App::readImage(value, nullptr, false);
+		if (image.width() != size || image.height() != size) {
+			image = QImage();
+		} else {
+			image.setDevicePixelRatio(cRetinaFactor());
+		}
+		crl::on_main(weak, [=, image = std::move(image)]() mutable {
+			if (_requestedSize != size) {
+				return;
+			}
+			_requestedSize = 0;
+			if (image.isNull()) {
+				_checkedSize = size;
+				_repaint();
+			} else {
+				ready(std::move(image), size, Quality::Good);
+			}
+		});
+	});
+}
+
+void GridTile::prepareGood(QImage original, int size) {
+	Expects(!original.isNull());
+
+	size = RoundSize(size);
+	_requestedSize = size;
+	const auto weak = base::make_weak(this);
+	crl::async([=, original = std::move(original)]() mutable {
+		auto image = PrepareTile(std::move(original), size, false);
+		auto bytes = SerializeTile(image);
+		crl::on_main(weak, [
+			=,
+			image = std::move(image),
+			bytes = std::move(bytes)
+		]() mutable {
+			if (!bytes.isEmpty()) {
+				_owner->cache().put(
+					_cacheKey(size),
+					Storage::Cache::Database::TaggedValue(
+						std::move(bytes),
+						Data::kImageCacheTag));
+			}
+			if (_requestedSize == size) {
+				_requestedSize = 0;
+				ready(std::move(image), size, Quality::Good);
+			}
+		});
+	});
+}
+
+void GridTile::prepareBlurred(QImage original, int size) {
+	Expects(!original.isNull());
+
+	size = RoundSize(size);
+	ready(
+		PrepareTile(std::move(original), size, true),
+		size,
+		Quality::Blurred);
+}
+
+void GridTile::ready(QImage image, int size, Quality quality) {
+	const auto fade = (quality == Quality::Good)
+		&& (_quality != Quality::Good || _size != size);
+	_previous = fade ? base::take(_pix) : QPixmap();
+	_pix = App::pixmapFromImageInPlace(std::move(image));
+	_size = size;
+	_quality = quality;
+	if (fade) {
+		_fade.stop();
+		_fade.start(_repaint, 0., 1., kFadeDuration);
+	}
+	_repaint();
+}
+
+void GridTile::paint(Painter &p, QRect rect, const style::color &bg) {
+	const auto opacity = _fade.value(1.);
+	if (opacity == 1.) {
+		_previous = QPixmap();
+	}
+	PainterHighQualityEnabler hq(p);
+	if (!_previous.isNull()) {
+		p.drawPixmap(rect, _previous);
+	} else if (_pix.isNull() || opacity < 1.) {
+		p.fillRect(rect, bg);
+	}
+	if (!_pix.isNull()) {
+		p.setOpacity(opacity);
+		p.drawPixmap(rect, _pix);
+		p.setOpacity(1.);
+	}
+}
+
+} // namespace Overview::Layout
@@ -0,0 +1,78 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+#include "ui/effects/animations.h"
+
+namespace Data {
+class Session;
+} // namespace Data
+
+namespace Storage::Cache {
+struct Key;
+} // namespace Storage::Cache
+
+namespace Overview::Layout {
+
+// Square picture of a photo or a video in the shared media grid.
+//
+// Good tiles are cropped and scaled on a background thread and then put
+// to the cache database, so next time they're read at the tile size
+// without loading and scaling the whole thumbnail. Blurred tiles are
+// made from tiny images and are prepared right away.
+//
+// Tiles are prepared for a few sizes only, the requested size is rounded
+// up and the tile is scaled down when painted. So resizing the window
+// doesn't put a new tile to the cache for each width.
+class GridTile final : public base::has_weak_ptr {
+public:
+	GridTile(
+		not_null<Data::Session*> owner,
+		Fn<Storage::Cache::Key(int size)> cacheKey,
+		Fn<void()> repaint);
+
+	// Returns false if a good tile of this size is not ready,
+	// not being prepared and not found in the cache, so the caller
+	// should provide the original with prepareGood().
+	[[nodiscard]] bool goodRequested(int size);
+
+	// Any tile is shown until a good one of the requested size is ready.
+	[[nodiscard]] bool hasImage() const;
+
+	void prepareGood(QImage original, int size);
+	void prepareBlurred(QImage original, int size);
+
+	void paint(Painter &p, QRect rect, const style::color &bg);
+
+private:
+	enum class Quality : uchar {
+		None,
+		Blurred,
+		Good,
+	};
+
+	void lookup(int size);
+	void ready(QImage image, int size, Quality quality);
+
+	const not_null<Data::Session*> _owner;
+	const Fn<Storage::Cache::Key(int size)> _cacheKey;
+	const Fn<void()> _repaint;
+
+	QPixmap _pix;
+	QPixmap _previous;
+	Ui::Animations::Simple _fade;
+	int _size = 0;
+	Quality _quality = Quality::None;
+
+	int _requestedSize = 0; // Good tile being looked up or prepared.
+	int _checkedSize = 0; // Good tile of this size is not in the cache.
+
+};
+
+} // namespace Overview::Layout
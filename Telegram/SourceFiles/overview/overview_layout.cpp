@@ -301,7 +301,13 @@ Photo::Photo(
 	not_null<PhotoData*> photo)
 : ItemBase(delegate, parent)
 , _data(photo)
-, _link(std::make_shared<PhotoOpenClickHandler>(photo, parent->fullId())) {
+, _link(std::make_shared<PhotoOpenClickHandler>(photo, parent->fullId()))
+, _tile(
+	&photo->owner(),
+	[id = photo->id](int size) {
+		return Data::PhotoTileCacheKey(id, size);
+	},
+	[=] { parent->history()->owner().requestItemRepaint(parent); }) {
 	if (_data->inlineThumbnailBytes().isEmpty()
 		&& (_data->hasExact(Data::PhotoSize::Small)
 			|| _data->hasExact(Data::PhotoSize::Thumbnail))) {
@@ -325,32 +331,33 @@ int32 Photo::resizeGetHeight(int32 width) {
 
 void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const PaintContext *context) {
 	const auto selected = (selection == FullSelection);
-	const auto widthChanged = _pix.width() != _width * cIntRetinaFactor();
-	if (!_goodLoaded || widthChanged) {
+	const auto size = _width * cIntRetinaFactor();
+	if (!_tile.hasImage()) {
 		ensureDataMediaCreated();
-		const auto good = _dataMedia->loaded()
-			|| (_dataMedia->image(Data::PhotoSize::Thumbnail) != nullptr);
-		if ((good && !_goodLoaded) || widthChanged) {
-			_goodLoaded = good;
-			_pix = QPixmap();
-			if (_goodLoaded) {
-				setPixFrom(_dataMedia->image(Data::PhotoSize::Large)
-					? _dataMedia->image(Data::PhotoSize::Large)
-					: _dataMedia->image(Data::PhotoSize::Thumbnail));
-			} else if (const auto small = _dataMedia->image(
-					Data::PhotoSize::Small)) {
-				setPixFrom(small);
-			} else if (const auto blurred = _dataMedia->thumbnailInline()) {
-				setPixFrom(blurred);
-			}
+		if (const auto small = _dataMedia->image(Data::PhotoSize::Small)) {
+			_tile.prepareBlurred(small->original(), size);
+		} else if (const auto blurred = _dataMedia->thumbnailInline()) {
+			_tile.prepareBlurred(blurred->original(), size);
 		}
 	}
-
-	if (_pix.isNull()) {
-		p.fillRect(0, 0, _width, _height, st::overviewPhotoBg);
-	} else {
-		p.drawPixmap(0, 0, _pix);
+	if (!_tile.goodRequested(size)) {
+		ensureDataMediaCreated();
+		const auto good = _dataMedia->image(Data::PhotoSize::Large)
+			? _dataMedia->image(Data::PhotoSize::Large)
+			: _dataMedia->image(Data::PhotoSize::Thumbnail);
+		if (good) {
+			_tile.prepareGood(good->original(), size);
+
+			// In case we have inline thumbnail we can unload all images and
+			// we still won't get a blank image in the media viewer when the
+			// photo is opened.
+			if (!_data->inlineThumbnailBytes().isEmpty()) {
+				_dataMedia = nullptr;
+				delegate()->unregisterHeavyItem(this);
+			}
+		}
 	}
+	_tile.paint(p, QRect(0, 0, _width, _height), st::overviewPhotoBg);
 
 	if (selected) {
 		p.fillRect(0, 0, _width, _height, st::overviewPhotoSelectOverlay);
@@ -361,33 +368,6 @@ void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	paintCheckbox(p, { checkLeft, checkTop }, selected, context);
 }
 
-void Photo::setPixFrom(not_null<Image*> image) {
-	const auto size = _width * cIntRetinaFactor();
-	auto img = image->original();
-	if (!_goodLoaded) {
-		img = Images::prepareBlur(std::move(img));
-	}
-	if (img.width() == img.height()) {
-		if (img.width() != size) {
-			img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		}
-	} else if (img.width() > img.height()) {
-		img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-	} else {
-		img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-	}
-	img.setDevicePixelRatio(cRetinaFactor());
-
-	// In case we have inline thumbnail we can unload all images and we still
-	// won't get a blank image in the media viewer when the photo is opened.
-	if (!_data->inlineThumbnailBytes().isEmpty()) {
-		_dataMedia = nullptr;
-		delegate()->unregisterHeavyItem(this);
-	}
-
-	_pix = App::pixmapFromImageInPlace(std::move(img));
-}
-
 void Photo::ensureDataMediaCreated() const {
 	if (_dataMedia) {
 		return;
@@ -419,7 +399,13 @@ Video::Video(
 	not_null<DocumentData*> video)
 : RadialProgressItem(delegate, parent)
 , _data(video)
-, _duration(Ui::FormatDurationText(_data->getDuration())) {
+, _duration(Ui::FormatDurationText(_data->getDuration()))
+, _tile(
+	&video->owner(),
+	[id = video->id](int size) {
+		return Data::DocumentTileCacheKey(id, size);
+	},
+	[=] { parent->history()->owner().requestItemRepaint(parent); }) {
 	setDocumentLinks(_data);
 	_data->loadThumbnail(parent->fullId());
 }
@@ -456,35 +442,14 @@ void Video::paint(Painter &p, const QRect &clip, TextSelection selection, const
 	const auto radial = isRadialAnimation();
 	const auto radialOpacity = radial ? _radial->opacity() : 0.;
 
-	if ((blurred || thumbnail || good)
-		&& ((_pix.width() != _width * cIntRetinaFactor())
-			|| (_pixBlurred && (thumbnail || good)))) {
-		auto size = _width * cIntRetinaFactor();
-		auto img = good
-			? good->original()
-			: thumbnail
-			? thumbnail->original()
-			: Images::prepareBlur(blurred->original());
-		if (img.width() == img.height()) {
-			if (img.width() != size) {
-				img = img.scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-			}
-		} else if (img.width() > img.height()) {
-			img = img.copy((img.width() - img.height()) / 2, 0, img.height(), img.height()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		} else {
-			img = img.copy(0, (img.height() - img.width()) / 2, img.width(), img.width()).scaled(size, size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-		}
-		img.setDevicePixelRatio(cRetinaFactor());
-
-		_pix = App::pixmapFromImageInPlace(std::move(img));
-		_pixBlurred = !(thumbnail || good);
+	const auto size = _width * cIntRetinaFactor();
+	if (blurred && !_tile.hasImage()) {
+		_tile.prepareBlurred(blurred->original(), size);
 	}
-
-	if (_pix.isNull()) {
-		p.fillRect(0, 0, _width, _height, st::overviewPhotoBg);
-	} else {
-		p.drawPixmap(0, 0, _pix);
+	if (!_tile.goodRequested(size) && (good || thumbnail)) {
+		_tile.prepareGood((good ? good : thumbnail)->original(), size);
 	}
+	_tile.paint(p, QRect(0, 0, _width, _height), st::overviewPhotoBg);
 
 	if (selected) {
 		p.fillRect(QRect(0, 0, _width, _height), st::overviewPhotoSelectOverlay);
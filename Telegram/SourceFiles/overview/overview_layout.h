@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "layout.h"
+#include "overview/overview_grid_tile.h"
 #include "core/click_handler_types.h"
 #include "ui/effects/animations.h"
 #include "ui/effects/radial_animation.h"
@@ -191,14 +192,12 @@ public:
 
 private:
 	void ensureDataMediaCreated() const;
-	void setPixFrom(not_null<Image*> image);
 
 	const not_null<PhotoData*> _data;
 	mutable std::shared_ptr<Data::PhotoMedia> _dataMedia;
 	ClickHandlerPtr _link;
 
-	QPixmap _pix;
-	bool _goodLoaded = false;
+	GridTile _tile;
 
 };
 
@@ -234,8 +233,7 @@ private:
 	StatusText _status;
 
 	QString _duration;
-	QPixmap _pix;
-	bool _pixBlurred = true;
+	GridTile _tile;
 
 };
 
@@ -364,35 +364,122 @@ bytes::vector DecryptData(
 		bytes::const_span encrypted,
 		bytes::const_span dataHash,
 		bytes::const_span dataSecret) {
-	constexpr auto kDataHashSize = 32;
 	if (encrypted.empty()) {
 		return {};
-	} else if (dataHash.size() != kDataHashSize) {
+	}
+	auto decryptor = DataDecryptor(dataHash, dataSecret, encrypted.size());
+	decryptor.feed(encrypted);
+	return decryptor.finish();
+}
+
+struct DataDecryptor::Context {
+	AES_KEY key = AES_KEY();
+	bytes::vector iv;
+	SHA256_CTX sha256 = SHA256_CTX();
+};
+
+DataDecryptor::DataDecryptor(
+		bytes::const_span dataHash,
+		bytes::const_span dataSecret,
+		int expectedSize)
+: _context(std::make_unique<Context>())
+, _hash(bytes::make_vector(dataHash)) {
+	constexpr auto kDataHashSize = 32;
+	if (dataHash.size() != kDataHashSize) {
 		LOG(("API Error: Bad data hash size %1").arg(dataHash.size()));
-		return {};
+		_failed = true;
+		return;
 	} else if (dataSecret.size() != kSecretSize) {
 		LOG(("API Error: Bad data secret size %1").arg(dataSecret.size()));
-		return {};
+		_failed = true;
+		return;
 	}
 
 	const auto bytesForEncryptionKey = bytes::concatenate(
 		dataSecret,
 		dataHash);
 	auto params = PrepareAesParams(bytesForEncryptionKey);
-	const auto decrypted = Decrypt(encrypted, std::move(params));
-	if (bytes::compare(openssl::Sha256(decrypted), dataHash) != 0) {
+	const auto error = AES_set_decrypt_key(
+		reinterpret_cast<const uchar*>(params.key.data()),
+		params.key.size() * CHAR_BIT,
+		&_context->key);
+	if (error != 0) {
+		LOG(("App Error: Could not AES_set_decrypt_key, result %1"
+			).arg(error));
+		_failed = true;
+		return;
+	}
+	_context->iv = std::move(params.iv);
+	SHA256_Init(&_context->sha256);
+	_decrypted.reserve(expectedSize);
+}
+
+DataDecryptor::~DataDecryptor() = default;
+
+void DataDecryptor::feed(bytes::const_span encrypted) {
+	if (_failed || encrypted.empty()) {
+		return;
+	}
+	if (!_tail.empty()) {
+		const auto add = std::min(
+			kAlignTo - int(_tail.size()),
+			int(encrypted.size()));
+		_tail.insert(
+			end(_tail),
+			encrypted.begin(),
+			encrypted.begin() + add);
+		encrypted = encrypted.subspan(add);
+		if (_tail.size() < kAlignTo) {
+			return;
+		}
+		decrypt(base::take(_tail));
+	}
+	const auto aligned = encrypted.size() & ~std::size_t(kAlignTo - 1);
+	decrypt(encrypted.subspan(0, aligned));
+	_tail = bytes::make_vector(encrypted.subspan(aligned));
+}
+
+void DataDecryptor::decrypt(bytes::const_span encrypted) {
+	Expects((encrypted.size() % kAlignTo) == 0);
+
+	if (encrypted.empty()) {
+		return;
+	}
+	const auto offset = _decrypted.size();
+	_decrypted.resize(offset + encrypted.size());
+	const auto decrypted = _decrypted.data() + offset;
+	AES_cbc_encrypt(
+		reinterpret_cast<const uchar*>(encrypted.data()),
+		reinterpret_cast<uchar*>(decrypted),
+		encrypted.size(),
+		&_context->key,
+		reinterpret_cast<uchar*>(_context->iv.data()),
+		AES_DECRYPT);
+	SHA256_Update(&_context->sha256, decrypted, encrypted.size());
+}
+
+bytes::vector DataDecryptor::finish() {
+	if (_failed || _decrypted.empty()) {
+		return {};
+	} else if (!_tail.empty()) {
+		LOG(("API Error: Bad encrypted data size."));
+		return {};
+	}
+	auto hash = bytes::vector(SHA256_DIGEST_LENGTH);
+	SHA256_Final(reinterpret_cast<uchar*>(hash.data()), &_context->sha256);
+	if (bytes::compare(hash, _hash) != 0) {
 		LOG(("API Error: Bad data hash."));
 		return {};
 	}
-	const auto padding = static_cast<uint32>(decrypted[0]);
+	const auto padding = static_cast<uint32>(_decrypted[0]);
 	if (padding < kMinPadding
 		|| padding > kMaxPadding
-		|| padding > decrypted.size()) {
+		|| padding > _decrypted.size()) {
 		LOG(("API Error: Bad padding value %1").arg(padding));
 		return {};
 	}
-	const auto bytes = gsl::make_span(decrypted).subspan(padding);
-	return { bytes.begin(), bytes.end() };
+	_decrypted.erase(begin(_decrypted), begin(_decrypted) + padding);
+	return base::take(_decrypted);
 }
 
 bytes::vector PrepareValueHash(
@@ -49,6 +49,35 @@ bytes::vector DecryptData(
 	bytes::const_span dataHash,
 	bytes::const_span dataSecret);
 
+// Decrypts and verifies data encrypted by EncryptData() part by part,
+// so that a big file can be decrypted while it is being downloaded.
+class DataDecryptor final {
+public:
+	DataDecryptor(
+		bytes::const_span dataHash,
+		bytes::const_span dataSecret,
+		int expectedSize = 0);
+	~DataDecryptor();
+
+	// Parts of any size must be passed one by one.
+	void feed(bytes::const_span encrypted);
+
+	// Returns an empty vector if the data is damaged.
+	[[nodiscard]] bytes::vector finish();
+
+private:
+	struct Context;
+
+	void decrypt(bytes::const_span encrypted);
+
+	std::unique_ptr<Context> _context;
+	bytes::vector _hash;
+	bytes::vector _tail;
+	bytes::vector _decrypted;
+	bool _failed = false;
+
+};
+
 bytes::vector PrepareValueHash(
 	bytes::const_span dataHash,
 	bytes::const_span valueSecret);
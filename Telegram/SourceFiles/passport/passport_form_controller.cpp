@@ -1737,29 +1737,35 @@ void FormController::loadFile(File &file) {
 		return;
 	}
 	file.downloadOffset = 0;
-	const auto [j, ok] = _fileLoaders.emplace(
-		key,
-		std::make_unique<mtpFileLoader>(
-			&_controller->session(),
-			StorageFileLocation(
-				file.dcId,
-				session().userId(),
-				MTP_inputSecureFileLocation(
-					MTP_long(file.id),
-					MTP_long(file.accessHash))),
-			Data::FileOrigin(),
-			SecureFileLocation,
-			QString(),
-			file.size,
-			file.size,
-			LoadToCacheAsWell,
-			LoadFromCloudOrLocal,
-			false,
-			Data::kImageCacheTag));
-	const auto loader = j->second.get();
+	const auto [j, ok] = _fileLoaders.emplace(key, FileLoading());
+	auto &loading = j->second;
+	loading.started = crl::now();
+	loading.loader = std::make_unique<mtpFileLoader>(
+		&_controller->session(),
+		StorageFileLocation(
+			file.dcId,
+			session().userId(),
+			MTP_inputSecureFileLocation(
+				MTP_long(file.id),
+				MTP_long(file.accessHash))),
+		Data::FileOrigin(),
+		SecureFileLocation,
+		QString(),
+		file.size,
+		file.size,
+		LoadToCacheAsWell,
+		LoadFromCloudOrLocal,
+		false,
+		Data::kImageCacheTag);
+	const auto loader = loading.loader.get();
 	loader->updates(
 	) | rpl::start_with_next_error_done([=] {
-		fileLoadProgress(key, loader->currentOffset());
+		const auto offset = loader->currentOffset();
+		if (offset == loader->bytes().size()) {
+			// No gaps between the loaded parts, decrypt them right away.
+			feedFileDecryptor(key, loader->bytes());
+		}
+		fileLoadProgress(key, offset);
 	}, [=](bool started) {
 		fileLoadFail(key);
 	}, [=] {
@@ -1768,20 +1774,69 @@ void FormController::loadFile(File &file) {
 	loader->start();
 }
 
-void FormController::fileLoadDone(FileKey key, const QByteArray &bytes) {
-	if (const auto [value, file] = findFile(key); file != nullptr) {
-		const auto decrypted = DecryptData(
-			bytes::make_span(bytes),
-			file->hash,
-			file->secret);
-		if (decrypted.empty()) {
-			fileLoadFail(key);
+void FormController::feedFileDecryptor(
+		FileKey key,
+		const QByteArray &bytes) {
+	const auto i = _fileLoaders.find(key);
+	if (i == end(_fileLoaders)) {
+		return;
+	}
+	auto &loading = i->second;
+	if (!loading.decryptor || bytes.size() < loading.decryptorOffset) {
+		const auto [value, file] = findFile(key);
+		if (!file) {
 			return;
 		}
+		loading.decryptor = std::make_unique<
+			crl::object_on_queue<DataDecryptor>
+		>(file->hash, file->secret, file->size);
+		loading.decryptorOffset = 0;
+	}
+	if (bytes.size() > loading.decryptorOffset) {
+		loading.decryptor->with([
+			part = bytes.mid(loading.decryptorOffset)
+		](DataDecryptor &decryptor) {
+			decryptor.feed(bytes::make_span(part));
+		});
+		loading.decryptorOffset = bytes.size();
+	}
+}
+
+void FormController::fileLoadDone(FileKey key, const QByteArray &bytes) {
+	feedFileDecryptor(key, bytes);
+	const auto i = _fileLoaders.find(key);
+	if (i == end(_fileLoaders) || !i->second.decryptor) {
+		fileLoadFail(key);
+		return;
+	}
+	const auto weak = base::make_weak(this);
+	i->second.decryptor->with([=](DataDecryptor &decryptor) {
+		const auto decrypted = decryptor.finish();
+		const auto good = !decrypted.empty();
+		auto image = good ? ReadImage(decrypted) : QImage();
+		crl::on_main(weak, [=, image = std::move(image)]() mutable {
+			fileDecrypted(key, std::move(image), good);
+		});
+	});
+}
+
+void FormController::fileDecrypted(
+		FileKey key,
+		QImage &&image,
+		bool decrypted) {
+	if (const auto i = _fileLoaders.find(key); i != end(_fileLoaders)) {
+		DEBUG_LOG(("Passport: scan %1 ready in %2 ms after the request."
+			).arg(key.id
+			).arg(crl::now() - i->second.started));
+		i->second.decryptor = nullptr;
+	}
+	if (!decrypted) {
+		fileLoadFail(key);
+		return;
+	}
+	if (const auto [value, file] = findFile(key); file != nullptr) {
 		file->downloadOffset = file->size;
-		file->image = App::readImage(QByteArray::fromRawData(
-			reinterpret_cast<const char*>(decrypted.data()),
-			decrypted.size()));
+		file->image = std::move(image);
 		if (const auto fileInEdit = findEditFile(key)) {
 			fileInEdit->fields.image = file->image;
 			fileInEdit->fields.downloadOffset = file->downloadOffset;
@@ -1801,6 +1856,9 @@ void FormController::fileLoadProgress(FileKey key, int offset) {
 }
 
 void FormController::fileLoadFail(FileKey key) {
+	if (const auto i = _fileLoaders.find(key); i != end(_fileLoaders)) {
+		i->second.decryptor = nullptr;
+	}
 	if (const auto [value, file] = findFile(key); file != nullptr) {
 		file->downloadOffset = -1;
 		if (const auto fileInEdit = findEditFile(key)) {
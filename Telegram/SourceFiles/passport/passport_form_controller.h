@@ -12,6 +12,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/weak_ptr.h"
 #include "core/core_cloud_password.h"
 
+#include <crl/crl_object_on_queue.h>
+
 class mtpFileLoader;
 
 namespace Storage {
@@ -29,6 +31,8 @@ class Session;
 
 namespace Passport {
 
+class DataDecryptor;
+
 struct Config {
 	int32 hash = 0;
 	std::map<QString, QString> languagesByCountryCode;
@@ -394,6 +398,12 @@ private:
 	using PasswordCheckCallback = Fn<void(
 		const Core::CloudPasswordResult &check)>;
 
+	struct FileLoading {
+		std::unique_ptr<mtpFileLoader> loader;
+		std::unique_ptr<crl::object_on_queue<DataDecryptor>> decryptor;
+		int decryptorOffset = 0;
+		crl::time started = 0;
+	};
 	struct FinalData {
 		QVector<MTPSecureValueHash> hashes;
 		QByteArray credentials;
@@ -465,6 +475,8 @@ private:
 	void fileLoadDone(FileKey key, const QByteArray &bytes);
 	void fileLoadProgress(FileKey key, int offset);
 	void fileLoadFail(FileKey key);
+	void fileDecrypted(FileKey key, QImage &&image, bool decrypted);
+	void feedFileDecryptor(FileKey key, const QByteArray &bytes);
 	void generateSecret(bytes::const_span password);
 	void saveSecret(
 		const Core::CloudPasswordResult &check,
@@ -540,7 +552,7 @@ private:
 	Form _form;
 	bool _cancelled = false;
 	mtpRequestId _recoverRequestId = 0;
-	base::flat_map<FileKey, std::unique_ptr<mtpFileLoader>> _fileLoaders;
+	base::flat_map<FileKey, FileLoading> _fileLoaders;
 
 	rpl::event_stream<not_null<const EditFile*>> _scanUpdated;
 	rpl::event_stream<not_null<const Value*>> _valueSaveFinished;
@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwidget.h"
 #include "mainwindow.h"
 #include "data/data_session.h"
+#include "data/data_histories.h"
 #include "main/main_session.h"
 #include "main/main_account.h"
 #include "main/main_domain.h"
@@ -73,6 +74,12 @@ auto GenerateCodes() {
 			window->session().updates().getDifference();
 		}
 	});
+	codes.emplace(qsl("memoryreport"), [](SessionController *window) {
+		if (window) {
+			window->session().data().histories().logMemoryReport();
+			Ui::Toast::Show(qsl("Histories memory report written to log."));
+		}
+	});
 	codes.emplace(qsl("loadcolors"), [](SessionController *window) {
 		FileDialog::GetOpenPath(Core::App().getFileDialogParent(), "Open palette file", "Palette (*.tdesktop-palette)", [](const FileDialog::OpenResult &result) {
 			if (!result.paths.isEmpty()) {
@@ -21,6 +21,9 @@ namespace {
 constexpr char TdfMagic[] = { 'T', 'D', 'F', '$' };
 constexpr auto TdfMagicLen = int(sizeof(TdfMagic));
 
+constexpr char TdlMagic[] = { 'T', 'D', 'L', '$' };
+constexpr auto TdlMagicLen = int(sizeof(TdlMagic));
+
 constexpr auto kStrongIterationsCount = 100'000;
 
 } // namespace
@@ -75,6 +78,8 @@ void ClearKey(const FileKey &key, const QString &basePath) {
 	QFile::remove(name);
 	name[name.size() - 1] = 's';
 	QFile::remove(name);
+	name[name.size() - 1] = 'l';
+	QFile::remove(name);
 }
 
 bool CheckStreamStatus(QDataStream &stream) {
@@ -94,6 +99,7 @@ MTP::AuthKeyPtr CreateLocalKey(
 		? 1 // Don't slow down for no password.
 		: kStrongIterationsCount;
 
+	const auto started = crl::now();
 	auto key = MTP::AuthKey::Data{ { gsl::byte{} } };
 	PKCS5_PBKDF2_HMAC(
 		reinterpret_cast<const char*>(hash.data()),
@@ -104,9 +110,26 @@ MTP::AuthKeyPtr CreateLocalKey(
 		EVP_sha512(),
 		key.size(),
 		reinterpret_cast<unsigned char*>(key.data()));
+	DEBUG_LOG(("App Info: Local key with %1 iterations derived in %2 ms."
+		).arg(iterationsCount
+		).arg(crl::now() - started));
 	return std::make_shared<MTP::AuthKey>(key);
 }
 
+void CreateLocalKeyAsync(
+		const QByteArray &passcode,
+		const QByteArray &salt,
+		FnMut<void(MTP::AuthKeyPtr)> done) {
+	crl::async([=, done = std::move(done)]() mutable {
+		crl::on_main([
+			done = std::move(done),
+			key = CreateLocalKey(passcode, salt)
+		]() mutable {
+			done(std::move(key));
+		});
+	});
+}
+
 MTP::AuthKeyPtr CreateLegacyLocalKey(
 		const QByteArray &passcode,
 		const QByteArray &salt) {
@@ -504,5 +527,81 @@ bool ReadEncryptedFile(
 	return ReadEncryptedFile(result, ToFilePart(fkey), basePath, key);
 }
 
+QString RecordsPath(const FileKey &fkey, const QString &basePath) {
+	return basePath + ToFilePart(fkey) + 'l';
+}
+
+int AppendEncryptedRecord(
+		const QString &path,
+		EncryptedDescriptor &data,
+		const MTP::AuthKeyPtr &key) {
+	const auto encrypted = PrepareEncrypted(data, key);
+
+	auto file = QFile(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		LOG(("Storage Error: Could not open '%1' for appending."
+			).arg(path));
+		return 0;
+	}
+	auto bytes = QByteArray();
+	{
+		auto buffer = QBuffer(&bytes);
+		buffer.open(QIODevice::WriteOnly);
+		auto stream = QDataStream(&buffer);
+		stream.setVersion(QDataStream::Qt_5_1);
+		if (!file.size()) {
+			stream.writeRawData(TdlMagic, TdlMagicLen);
+		}
+		stream << encrypted;
+	}
+	if (file.write(bytes) != bytes.size() || !file.flush()) {
+		LOG(("Storage Error: Could not append to '%1'.").arg(path));
+		return 0;
+	}
+	return bytes.size();
+}
+
+int64 ReadEncryptedRecords(
+		const QString &path,
+		const MTP::AuthKeyPtr &key,
+		Fn<void(EncryptedDescriptor &record)> callback) {
+	auto file = QFile(path);
+	if (!file.exists() || !file.open(QIODevice::ReadWrite)) {
+		return 0;
+	}
+	char magic[TdlMagicLen] = { 0 };
+	if (file.read(magic, TdlMagicLen) != TdlMagicLen
+		|| memcmp(magic, TdlMagic, TdlMagicLen)) {
+		LOG(("App Error: bad magic in records file '%1'.").arg(path));
+		file.close();
+		QFile::remove(path);
+		return 0;
+	}
+	auto stream = QDataStream(&file);
+	stream.setVersion(QDataStream::Qt_5_1);
+
+	auto good = file.pos();
+	while (!stream.atEnd()) {
+		auto encrypted = QByteArray();
+		stream >> encrypted;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("App Info: broken record in '%1' at %2, cutting off."
+				).arg(path
+				).arg(good));
+			break;
+		}
+		auto data = EncryptedDescriptor();
+		if (!DecryptLocal(data, encrypted, key)) {
+			break;
+		}
+		callback(data);
+		good = file.pos();
+	}
+	if (good != file.size()) {
+		file.resize(good);
+	}
+	return good;
+}
+
 } // namespace details
 } // namespace Storage
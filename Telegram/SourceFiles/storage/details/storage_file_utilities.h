@@ -23,6 +23,12 @@ void ClearKey(const FileKey &key, const QString &basePath);
 [[nodiscard]] MTP::AuthKeyPtr CreateLocalKey(
 	const QByteArray &passcode,
 	const QByteArray &salt);
+
+// Derives the key on a background thread and calls done() on main.
+void CreateLocalKeyAsync(
+	const QByteArray &passcode,
+	const QByteArray &salt,
+	FnMut<void(MTP::AuthKeyPtr)> done);
 [[nodiscard]] MTP::AuthKeyPtr CreateLegacyLocalKey(
 	const QByteArray &passcode,
 	const QByteArray &salt);
@@ -108,5 +114,24 @@ bool ReadEncryptedFile(
 	const QString &basePath,
 	const MTP::AuthKeyPtr &key);
 
+// Records file lives next to the usual key file and holds encrypted
+// records, each appended separately. A broken record at the end, left
+// by a crash while appending, is cut off when the records are read.
+[[nodiscard]] QString RecordsPath(
+	const FileKey &fkey,
+	const QString &basePath);
+
+// Returns the amount of bytes written or zero on failure.
+[[nodiscard]] int AppendEncryptedRecord(
+	const QString &path,
+	EncryptedDescriptor &data,
+	const MTP::AuthKeyPtr &key);
+
+// Returns the size of the file after the good records.
+int64 ReadEncryptedRecords(
+	const QString &path,
+	const MTP::AuthKeyPtr &key,
+	Fn<void(EncryptedDescriptor &record)> callback);
+
 } // namespace details
 } // namespace Storage
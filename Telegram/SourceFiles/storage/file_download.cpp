@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_account.h"
 #include "storage/file_download_mtproto.h"
 #include "storage/file_download_web.h"
+#include "storage/file_download_writer.h"
 #include "platform/platform_file_utilities.h"
 #include "main/main_session.h"
 #include "apiwrap.h"
@@ -254,11 +255,14 @@ void FileLoader::start() {
 bool FileLoader::checkForOpen() {
 	if (_filename.isEmpty()
 		|| (_toCache != LoadToFileOnly)
-		|| _fileIsOpen) {
+		|| _writer) {
 		return true;
 	}
-	_fileIsOpen = _file.open(QIODevice::WriteOnly);
-	if (_fileIsOpen) {
+	_writer = Storage::DownloadFileWriter::Open(
+		_filename,
+		_fullSize,
+		crl::guard(this, [=] { cancel(true); }));
+	if (_writer) {
 		return true;
 	}
 	cancel(true);
@@ -348,6 +352,9 @@ void FileLoader::cancel(bool fail) {
 		_fileIsOpen = false;
 		_file.remove();
 	}
+	if (const auto writer = base::take(_writer)) {
+		writer->remove();
+	}
 	_data = QByteArray();
 
 	const auto weak = base::make_weak(this);
@@ -363,7 +370,12 @@ void FileLoader::cancel(bool fail) {
 }
 
 int FileLoader::currentOffset() const {
-	return (_fileIsOpen ? _file.size() : _data.size()) - _skippedBytes;
+	const auto size = _writer
+		? _writer->size()
+		: _fileIsOpen
+		? _file.size()
+		: _data.size();
+	return size - _skippedBytes;
 }
 
 bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
@@ -372,21 +384,20 @@ bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
 	if (buffer.empty()) {
 		return true;
 	}
-	if (_fileIsOpen) {
-		auto fsize = _file.size();
+	if (_writer) {
+		const auto fsize = _writer->size();
 		if (offset < fsize) {
 			_skippedBytes -= buffer.size();
 		} else if (offset > fsize) {
 			_skippedBytes += offset - fsize;
 		}
-		_file.seek(offset);
-		if (_file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size()) != qint64(buffer.size())) {
-			cancel(true);
-			return false;
-		}
+		_writer->write(offset, buffer);
 		return true;
 	}
-	_data.reserve(offset + buffer.size());
+	if (_data.capacity() < offset + int(buffer.size())) {
+		// Reserve the whole file at once instead of growing for each part.
+		_data.reserve(std::max(offset + int(buffer.size()), _fullSize));
+	}
 	if (offset > _data.size()) {
 		_skippedBytes += offset - _data.size();
 		_data.resize(offset);
@@ -409,19 +420,8 @@ bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
 QByteArray FileLoader::readLoadedPartBack(int offset, int size) {
 	Expects(offset >= 0 && size > 0);
 
-	if (_fileIsOpen) {
-		if (_file.openMode() == QIODevice::WriteOnly) {
-			_file.close();
-			_fileIsOpen = _file.open(QIODevice::ReadWrite);
-			if (!_fileIsOpen) {
-				cancel(true);
-				return QByteArray();
-			}
-		}
-		if (!_file.seek(offset)) {
-			return QByteArray();
-		}
-		auto result = _file.read(size);
+	if (_writer) {
+		auto result = _writer->read(offset, size);
 		return (result.size() == size) ? result : QByteArray();
 	}
 	return (offset + size <= _data.size())
@@ -444,12 +444,32 @@ bool FileLoader::finalizeResult() {
 	}
 
 	_finished = true;
-	if (_fileIsOpen) {
+	if (_writer) {
+		_writer->finish(crl::guard(this, [=](bool success) {
+			if (_cancelled) {
+				// cancel() already removed the file and notified everyone.
+				return;
+			} else if (!success) {
+				cancel(true);
+				return;
+			}
+			_writer = nullptr;
+			Platform::File::PostprocessDownloaded(
+				QFileInfo(_filename).absoluteFilePath());
+			finalizeWritten();
+		}));
+		return true;
+	} else if (_fileIsOpen) {
 		_file.close();
 		_fileIsOpen = false;
 		Platform::File::PostprocessDownloaded(
 			QFileInfo(_file).absoluteFilePath());
 	}
+	finalizeWritten();
+	return true;
+}
+
+void FileLoader::finalizeWritten() {
 	if (_localStatus == LocalStatus::NotFound) {
 		if (const auto key = fileLocationKey()) {
 			if (!_filename.isEmpty()) {
@@ -474,7 +494,6 @@ bool FileLoader::finalizeResult() {
 	const auto session = _session;
 	_updates.fire_done();
 	session->notifyDownloaderTaskFinished();
-	return true;
 }
 
 std::unique_ptr<FileLoader> CreateFileLoader(
@@ -27,6 +27,8 @@ namespace Cache {
 struct Key;
 } // namespace Cache
 
+class DownloadFileWriter;
+
 // 10 MB max file could be hold in memory
 // This value is used in local cache database settings!
 constexpr auto kMaxFileInMemory = 10 * 1024 * 1024;
@@ -150,6 +152,7 @@ protected:
 
 	bool writeResultPart(int offset, bytes::const_span buffer);
 	bool finalizeResult();
+	void finalizeWritten();
 	[[nodiscard]] QByteArray readLoadedPartBack(int offset, int size);
 
 	const not_null<Main::Session*> _session;
@@ -163,6 +166,7 @@ protected:
 	QString _filename;
 	QFile _file;
 	bool _fileIsOpen = false;
+	std::unique_ptr<Storage::DownloadFileWriter> _writer;
 
 	LoadToCacheSetting _toCache;
 	LoadFromCloudSetting _fromCloud;
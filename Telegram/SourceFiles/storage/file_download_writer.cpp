@@ -0,0 +1,205 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/file_download_writer.h"
+
+#include <crl/crl_semaphore.h>
+
+namespace Storage {
+namespace {
+
+// Parts usually come in order, so they are written in larger blocks.
+constexpr auto kMaxCoalescedSize = 1024 * 1024;
+
+} // namespace
+
+class DownloadFileWriter::Worker final {
+public:
+	Worker(
+		crl::weak_on_queue<Worker> weak,
+		std::unique_ptr<QFile> file,
+		Fn<void()> failed);
+	~Worker();
+
+	void reserve(int64 size);
+	void write(int64 offset, const QByteArray &data);
+	[[nodiscard]] QByteArray read(int64 offset, int size);
+	void finish(int64 size, Fn<void(bool)> done);
+	void remove();
+
+private:
+	void fail();
+
+	const std::unique_ptr<QFile> _file;
+	const Fn<void()> _failed;
+	int64 _reserved = 0;
+	bool _broken = false;
+
+};
+
+DownloadFileWriter::Worker::Worker(
+	crl::weak_on_queue<Worker>,
+	std::unique_ptr<QFile> file,
+	Fn<void()> failed)
+: _file(std::move(file))
+, _failed(std::move(failed)) {
+}
+
+DownloadFileWriter::Worker::~Worker() {
+	if (_file->isOpen()) {
+		_file->close();
+	}
+}
+
+void DownloadFileWriter::Worker::reserve(int64 size) {
+	// Growing the file at once lets the file system allocate
+	// it in one piece instead of extending it with each part.
+	if (!_broken && _file->resize(size)) {
+		_reserved = size;
+	}
+}
+
+void DownloadFileWriter::Worker::write(
+		int64 offset,
+		const QByteArray &data) {
+	if (_broken) {
+		return;
+	} else if (!_file->seek(offset)
+		|| _file->write(data) != qint64(data.size())) {
+		LOG(("File Error: Could not write %1 bytes at %2 to '%3'."
+			).arg(data.size()
+			).arg(offset
+			).arg(_file->fileName()));
+		fail();
+	}
+}
+
+QByteArray DownloadFileWriter::Worker::read(int64 offset, int size) {
+	if (_broken || !_file->flush() || !_file->seek(offset)) {
+		return QByteArray();
+	}
+	return _file->read(size);
+}
+
+void DownloadFileWriter::Worker::finish(int64 size, Fn<void(bool)> done) {
+	if (!_broken && _reserved > size && !_file->resize(size)) {
+		fail();
+	}
+	if (!_broken && !_file->flush()) {
+		fail();
+	}
+	_file->close();
+	crl::on_main([=, success = !_broken] {
+		done(success);
+	});
+}
+
+void DownloadFileWriter::Worker::remove() {
+	_broken = true;
+	if (_file->isOpen()) {
+		_file->close();
+	}
+	_file->remove();
+}
+
+void DownloadFileWriter::Worker::fail() {
+	if (!_broken) {
+		_broken = true;
+		crl::on_main(_failed);
+	}
+}
+
+std::unique_ptr<DownloadFileWriter> DownloadFileWriter::Open(
+		const QString &path,
+		int64 expectedSize,
+		Fn<void()> failed) {
+	auto file = std::make_unique<QFile>(path);
+	if (!file->open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+		return nullptr;
+	}
+	auto result = std::make_unique<DownloadFileWriter>(
+		std::move(file),
+		std::move(failed));
+	if (expectedSize > 0) {
+		result->_worker.with([=](Worker &worker) {
+			worker.reserve(expectedSize);
+		});
+	}
+	return result;
+}
+
+DownloadFileWriter::DownloadFileWriter(
+	std::unique_ptr<QFile> file,
+	Fn<void()> failed)
+: _worker(std::move(file), crl::guard(this, [=] { _failed(); }))
+, _failed(std::move(failed)) {
+}
+
+DownloadFileWriter::~DownloadFileWriter() {
+	flush();
+}
+
+void DownloadFileWriter::write(int64 offset, bytes::const_span buffer) {
+	Expects(!buffer.empty());
+
+	_size = std::max(_size, offset + int64(buffer.size()));
+	const auto data = reinterpret_cast<const char*>(buffer.data());
+	if (!_pending.isEmpty()
+		&& offset == _pendingOffset + _pending.size()
+		&& _pending.size() + buffer.size() <= kMaxCoalescedSize) {
+		_pending.append(data, buffer.size());
+	} else {
+		flush();
+		_pendingOffset = offset;
+		_pending.reserve(std::max(int(buffer.size()), kMaxCoalescedSize));
+		_pending.append(data, buffer.size());
+	}
+	if (_pending.size() >= kMaxCoalescedSize) {
+		flush();
+	}
+}
+
+QByteArray DownloadFileWriter::read(int64 offset, int size) {
+	flush();
+
+	auto result = QByteArray();
+	auto semaphore = crl::semaphore();
+	_worker.with([&](Worker &worker) {
+		result = worker.read(offset, size);
+		semaphore.release();
+	});
+	semaphore.acquire();
+	return result;
+}
+
+void DownloadFileWriter::finish(Fn<void(bool)> done) {
+	flush();
+	_worker.with([=, size = _size](Worker &worker) {
+		worker.finish(size, std::move(done));
+	});
+}
+
+void DownloadFileWriter::remove() {
+	_pending = QByteArray();
+	_worker.with([](Worker &worker) {
+		worker.remove();
+	});
+}
+
+void DownloadFileWriter::flush() {
+	if (_pending.isEmpty()) {
+		return;
+	}
+	_worker.with([
+		offset = _pendingOffset,
+		data = base::take(_pending)
+	](Worker &worker) {
+		worker.write(offset, data);
+	});
+}
+
+} // namespace Storage
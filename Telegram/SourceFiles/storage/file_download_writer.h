@@ -0,0 +1,60 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/bytes.h"
+#include "base/weak_ptr.h"
+
+#include <crl/crl_object_on_queue.h>
+
+namespace Storage {
+
+// Writes downloaded parts to a file on a background queue, so that
+// a slow disk doesn't block the main thread while a big file loads.
+//
+// Adjacent parts are coalesced into larger writes. All methods are
+// called from the main thread, callbacks are invoked on it as well.
+class DownloadFileWriter final : public base::has_weak_ptr {
+public:
+	// Opens the file synchronously, returns nullptr on failure.
+	[[nodiscard]] static std::unique_ptr<DownloadFileWriter> Open(
+		const QString &path,
+		int64 expectedSize,
+		Fn<void()> failed);
+
+	DownloadFileWriter(std::unique_ptr<QFile> file, Fn<void()> failed);
+	~DownloadFileWriter();
+
+	void write(int64 offset, bytes::const_span buffer);
+
+	// Size of the file with all the written parts, even not flushed ones.
+	[[nodiscard]] int64 size() const {
+		return _size;
+	}
+
+	// Waits for all the queued writes and reads the part back.
+	[[nodiscard]] QByteArray read(int64 offset, int size);
+
+	void finish(Fn<void(bool)> done);
+	void remove();
+
+private:
+	class Worker;
+
+	void flush();
+
+	crl::object_on_queue<Worker> _worker;
+	Fn<void()> _failed;
+
+	int64 _size = 0;
+	int64 _pendingOffset = 0;
+	QByteArray _pending;
+
+};
+
+} // namespace Storage
@@ -19,6 +19,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/update_checker.h"
 #include "core/file_location.h"
 #include "core/application.h"
+#include "core/core_startup_trace.h"
 #include "media/audio/media_audio.h"
 #include "mtproto/mtproto_config.h"
 #include "mtproto/mtproto_dc_options.h"
@@ -410,13 +411,17 @@ void start() {
 		writeSettings();
 	}
 
-	InitialLoadTheme();
+	{
+		const auto phase = Core::StartupTrace::Phase("initial_theme");
+		InitialLoadTheme();
+	}
 
 	if (context.tileRead && _useGlobalBackgroundKeys) {
 		Window::Theme::Background()->setTileDayValue(context.tileDay);
 		Window::Theme::Background()->setTileNightValue(context.tileNight);
 	}
 
+	const auto phase = Core::StartupTrace::Phase("lang_pack");
 	readLangPack();
 }
 
@@ -851,6 +856,14 @@ public:
 			if (!_waveform.isEmpty()) {
 				voice->waveform = _waveform;
 				voice->wavemax = _wavemax;
+				_doc->owner().cache().put(
+					_doc->waveformCacheKey(),
+					Database::TaggedValue(
+						QByteArray(
+							reinterpret_cast<const char*>(
+								_waveform.constData()),
+							_waveform.size()),
+						Data::kVoiceMessageCacheTag));
 			}
 			if (voice->waveform.isEmpty()) {
 				voice->waveform.resize(1);
@@ -880,15 +893,42 @@ protected:
 
 void countVoiceWaveform(not_null<Data::DocumentMedia*> media) {
 	const auto document = media->owner();
-	if (const auto voice = document->voice()) {
-		if (_localLoader) {
-			voice->waveform.resize(1 + sizeof(TaskId));
-			voice->waveform[0] = -1; // counting
-			TaskId taskId = _localLoader->addTask(
-				std::make_unique<CountWaveformTask>(media));
-			memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
-		}
+	const auto voice = document->voice();
+	if (!voice || !_localLoader) {
+		return;
 	}
+	voice->waveform.resize(1 + sizeof(TaskId));
+	voice->waveform[0] = -1; // counting
+
+	// Try the waveform counted earlier before decoding the whole file.
+	const auto guard = base::make_weak(&document->session());
+	const auto key = document->waveformCacheKey();
+	document->owner().cache().get(key, [=](QByteArray value) {
+		crl::on_main(guard, [=] {
+			const auto voice = document->voice();
+			if (!voice
+				|| voice->waveform.size() != int(1 + sizeof(TaskId))
+				|| voice->waveform[0] != -1) {
+				return;
+			}
+			if (!value.isEmpty()) {
+				voice->waveform = VoiceWaveform(value.size());
+				memcpy(
+					voice->waveform.data(),
+					value.constData(),
+					value.size());
+				voice->wavemax = *ranges::max_element(voice->waveform);
+				document->owner().requestDocumentViewRepaint(document);
+			} else if (const auto active = document->activeMediaView()) {
+				const auto taskId = _localLoader->addTask(
+					std::make_unique<CountWaveformTask>(active.get()));
+				memcpy(voice->waveform.data() + 1, &taskId, sizeof(taskId));
+			} else {
+				// Count it next time the loaded voice message is painted.
+				voice->waveform.clear();
+			}
+		});
+	});
 }
 
 void cancelTask(TaskId id) {
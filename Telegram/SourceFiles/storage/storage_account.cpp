@@ -32,6 +32,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_drafts.h"
 #include "export/export_settings.h"
 #include "window/themes/window_theme.h"
+#include "apiwrap.h"
 
 namespace Storage {
 namespace {
@@ -40,9 +41,20 @@ using namespace details;
 using Database = Cache::Database;
 
 constexpr auto kDelayedWriteTimeout = crl::time(1000);
+constexpr auto kLocationsRecordsMinLimit = int64(64 * 1024);
+
+enum class LocationRecord : quint32 {
+	Added = 1,
+	Removed = 2,
+	Alias = 3,
+};
 
 constexpr auto kStickersVersionTag = quint32(-1);
 constexpr auto kStickersSerializeVersion = 1;
+
+// Installed sets are written as headers with the contents of each set
+// in its own file, so that the contents are read only when required.
+constexpr auto kStickerSetsRecordsVersion = 2;
 constexpr auto kMaxSavedStickerSetsCount = 1000;
 constexpr auto kDefaultStickerInstallDate = TimeId(1);
 
@@ -76,6 +88,7 @@ enum { // Local Storage Keys
 	lskExportSettings = 0x13, // no data
 	lskBackgroundOld = 0x14, // no data
 	lskSelfSerialized = 0x15, // serialized self
+	lskStickerSetRecords = 0x16, // data: installed sets contents keys
 };
 
 [[nodiscard]] FileKey ComputeDataNameKey(const QString &dataName) {
@@ -104,6 +117,97 @@ enum { // Local Storage Keys
 	return cWorkingDir() + qsl("tdata/tdld/");
 }
 
+[[nodiscard]] quint32 StickerSetInfoSize(const Data::StickersSet &set) {
+	// id + access + title + shortName + stickersCount + hash + flags + installDate
+	return sizeof(quint64) * 2
+		+ Serialize::stringSize(set.title)
+		+ Serialize::stringSize(set.shortName)
+		+ sizeof(qint32) * 4
+		+ Serialize::imageLocationSize(set.thumbnailLocation());
+}
+
+[[nodiscard]] quint32 StickerSetContentSize(const Data::StickersSet &set) {
+	auto result = quint32(0);
+	for (const auto sticker : set.stickers) {
+		result += Serialize::Document::sizeInStream(sticker);
+	}
+
+	result += sizeof(qint32); // datesCount
+	if (!set.dates.empty()) {
+		Assert(set.stickers.size() == set.dates.size());
+		result += set.dates.size() * sizeof(qint32);
+	}
+
+	result += sizeof(qint32); // emojiCount
+	for (auto j = set.emoji.cbegin(), e = set.emoji.cend(); j != e; ++j) {
+		result += Serialize::stringSize(j.key()->id())
+			+ sizeof(qint32)
+			+ (j->size() * sizeof(quint64));
+	}
+	return result;
+}
+
+void WriteStickerSetInfo(
+		QDataStream &stream,
+		const Data::StickersSet &set,
+		int count) {
+	stream
+		<< quint64(set.id)
+		<< quint64(set.access)
+		<< set.title
+		<< set.shortName
+		<< qint32(count)
+		<< qint32(set.hash)
+		<< qint32(set.flags)
+		<< qint32(set.installDate);
+	Serialize::writeImageLocation(stream, set.thumbnailLocation());
+}
+
+void WriteStickerSetContent(
+		QDataStream &stream,
+		const Data::StickersSet &set) {
+	for (const auto &sticker : set.stickers) {
+		Serialize::Document::writeToStream(stream, sticker);
+	}
+	stream << qint32(set.dates.size());
+	if (!set.dates.empty()) {
+		Assert(set.dates.size() == set.stickers.size());
+		for (const auto date : set.dates) {
+			stream << qint32(date);
+		}
+	}
+	stream << qint32(set.emoji.size());
+	for (auto j = set.emoji.cbegin(), e = set.emoji.cend(); j != e; ++j) {
+		stream << j.key()->id() << qint32(j->size());
+		for (const auto sticker : *j) {
+			stream << quint64(sticker->id);
+		}
+	}
+}
+
+// Cheap check if the set contents changed since the last write.
+[[nodiscard]] uint64 StickerSetFingerprint(const Data::StickersSet &set) {
+	auto result = uint64(0xCBF29CE484222325ULL);
+	const auto add = [&](uint64 value) {
+		result = (result ^ value) * 0x100000001B3ULL;
+	};
+	add(uint64(uint32(set.hash)));
+	add(set.stickers.size());
+	for (const auto sticker : set.stickers) {
+		add(sticker->id);
+	}
+	for (const auto date : set.dates) {
+		add(uint64(uint32(date)));
+	}
+	for (auto j = set.emoji.cbegin(), e = set.emoji.cend(); j != e; ++j) {
+		add(qHash(j.key()->id()));
+		for (const auto sticker : *j) {
+			add(sticker->id);
+		}
+	}
+	return result;
+}
+
 } // namespace
 
 Account::Account(not_null<Main::Account*> owner, const QString &dataName)
@@ -208,9 +312,16 @@ base::flat_set<QString> Account::collectGoodNames() const {
 	for (const auto &[key, value] : _draftCursorsMap) {
 		push(value);
 	}
+	for (const auto &[id, record] : _stickerSetRecords) {
+		push(record.key);
+	}
 	for (const auto &value : keys) {
 		push(value);
 	}
+	if (_locationsKey) {
+		// The records appended after the last locations snapshot.
+		result.emplace(ToFilePart(_locationsKey) + 'l');
+	}
 	return result;
 }
 
@@ -267,6 +378,7 @@ Account::ReadMapResult Account::readMapWith(
 	quint64 savedGifsKey = 0;
 	quint64 legacyBackgroundKeyDay = 0, legacyBackgroundKeyNight = 0;
 	quint64 userSettingsKey = 0, recentHashtagsAndBotsKey = 0, exportSettingsKey = 0;
+	base::flat_map<uint64, StickerSetRecord> stickerSetRecords;
 	while (!map.stream.atEnd()) {
 		quint32 keyType;
 		map.stream >> keyType;
@@ -358,6 +470,16 @@ Account::ReadMapResult Account::readMapWith(
 		case lskExportSettings: {
 			map.stream >> exportSettingsKey;
 		} break;
+		case lskStickerSetRecords: {
+			quint32 count = 0;
+			map.stream >> count;
+			for (quint32 i = 0; i < count; ++i) {
+				FileKey key;
+				quint64 setId;
+				map.stream >> key >> setId;
+				stickerSetRecords.emplace(setId, StickerSetRecord{ key });
+			}
+		} break;
 		default:
 			LOG(("App Error: unknown key type in encrypted map: %1").arg(keyType));
 			return ReadMapResult::Failed;
@@ -387,6 +509,7 @@ Account::ReadMapResult Account::readMapWith(
 	_settingsKey = userSettingsKey;
 	_recentHashtagsAndBotsKey = recentHashtagsAndBotsKey;
 	_exportSettingsKey = exportSettingsKey;
+	_stickerSetRecords = std::move(stickerSetRecords);
 	_oldMapVersion = mapData.version;
 
 	if (_oldMapVersion < AppVersion) {
@@ -486,6 +609,7 @@ void Account::writeMap() {
 	if (_settingsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_recentHashtagsAndBotsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_exportSettingsKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (!_stickerSetRecords.empty()) mapSize += sizeof(quint32) * 2 + _stickerSetRecords.size() * sizeof(quint64) * 2;
 
 	EncryptedDescriptor mapData(mapSize);
 	if (!self.isEmpty()) {
@@ -531,6 +655,12 @@ void Account::writeMap() {
 	if (_exportSettingsKey) {
 		mapData.stream << quint32(lskExportSettings) << quint64(_exportSettingsKey);
 	}
+	if (!_stickerSetRecords.empty()) {
+		mapData.stream << quint32(lskStickerSetRecords) << quint32(_stickerSetRecords.size());
+		for (const auto &[id, record] : _stickerSetRecords) {
+			mapData.stream << quint64(record.key) << quint64(id);
+		}
+	}
 	map.writeEncrypted(mapData, _localKey);
 
 	_mapChanged = false;
@@ -555,6 +685,9 @@ void Account::reset() {
 	_fileLocations.clear();
 	_fileLocationPairs.clear();
 	_fileLocationAliases.clear();
+	_locationsRecords = QByteArray();
+	_locationsRecordsSize = _locationsSnapshotSize = 0;
+	_stickerSetRecords.clear();
 	_cacheTotalSizeLimit = Database::Settings().totalSizeLimit;
 	_cacheTotalTimeLimit = Database::Settings().totalTimeLimit;
 	_cacheBigFileTotalSizeLimit = Database::Settings().totalSizeLimit;
@@ -585,65 +718,114 @@ void Account::writeLocations() {
 	_locationsChanged = false;
 
 	if (_fileLocations.isEmpty()) {
+		_locationsRecords = QByteArray();
+		_locationsRecordsSize = _locationsSnapshotSize = 0;
 		if (_locationsKey) {
 			ClearKey(_locationsKey, _basePath);
 			_locationsKey = 0;
 			writeMapDelayed();
 		}
-	} else {
-		if (!_locationsKey) {
-			_locationsKey = GenerateKey(_basePath);
-			writeMapQueued();
-		}
-		quint32 size = 0;
-		for (auto i = _fileLocations.cbegin(), e = _fileLocations.cend(); i != e; ++i) {
-			// location + type + namelen + name
-			size += sizeof(quint64) * 2 + sizeof(quint32) + Serialize::stringSize(i.value().name());
-			if (AppVersion > 9013) {
-				// bookmark
-				size += Serialize::bytearraySize(i.value().bookmark());
-			}
-			// date + size
-			size += Serialize::dateTimeSize() + sizeof(quint32);
-		}
+	} else if (!_locationsKey) {
+		_locationsKey = GenerateKey(_basePath);
+		writeMapQueued();
+		writeLocationsSnapshot();
+	} else if (!appendLocationsRecords()) {
+		writeLocationsSnapshot();
+	}
+}
+
+bool Account::appendLocationsRecords() {
+	if (_locationsRecords.isEmpty()) {
+		return false;
+	}
+	const auto limit = std::max(
+		kLocationsRecordsMinLimit,
+		_locationsSnapshotSize);
+	if (_locationsRecordsSize + _locationsRecords.size() > limit) {
+		return false;
+	}
+	const auto started = crl::now();
+	auto data = EncryptedDescriptor(_locationsRecords.size());
+	data.stream.writeRawData(
+		_locationsRecords.constData(),
+		_locationsRecords.size());
+	const auto written = AppendEncryptedRecord(
+		RecordsPath(_locationsKey, _basePath),
+		data,
+		_localKey);
+	if (!written) {
+		return false;
+	}
+	_locationsRecords = QByteArray();
+	_locationsRecordsSize += written;
+	DEBUG_LOG(("Storage Info: "
+		"appended %1 bytes of locations in %2 ms, %3 bytes total."
+		).arg(written
+		).arg(crl::now() - started
+		).arg(_locationsRecordsSize));
+	return true;
+}
+
+void Account::writeLocationsSnapshot() {
+	Expects(_locationsKey != 0);
 
-		//end mark
-		size += sizeof(quint64) * 2 + sizeof(quint32) + Serialize::stringSize(QString());
+	const auto started = crl::now();
+	quint32 size = 0;
+	for (auto i = _fileLocations.cbegin(), e = _fileLocations.cend(); i != e; ++i) {
+		// location + type + namelen + name
+		size += sizeof(quint64) * 2 + sizeof(quint32) + Serialize::stringSize(i.value().name());
 		if (AppVersion > 9013) {
-			size += Serialize::bytearraySize(QByteArray());
+			// bookmark
+			size += Serialize::bytearraySize(i.value().bookmark());
 		}
+		// date + size
 		size += Serialize::dateTimeSize() + sizeof(quint32);
+	}
 
-		size += sizeof(quint32); // aliases count
-		for (auto i = _fileLocationAliases.cbegin(), e = _fileLocationAliases.cend(); i != e; ++i) {
-			// alias + location
-			size += sizeof(quint64) * 2 + sizeof(quint64) * 2;
-		}
+	//end mark
+	size += sizeof(quint64) * 2 + sizeof(quint32) + Serialize::stringSize(QString());
+	if (AppVersion > 9013) {
+		size += Serialize::bytearraySize(QByteArray());
+	}
+	size += Serialize::dateTimeSize() + sizeof(quint32);
 
-		EncryptedDescriptor data(size);
-		auto legacyTypeField = 0;
-		for (auto i = _fileLocations.cbegin(); i != _fileLocations.cend(); ++i) {
-			data.stream << quint64(i.key().first) << quint64(i.key().second) << quint32(legacyTypeField) << i.value().name();
-			if (AppVersion > 9013) {
-				data.stream << i.value().bookmark();
-			}
-			data.stream << i.value().modified << quint32(i.value().size);
-		}
+	size += sizeof(quint32); // aliases count
+	for (auto i = _fileLocationAliases.cbegin(), e = _fileLocationAliases.cend(); i != e; ++i) {
+		// alias + location
+		size += sizeof(quint64) * 2 + sizeof(quint64) * 2;
+	}
 
-		data.stream << quint64(0) << quint64(0) << quint32(0) << QString();
+	EncryptedDescriptor data(size);
+	auto legacyTypeField = 0;
+	for (auto i = _fileLocations.cbegin(); i != _fileLocations.cend(); ++i) {
+		data.stream << quint64(i.key().first) << quint64(i.key().second) << quint32(legacyTypeField) << i.value().name();
 		if (AppVersion > 9013) {
-			data.stream << QByteArray();
+			data.stream << i.value().bookmark();
 		}
-		data.stream << QDateTime::currentDateTime() << quint32(0);
+		data.stream << i.value().modified << quint32(i.value().size);
+	}
 
-		data.stream << quint32(_fileLocationAliases.size());
-		for (auto i = _fileLocationAliases.cbegin(), e = _fileLocationAliases.cend(); i != e; ++i) {
-			data.stream << quint64(i.key().first) << quint64(i.key().second) << quint64(i.value().first) << quint64(i.value().second);
-		}
+	data.stream << quint64(0) << quint64(0) << quint32(0) << QString();
+	if (AppVersion > 9013) {
+		data.stream << QByteArray();
+	}
+	data.stream << QDateTime::currentDateTime() << quint32(0);
 
-		FileWriteDescriptor file(_locationsKey, _basePath);
-		file.writeEncrypted(data, _localKey);
+	data.stream << quint32(_fileLocationAliases.size());
+	for (auto i = _fileLocationAliases.cbegin(), e = _fileLocationAliases.cend(); i != e; ++i) {
+		data.stream << quint64(i.key().first) << quint64(i.key().second) << quint64(i.value().first) << quint64(i.value().second);
 	}
+
+	FileWriteDescriptor file(_locationsKey, _basePath);
+	file.writeEncrypted(data, _localKey);
+
+	QFile::remove(RecordsPath(_locationsKey, _basePath));
+	_locationsRecords = QByteArray();
+	_locationsRecordsSize = 0;
+	_locationsSnapshotSize = size;
+	DEBUG_LOG(("Storage Info: wrote %1 bytes of locations in %2 ms."
+		).arg(size
+		).arg(crl::now() - started));
 }
 
 void Account::writeLocationsQueued() {
@@ -714,6 +896,121 @@ void Account::readLocations() {
 			}
 		}
 	}
+	_locationsSnapshotSize = locations.data.size();
+	_locationsRecordsSize = ReadEncryptedRecords(
+		RecordsPath(_locationsKey, _basePath),
+		_localKey,
+		[&](EncryptedDescriptor &record) {
+			applyLocationsRecords(record.stream);
+		});
+}
+
+void Account::applyLocationsRecords(QDataStream &stream) {
+	// Applying a record twice gives the same result, so if we crash
+	// after writing the snapshot, but before removing the records file,
+	// the old records can be applied to the new snapshot as well.
+	while (!stream.atEnd()) {
+		quint32 type = 0;
+		quint64 first = 0, second = 0;
+		stream >> type >> first >> second;
+		const auto location = MediaKey(first, second);
+		switch (LocationRecord(type)) {
+		case LocationRecord::Added: {
+			auto local = Core::FileLocation();
+			auto bookmark = QByteArray();
+			stream >> local.fname >> bookmark >> local.modified >> local.size;
+			local.setBookmark(bookmark);
+			if (!CheckStreamStatus(stream)) {
+				return;
+			}
+			const auto already = [&] {
+				for (auto i = _fileLocations.find(location)
+					; (i != _fileLocations.end()) && (i.key() == location)
+					; ++i) {
+					if (i.value() == local) {
+						return true;
+					}
+				}
+				return false;
+			}();
+			if (!already) {
+				_fileLocations.insert(location, local);
+				if (!local.inMediaCache()) {
+					_fileLocationPairs.insert(local.fname, { location, local });
+				}
+			}
+		} break;
+		case LocationRecord::Removed: {
+			auto name = QString();
+			stream >> name;
+			if (!CheckStreamStatus(stream)) {
+				return;
+			}
+			for (auto i = _fileLocations.find(location)
+				; (i != _fileLocations.end()) && (i.key() == location);) {
+				if (!name.isEmpty() && i.value().fname != name) {
+					++i;
+					continue;
+				}
+				const auto j = _fileLocationPairs.find(i.value().fname);
+				if (j != _fileLocationPairs.end()
+					&& j.value().first == location) {
+					_fileLocationPairs.erase(j);
+				}
+				i = _fileLocations.erase(i);
+			}
+		} break;
+		case LocationRecord::Alias: {
+			quint64 originalFirst = 0, originalSecond = 0;
+			stream >> originalFirst >> originalSecond;
+			if (!CheckStreamStatus(stream)) {
+				return;
+			}
+			_fileLocationAliases.insert(
+				location,
+				MediaKey(originalFirst, originalSecond));
+		} break;
+		default:
+			LOG(("App Error: bad location record type: %1").arg(type));
+			return;
+		}
+	}
+}
+
+void Account::recordLocationAdded(
+		MediaKey location,
+		const Core::FileLocation &local) {
+	auto stream = QDataStream(&_locationsRecords, QIODevice::Append);
+	stream.setVersion(QDataStream::Qt_5_1);
+	stream
+		<< quint32(LocationRecord::Added)
+		<< quint64(location.first)
+		<< quint64(location.second)
+		<< local.fname
+		<< local.bookmark()
+		<< local.modified
+		<< quint32(local.size);
+}
+
+void Account::recordLocationRemoved(MediaKey location, const QString &name) {
+	auto stream = QDataStream(&_locationsRecords, QIODevice::Append);
+	stream.setVersion(QDataStream::Qt_5_1);
+	stream
+		<< quint32(LocationRecord::Removed)
+		<< quint64(location.first)
+		<< quint64(location.second)
+		<< name;
+}
+
+void Account::recordLocationAlias(MediaKey location, MediaKey original) {
+	auto stream = QDataStream(&_locationsRecords, QIODevice::Append);
+	stream.setVersion(QDataStream::Qt_5_1);
+	stream
+		<< quint32(LocationRecord::Alias)
+		<< quint64(location.first)
+		<< quint64(location.second)
+		<< quint64(original.first)
+		<< quint64(original.second);
 }
 
 void Account::writeSessionSettings() {
@@ -1362,6 +1659,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 			if (i.value().second == local) {
 				if (i.value().first != location) {
 					_fileLocationAliases.insert(location, i.value().first);
+					recordLocationAlias(location, i.value().first);
 					writeLocationsQueued();
 				}
 				return;
@@ -1369,6 +1667,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 			if (i.value().first != location) {
 				for (auto j = _fileLocations.find(i.value().first), e = _fileLocations.end(); (j != e) && (j.key() == i.value().first); ++j) {
 					if (j.value() == i.value().second) {
+						recordLocationRemoved(j.key(), j.value().fname);
 						_fileLocations.erase(j);
 						break;
 					}
@@ -1382,10 +1681,12 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 			if (i.value().inMediaCache() || i.value().check()) {
 				return;
 			}
+			recordLocationRemoved(location, i.value().fname);
 			i = _fileLocations.erase(i);
 		}
 	}
 	_fileLocations.insert(location, local);
+	recordLocationAdded(location, local);
 	writeLocationsQueued();
 }
 
@@ -1397,6 +1698,7 @@ void Account::removeFileLocation(MediaKey location) {
 	while (i != _fileLocations.end() && (i.key() == location)) {
 		i = _fileLocations.erase(i);
 	}
+	recordLocationRemoved(location, QString());
 	writeLocationsQueued();
 }
 
@@ -1409,6 +1711,7 @@ Core::FileLocation Account::readFileLocation(MediaKey location) {
 	for (auto i = _fileLocations.find(location); (i != _fileLocations.end()) && (i.key() == location);) {
 		if (!i.value().inMediaCache() && !i.value().check()) {
 			_fileLocationPairs.remove(i.value().fname);
+			recordLocationRemoved(location, i.value().fname);
 			i = _fileLocations.erase(i);
 			writeLocationsDelayed();
 			continue;
@@ -1482,43 +1785,15 @@ Cache::Database::Settings Account::cacheBigFileSettings() const {
 void Account::writeStickerSet(
 		QDataStream &stream,
 		const Data::StickersSet &set) {
-	const auto writeInfo = [&](int count) {
-		stream
-			<< quint64(set.id)
-			<< quint64(set.access)
-			<< set.title
-			<< set.shortName
-			<< qint32(count)
-			<< qint32(set.hash)
-			<< qint32(set.flags)
-			<< qint32(set.installDate);
-		Serialize::writeImageLocation(stream, set.thumbnailLocation());
-	};
 	if (set.flags & MTPDstickerSet_ClientFlag::f_not_loaded) {
-		writeInfo(-set.count);
+		WriteStickerSetInfo(stream, set, -set.count);
 		return;
 	} else if (set.stickers.isEmpty()) {
 		return;
 	}
 
-	writeInfo(set.stickers.size());
-	for (const auto &sticker : set.stickers) {
-		Serialize::Document::writeToStream(stream, sticker);
-	}
-	stream << qint32(set.dates.size());
-	if (!set.dates.empty()) {
-		Assert(set.dates.size() == set.stickers.size());
-		for (const auto date : set.dates) {
-			stream << qint32(date);
-		}
-	}
-	stream << qint32(set.emoji.size());
-	for (auto j = set.emoji.cbegin(), e = set.emoji.cend(); j != e; ++j) {
-		stream << j.key()->id() << qint32(j->size());
-		for (const auto sticker : *j) {
-			stream << quint64(sticker->id);
-		}
-	}
+	WriteStickerSetInfo(stream, set, set.stickers.size());
+	WriteStickerSetContent(stream, set);
 }
 
 // In generic method _writeStickerSets() we look through all the sets and call a
@@ -1558,30 +1833,11 @@ void Account::writeStickerSets(
 			continue;
 		}
 
-		// id + access + title + shortName + stickersCount + hash + flags + installDate
-		size += sizeof(quint64) * 2
-			+ Serialize::stringSize(raw->title)
-			+ Serialize::stringSize(raw->shortName)
-			+ sizeof(qint32) * 4
-			+ Serialize::imageLocationSize(raw->thumbnailLocation());
+		size += StickerSetInfoSize(*raw);
 		if (raw->flags & MTPDstickerSet_ClientFlag::f_not_loaded) {
 			continue;
 		}
-
-		for (const auto sticker : raw->stickers) {
-			size += Serialize::Document::sizeInStream(sticker);
-		}
-
-		size += sizeof(qint32); // datesCount
-		if (!raw->dates.empty()) {
-			Assert(raw->stickers.size() == raw->dates.size());
-			size += raw->dates.size() * sizeof(qint32);
-		}
-
-		size += sizeof(qint32); // emojiCount
-		for (auto j = raw->emoji.cbegin(), e = raw->emoji.cend(); j != e; ++j) {
-			size += Serialize::stringSize(j.key()->id()) + sizeof(qint32) + (j->size() * sizeof(quint64));
-		}
+		size += StickerSetContentSize(*raw);
 
 		++setsCount;
 	}
@@ -1619,6 +1875,145 @@ void Account::writeStickerSets(
 	file.writeEncrypted(data, _localKey);
 }
 
+template <typename CheckSet>
+void Account::writeStickerSetsWithRecords(
+		FileKey &stickersKey,
+		CheckSet checkSet,
+		const Data::StickersSetsOrder &order) {
+	const auto &sets = _owner->session().data().stickers().sets();
+	auto list = std::vector<not_null<Data::StickersSet*>>();
+	list.reserve(sets.size());
+	for (const auto &[id, set] : sets) {
+		const auto result = checkSet(*set);
+		if (result == StickerSetCheckResult::Abort) {
+			return;
+		} else if (result == StickerSetCheckResult::Write) {
+			list.push_back(set.get());
+		}
+	}
+	if (list.empty() && order.isEmpty()) {
+		if (!_stickerSetRecords.empty()) {
+			for (const auto &[id, record] : base::take(_stickerSetRecords)) {
+				ClearKey(record.key, _basePath);
+			}
+			writeMapDelayed();
+		}
+		if (stickersKey) {
+			ClearKey(stickersKey, _basePath);
+			stickersKey = 0;
+			writeMapDelayed();
+		}
+		return;
+	}
+
+	const auto started = crl::now();
+	auto rewritten = 0;
+
+	// versionTag + version + count + order
+	quint32 size = sizeof(quint32) + sizeof(qint32) + sizeof(qint32);
+	size += sizeof(qint32) + (order.size() * sizeof(quint64));
+
+	auto records = base::flat_map<uint64, StickerSetRecord>();
+	records.reserve(list.size());
+	for (const auto set : list) {
+		// info + record key + fingerprint
+		size += StickerSetInfoSize(*set) + sizeof(quint64) * 2;
+		if (!(set->flags & MTPDstickerSet_ClientFlag::f_not_loaded)) {
+			const auto i = _stickerSetRecords.find(set->id);
+			const auto was = (i != end(_stickerSetRecords))
+				? i->second.fingerprint
+				: 0;
+			const auto record = writeStickerSetRecord(*set);
+			if (record.fingerprint != was) {
+				++rewritten;
+			}
+			records.emplace(set->id, record);
+		}
+	}
+
+	if (!stickersKey) {
+		stickersKey = GenerateKey(_basePath);
+		writeMapQueued();
+	}
+	EncryptedDescriptor data(size);
+	data.stream
+		<< quint32(kStickersVersionTag)
+		<< qint32(kStickerSetsRecordsVersion)
+		<< qint32(list.size());
+	for (const auto set : list) {
+		const auto i = records.find(set->id);
+		if (i == end(records)) {
+			WriteStickerSetInfo(data.stream, *set, -set->count);
+			data.stream << quint64(0) << quint64(0);
+		} else {
+			const auto &record = i->second;
+			const auto count = record.pending
+				? set->count
+				: int(set->stickers.size());
+			WriteStickerSetInfo(data.stream, *set, count);
+			data.stream
+				<< quint64(record.key)
+				<< quint64(record.fingerprint);
+		}
+	}
+	data.stream << order;
+
+	FileWriteDescriptor file(stickersKey, _basePath);
+	file.writeEncrypted(data, _localKey);
+
+	auto keysChanged = (records.size() != _stickerSetRecords.size());
+	for (const auto &[id, record] : _stickerSetRecords) {
+		const auto i = records.find(id);
+		if (i == end(records)) {
+			ClearKey(record.key, _basePath);
+		} else if (i->second.key != record.key) {
+			keysChanged = true;
+		}
+	}
+	_stickerSetRecords = std::move(records);
+	if (keysChanged) {
+		// The contents keys must be known before the next files cleanup.
+		writeMapQueued();
+	}
+
+	DEBUG_LOG(("Storage Info: wrote %1 sticker set headers "
+		"and %2 sets contents in %3 ms."
+		).arg(list.size()
+		).arg(rewritten
+		).arg(crl::now() - started));
+}
+
+auto Account::writeStickerSetRecord(const Data::StickersSet &set)
+-> StickerSetRecord {
+	const auto i = _stickerSetRecords.find(set.id);
+	auto result = (i != end(_stickerSetRecords))
+		? i->second
+		: StickerSetRecord();
+	if (result.pending && set.stickers.isEmpty()) {
+		// The contents were not read yet, the file is still good.
+		return result;
+	}
+	result.pending = false;
+	const auto fingerprint = StickerSetFingerprint(set);
+	if (result.key && result.fingerprint == fingerprint) {
+		return result;
+	} else if (!result.key) {
+		result.key = GenerateKey(_basePath);
+	}
+	result.fingerprint = fingerprint;
+
+	// id + count + content
+	EncryptedDescriptor data(sizeof(quint64)
+		+ sizeof(qint32)
+		+ StickerSetContentSize(set));
+	data.stream << quint64(set.id) << qint32(set.stickers.size());
+	WriteStickerSetContent(data.stream, set);
+
+	FileWriteDescriptor file(result.key, _basePath);
+	file.writeEncrypted(data, _localKey);
+	return result;
+}
+
 void Account::readStickerSets(
 		FileKey &stickersKey,
 		Data::StickersSetsOrder *outOrder,
@@ -1643,7 +2038,8 @@ void Account::readStickerSets(
 	qint32 version = 0;
 	stickers.stream >> versionTag >> version;
 	if (versionTag != kStickersVersionTag
-		|| version != kStickersSerializeVersion) {
+		|| (version != kStickersSerializeVersion
+			&& version != kStickerSetsRecordsVersion)) {
 		// Old data, without sticker set thumbnails.
 		return failed();
 	}
@@ -1678,6 +2074,10 @@ void Account::readStickerSets(
 		const auto thumbnail = Serialize::readImageLocation(
 			stickers.version,
 			stickers.stream);
+		auto record = StickerSetRecord();
+		if (version == kStickerSetsRecordsVersion) {
+			stickers.stream >> record.key >> record.fingerprint;
+		}
 		if (!thumbnail || !CheckStreamStatus(stickers.stream)) {
 			return failed();
 		} else if (thumbnail->valid() && thumbnail->isLegacy()) {
@@ -1724,7 +2124,6 @@ void Account::readStickerSets(
 				ImageWithLocation{ .location = setThumbnail });
 		}
 		const auto set = it->second.get();
-		auto inputSet = MTP_inputStickerSetID(MTP_long(set->id), MTP_long(set->access));
 		const auto fillStickers = set->stickers.isEmpty();
 
 		if (scnt < 0) { // disabled not loaded set
@@ -1734,84 +2133,18 @@ void Account::readStickerSets(
 			continue;
 		}
 
-		if (fillStickers) {
-			set->stickers.reserve(scnt);
-			set->count = 0;
-		}
-
-		Serialize::Document::StickerSetInfo info(setId, setAccess, setShortName);
-		base::flat_set<DocumentId> read;
-		for (int32 j = 0; j < scnt; ++j) {
-			auto document = Serialize::Document::readStickerFromStream(
-				&_owner->session(),
-				stickers.version,
-				stickers.stream, info);
-			if (!CheckStreamStatus(stickers.stream)) {
-				return failed();
-			} else if (!document
-				|| !document->sticker()
-				|| read.contains(document->id)) {
-				continue;
-			}
-			read.emplace(document->id);
-			if (fillStickers) {
-				set->stickers.push_back(document);
-				if (!(set->flags & MTPDstickerSet_ClientFlag::f_special)) {
-					if (document->sticker()->set.type() != mtpc_inputStickerSetID) {
-						document->sticker()->set = inputSet;
-					}
+		if (version == kStickerSetsRecordsVersion) {
+			if (record.key) {
+				if (fillStickers) {
+					set->count = scnt;
+					record.pending = true;
 				}
-				++set->count;
+				_stickerSetRecords.emplace_or_assign(setId, record);
 			}
-		}
-
-		qint32 datesCount = 0;
-		stickers.stream >> datesCount;
-		if (datesCount > 0) {
-			if (datesCount != scnt) {
-				return failed();
-			}
-			const auto fillDates = (set->id == Data::Stickers::CloudRecentSetId)
-				&& (set->stickers.size() == datesCount);
-			if (fillDates) {
-				set->dates.clear();
-				set->dates.reserve(datesCount);
-			}
-			for (auto i = 0; i != datesCount; ++i) {
-				qint32 date = 0;
-				stickers.stream >> date;
-				if (fillDates) {
-					set->dates.push_back(TimeId(date));
-				}
-			}
-		}
-
-		qint32 emojiCount = 0;
-		stickers.stream >> emojiCount;
-		if (!CheckStreamStatus(stickers.stream) || emojiCount < 0) {
+			continue;
+		} else if (!readStickerSetContent(stickers, set, scnt, fillStickers)) {
 			return failed();
 		}
-		for (int32 j = 0; j < emojiCount; ++j) {
-			QString emojiString;
-			qint32 stickersCount;
-			stickers.stream >> emojiString >> stickersCount;
-			Data::StickersPack pack;
-			pack.reserve(stickersCount);
-			for (int32 k = 0; k < stickersCount; ++k) {
-				quint64 id;
-				stickers.stream >> id;
-				const auto doc = _owner->session().data().document(id);
-				if (!doc->sticker()) continue;
-
-				pack.push_back(doc);
-			}
-			if (fillStickers) {
-				if (auto emoji = Ui::Emoji::Find(emojiString)) {
-					emoji = emoji->original();
-					set->emoji.insert(emoji, pack);
-				}
-			}
-		}
 	}
 
 	// Read orders of installed and featured stickers.
@@ -1852,8 +2185,167 @@ void Account::readStickerSets(
 	}
 }
 
+bool Account::readStickerSetContent(
+		FileReadDescriptor &stickers,
+		not_null<Data::StickersSet*> set,
+		int count,
+		bool fill) {
+	if (fill) {
+		set->stickers.reserve(count);
+		set->count = 0;
+	}
+
+	const auto inputSet = MTP_inputStickerSetID(
+		MTP_long(set->id),
+		MTP_long(set->access));
+	Serialize::Document::StickerSetInfo info(
+		set->id,
+		set->access,
+		set->shortName);
+	base::flat_set<DocumentId> read;
+	for (int32 j = 0; j < count; ++j) {
+		auto document = Serialize::Document::readStickerFromStream(
+			&_owner->session(),
+			stickers.version,
+			stickers.stream, info);
+		if (!CheckStreamStatus(stickers.stream)) {
+			return false;
+		} else if (!document
+			|| !document->sticker()
+			|| read.contains(document->id)) {
+			continue;
+		}
+		read.emplace(document->id);
+		if (fill) {
+			set->stickers.push_back(document);
+			if (!(set->flags & MTPDstickerSet_ClientFlag::f_special)) {
+				if (document->sticker()->set.type() != mtpc_inputStickerSetID) {
+					document->sticker()->set = inputSet;
+				}
+			}
+			++set->count;
+		}
+	}
+
+	qint32 datesCount = 0;
+	stickers.stream >> datesCount;
+	if (datesCount > 0) {
+		if (datesCount != count) {
+			return false;
+		}
+		const auto fillDates = (set->id == Data::Stickers::CloudRecentSetId)
+			&& (set->stickers.size() == datesCount);
+		if (fillDates) {
+			set->dates.clear();
+			set->dates.reserve(datesCount);
+		}
+		for (auto i = 0; i != datesCount; ++i) {
+			qint32 date = 0;
+			stickers.stream >> date;
+			if (fillDates) {
+				set->dates.push_back(TimeId(date));
+			}
+		}
+	}
+
+	qint32 emojiCount = 0;
+	stickers.stream >> emojiCount;
+	if (!CheckStreamStatus(stickers.stream) || emojiCount < 0) {
+		return false;
+	}
+	for (int32 j = 0; j < emojiCount; ++j) {
+		QString emojiString;
+		qint32 stickersCount;
+		stickers.stream >> emojiString >> stickersCount;
+		Data::StickersPack pack;
+		pack.reserve(stickersCount);
+		for (int32 k = 0; k < stickersCount; ++k) {
+			quint64 id;
+			stickers.stream >> id;
+			const auto doc = _owner->session().data().document(id);
+			if (!doc->sticker()) continue;
+
+			pack.push_back(doc);
+		}
+		if (fill) {
+			if (auto emoji = Ui::Emoji::Find(emojiString)) {
+				emoji = emoji->original();
+				set->emoji.insert(emoji, pack);
+			}
+		}
+	}
+	return CheckStreamStatus(stickers.stream);
+}
+
+bool Account::hasPendingStickerSet(uint64 setId) const {
+	const auto i = _stickerSetRecords.find(setId);
+	return (i != end(_stickerSetRecords)) && i->second.pending;
+}
+
+void Account::readPendingStickerSet(uint64 setId) {
+	const auto i = _stickerSetRecords.find(setId);
+	if (i == end(_stickerSetRecords) || !i->second.pending) {
+		return;
+	}
+	i->second.pending = false;
+	const auto key = i->second.key;
+
+	const auto &sets = _owner->session().data().stickers().sets();
+	const auto j = sets.find(setId);
+	if (j == end(sets) || !j->second->stickers.isEmpty()) {
+		return;
+	}
+	const auto set = j->second.get();
+	const auto failed = [&] {
+		LOG(("App Error: could not read sticker set %1 contents."
+			).arg(setId));
+		set->stickers.clear();
+		set->dates.clear();
+		set->emoji.clear();
+		set->flags |= MTPDstickerSet_ClientFlag::f_not_loaded;
+		_owner->session().api().scheduleStickerSetRequest(
+			set->id,
+			set->access);
+		_owner->session().api().requestStickerSets();
+	};
+
+	const auto started = crl::now();
+	FileReadDescriptor content;
+	if (!ReadEncryptedFile(content, key, _basePath, _localKey)) {
+		return failed();
+	}
+	quint64 id = 0;
+	qint32 count = 0;
+	content.stream >> id >> count;
+	if (!CheckStreamStatus(content.stream) || id != setId || count < 0) {
+		return failed();
+	}
+	if (!readStickerSetContent(content, set, count, true)) {
+		return failed();
+	}
+	DEBUG_LOG(("Storage Info: read sticker set %1 contents in %2 ms."
+		).arg(setId
+		).arg(crl::now() - started));
+}
+
+void Account::readPendingStickerSets() {
+	auto pending = std::vector<uint64>();
+	for (const auto &[id, record] : _stickerSetRecords) {
+		if (record.pending) {
+			pending.push_back(id);
+		}
+	}
+	for (const auto id : pending) {
+		readPendingStickerSet(id);
+	}
+}
+
 void Account::writeInstalledStickers() {
-	writeStickerSets(_installedStickersKey, [](const Data::StickersSet &set) {
+	writeStickerSetsWithRecords(_installedStickersKey, [=](
+			const Data::StickersSet &set) {
+		const auto i = _stickerSetRecords.find(set.id);
+		const auto pending = (i != end(_stickerSetRecords))
+			&& i->second.pending;
 		if (set.id == Data::Stickers::CloudRecentSetId || set.id == Data::Stickers::FavedSetId) { // separate files for them
 			return StickerSetCheckResult::Skip;
 		} else if (set.flags & MTPDstickerSet_ClientFlag::f_special) {
@@ -1864,7 +2356,7 @@ void Account::writeInstalledStickers() {
 			return StickerSetCheckResult::Skip;
 		} else if (set.flags & MTPDstickerSet_ClientFlag::f_not_loaded) { // waiting to receive
 			return StickerSetCheckResult::Abort;
-		} else if (set.stickers.isEmpty()) {
+		} else if (set.stickers.isEmpty() && !pending) {
 			return StickerSetCheckResult::Skip;
 		}
 		return StickerSetCheckResult::Write;
@@ -2042,10 +2534,24 @@ void Account::readInstalledStickers() {
 	}
 
 	_owner->session().data().stickers().setsRef().clear();
+	const auto fromMap = base::take(_stickerSetRecords);
 	readStickerSets(
 		_installedStickersKey,
 		&_owner->session().data().stickers().setsOrderRef(),
 		MTPDstickerSet::Flag::f_installed_date);
+
+	// Keep in the map only the contents keys the headers refer to.
+	auto keysChanged = (fromMap.size() != _stickerSetRecords.size());
+	for (const auto &[id, record] : fromMap) {
+		const auto i = _stickerSetRecords.find(id);
+		if (i == end(_stickerSetRecords) || i->second.key != record.key) {
+			ClearKey(record.key, _basePath);
+			keysChanged = true;
+		}
+	}
+	if (keysChanged) {
+		writeMapDelayed();
+	}
 }
 
 void Account::readFeaturedStickers() {
@@ -115,6 +115,9 @@ public:
 	void readRecentStickers();
 	void readFavedStickers();
 	void readArchivedStickers();
+	[[nodiscard]] bool hasPendingStickerSet(uint64 setId) const;
+	void readPendingStickerSet(uint64 setId);
+	void readPendingStickerSets();
 	void writeSavedGifs();
 	void readSavedGifs();
 
@@ -157,6 +160,11 @@ private:
 		IncorrectPasscode,
 		Failed,
 	};
+	struct StickerSetRecord {
+		FileKey key = 0;
+		uint64 fingerprint = 0;
+		bool pending = false; // Contents were not read yet.
+	};
 
 	[[nodiscard]] base::flat_set<QString> collectGoodNames() const;
 	[[nodiscard]] auto prepareReadSettingsContext() const
@@ -174,6 +182,14 @@ private:
 	void writeLocations();
 	void writeLocationsQueued();
 	void writeLocationsDelayed();
+	void writeLocationsSnapshot();
+	[[nodiscard]] bool appendLocationsRecords();
+	void applyLocationsRecords(QDataStream &stream);
+	void recordLocationAdded(
+		MediaKey location,
+		const Core::FileLocation &local);
+	void recordLocationRemoved(MediaKey location, const QString &name);
+	void recordLocationAlias(MediaKey location, MediaKey original);
 
 	std::unique_ptr<Main::SessionSettings> readSessionSettings();
 	void writeSessionSettings(Main::SessionSettings *stored);
@@ -203,10 +219,22 @@ private:
 		FileKey &stickersKey,
 		CheckSet checkSet,
 		const Data::StickersSetsOrder &order);
+	template <typename CheckSet>
+	void writeStickerSetsWithRecords(
+		FileKey &stickersKey,
+		CheckSet checkSet,
+		const Data::StickersSetsOrder &order);
+	[[nodiscard]] StickerSetRecord writeStickerSetRecord(
+		const Data::StickersSet &set);
 	void readStickerSets(
 		FileKey &stickersKey,
 		Data::StickersSetsOrder *outOrder = nullptr,
 		MTPDstickerSet::Flags readingFlags = 0);
+	[[nodiscard]] bool readStickerSetContent(
+		details::FileReadDescriptor &stickers,
+		not_null<Data::StickersSet*> set,
+		int count,
+		bool fill);
 	void importOldRecentStickers();
 
 	void readTrustedBots();
@@ -233,6 +261,14 @@ private:
 	QMap<QString, QPair<MediaKey, Core::FileLocation>> _fileLocationPairs;
 	QMap<MediaKey, MediaKey> _fileLocationAliases;
 
+	base::flat_map<uint64, StickerSetRecord> _stickerSetRecords;
+
+	// Changes of file locations are appended to the records file instead
+	// of rewriting all of them, until the records grow too large.
+	QByteArray _locationsRecords; // Not yet written.
+	int64 _locationsRecordsSize = 0;
+	int64 _locationsSnapshotSize = 0;
+
 	FileKey _locationsKey = 0;
 	FileKey _trustedBotsKey = 0;
 	FileKey _installedStickersKey = 0;
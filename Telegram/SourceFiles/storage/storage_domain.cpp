@@ -9,6 +9,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "storage/details/storage_file_utilities.h"
 #include "storage/serialize_common.h"
+#include "storage/storage_encryption.h"
+#include "core/application.h"
+#include "core/core_settings.h"
 #include "mtproto/mtproto_config.h"
 #include "main/main_domain.h"
 #include "main/main_account.h"
@@ -45,7 +48,26 @@ Domain::Domain(not_null<Main::Domain*> owner, const QString &dataName)
 Domain::~Domain() = default;
 
 StartResult Domain::start(const QByteArray &passcode) {
-	const auto modern = startModern(passcode);
+	return start(passcode, DerivedKey());
+}
+
+void Domain::start(const QByteArray &passcode, Fn<void(StartResult)> done) {
+	auto salt = readPasscodeKeySalt();
+	if (salt.isEmpty() || passcode.isEmpty()) {
+		// Legacy or broken data or a fast derivation, just start.
+		done(start(passcode));
+		return;
+	}
+	CreateLocalKeyAsync(passcode, salt, crl::guard(this, [=](
+			MTP::AuthKeyPtr key) {
+		done(start(passcode, DerivedKey{ salt, std::move(key) }));
+	}));
+}
+
+StartResult Domain::start(
+		const QByteArray &passcode,
+		const DerivedKey &derived) {
+	const auto modern = startModern(passcode, derived);
 	if (modern == StartModernResult::Success) {
 		if (_oldVersion < AppVersion) {
 			writeAccounts();
@@ -109,17 +131,37 @@ void Domain::generateLocalKey() {
 }
 
 void Domain::encryptLocalKey(const QByteArray &passcode) {
-	_passcodeKeySalt.resize(LocalEncryptSaltSize);
-	memset_rand(_passcodeKeySalt.data(), _passcodeKeySalt.size());
-	_passcodeKey = CreateLocalKey(passcode, _passcodeKeySalt);
+	auto salt = QByteArray(LocalEncryptSaltSize, Qt::Uninitialized);
+	memset_rand(salt.data(), salt.size());
+	auto key = CreateLocalKey(passcode, salt);
+	encryptLocalKey({ std::move(salt), std::move(key) });
+}
+
+void Domain::encryptLocalKey(DerivedKey &&derived) {
+	_passcodeKeySalt = std::move(derived.salt);
+	_passcodeKey = std::move(derived.key);
 
 	EncryptedDescriptor passKeyData(MTP::AuthKey::kSize);
 	_localKey->write(passKeyData.stream);
 	_passcodeKeyEncrypted = PrepareEncrypted(passKeyData, _passcodeKey);
 }
 
+QByteArray Domain::readPasscodeKeySalt() const {
+	FileReadDescriptor keyData;
+	if (!ReadFile(keyData, ComputeKeyName(_dataName), BaseGlobalPath())) {
+		return QByteArray();
+	}
+	auto salt = QByteArray();
+	keyData.stream >> salt;
+	return (CheckStreamStatus(keyData.stream)
+		&& salt.size() == LocalEncryptSaltSize)
+		? salt
+		: QByteArray();
+}
+
 Domain::StartModernResult Domain::startModern(
-		const QByteArray &passcode) {
+		const QByteArray &passcode,
+		const DerivedKey &derived) {
 	const auto name = ComputeKeyName(_dataName);
 
 	FileReadDescriptor keyData;
@@ -138,7 +180,9 @@ Domain::StartModernResult Domain::startModern(
 		LOG(("App Error: bad salt in info file, size: %1").arg(salt.size()));
 		return StartModernResult::Failed;
 	}
-	_passcodeKey = CreateLocalKey(passcode, salt);
+	_passcodeKey = (derived.key && derived.salt == salt)
+		? derived.key
+		: CreateLocalKey(passcode, salt);
 
 	EncryptedDescriptor keyInnerData, info;
 	if (!DecryptLocal(keyInnerData, keyEncrypted, _passcodeKey)) {
@@ -254,14 +298,51 @@ bool Domain::checkPasscode(const QByteArray &passcode) const {
 	return checkKey->equals(_passcodeKey);
 }
 
+void Domain::checkPasscode(
+		const QByteArray &passcode,
+		Fn<void(bool)> done) const {
+	Expects(!_passcodeKeySalt.isEmpty());
+	Expects(_passcodeKey != nullptr);
+
+	CreateLocalKeyAsync(passcode, _passcodeKeySalt, [
+		done = std::move(done),
+		expected = _passcodeKey
+	](MTP::AuthKeyPtr key) {
+		done(key->equals(expected));
+	});
+}
+
 void Domain::setPasscode(const QByteArray &passcode) {
 	Expects(!_passcodeKeySalt.isEmpty());
 	Expects(_localKey != nullptr);
 
 	encryptLocalKey(passcode);
+	passcodeChanged(!passcode.isEmpty());
+}
+
+void Domain::setPasscode(const QByteArray &passcode, Fn<void()> done) {
+	Expects(!_passcodeKeySalt.isEmpty());
+	Expects(_localKey != nullptr);
+
+	if (passcode.isEmpty()) {
+		setPasscode(passcode);
+		done();
+		return;
+	}
+	auto salt = QByteArray(LocalEncryptSaltSize, Qt::Uninitialized);
+	memset_rand(salt.data(), salt.size());
+	CreateLocalKeyAsync(passcode, salt, crl::guard(this, [=](
+			MTP::AuthKeyPtr key) {
+		encryptLocalKey({ salt, std::move(key) });
+		passcodeChanged(true);
+		done();
+	}));
+}
+
+void Domain::passcodeChanged(bool hasPasscode) {
 	writeAccounts();
 
-	Global::SetLocalPasscode(!passcode.isEmpty());
+	Global::SetLocalPasscode(hasPasscode);
 	Global::RefLocalPasscodeChanged().notify();
 }
 
@@ -273,4 +354,38 @@ void Domain::clearOldVersion() {
 	_oldVersion = 0;
 }
 
+bool Domain::sharedCacheEnabled() const {
+	return Core::App().settings().sharedMediaCacheActive();
+}
+
+QString Domain::sharedCachePath() const {
+	return BaseGlobalPath() + "user_" + _dataName + "_shared/";
+}
+
+DatabasePointer Domain::sharedCache(
+		const Cache::Database::Settings &settings) {
+	return openSharedCache(_sharedCache, "cache", settings);
+}
+
+DatabasePointer Domain::sharedCacheBigFile(
+		const Cache::Database::Settings &settings) {
+	return openSharedCache(_sharedCacheBigFile, "media_cache", settings);
+}
+
+DatabasePointer Domain::openSharedCache(
+		DatabasePointer &cache,
+		const QString &name,
+		const Cache::Database::Settings &settings) {
+	Expects(_localKey != nullptr);
+
+	const auto path = sharedCachePath() + name;
+	if (!cache) {
+		// We hold one reference so that the database stays open
+		// while accounts are logged out and logged in again.
+		cache = Core::App().databases().get(path, settings);
+		cache->open(EncryptionKey(bytes::make_vector(_localKey->data())));
+	}
+	return Core::App().databases().get(path, settings);
+}
+
 } // namespace Storage
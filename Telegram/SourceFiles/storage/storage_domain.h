@@ -7,6 +7,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include "storage/storage_databases.h"
+#include "base/weak_ptr.h"
+
 namespace MTP {
 class Config;
 class AuthKey;
@@ -26,12 +29,16 @@ enum class StartResult : uchar {
 	IncorrectPasscodeLegacy,
 };
 
-class Domain final {
+class Domain final : public base::has_weak_ptr {
 public:
 	Domain(not_null<Main::Domain*> owner, const QString &dataName);
 	~Domain();
 
 	[[nodiscard]] StartResult start(const QByteArray &passcode);
+
+	// Key derivation for a non-empty passcode is slow, so these variants
+	// derive it on a background thread and call done() on main.
+	void start(const QByteArray &passcode, Fn<void(StartResult)> done);
 	void startAdded(
 		not_null<Main::Account*> account,
 		std::unique_ptr<MTP::Config> config);
@@ -39,11 +46,28 @@ public:
 	void startFromScratch();
 
 	[[nodiscard]] bool checkPasscode(const QByteArray &passcode) const;
+	void checkPasscode(
+		const QByteArray &passcode,
+		Fn<void(bool)> done) const;
 	void setPasscode(const QByteArray &passcode);
+	void setPasscode(const QByteArray &passcode, Fn<void()> done);
 
 	[[nodiscard]] int oldVersion() const;
 	void clearOldVersion();
 
+	// Media caches shared by all the accounts, if enabled in settings.
+	// Cache keys are built from file ids, so a file downloaded in several
+	// accounts is stored only once. The first account opening the cache
+	// provides the settings, the local key is the same for all of them.
+	// The caches of the other mode are left on disk until the user
+	// removes them from the local storage box.
+	[[nodiscard]] bool sharedCacheEnabled() const;
+	[[nodiscard]] DatabasePointer sharedCache(
+		const Cache::Database::Settings &settings);
+	[[nodiscard]] DatabasePointer sharedCacheBigFile(
+		const Cache::Database::Settings &settings);
+	[[nodiscard]] QString sharedCachePath() const;
+
 private:
 	enum class StartModernResult {
 		Success,
@@ -52,12 +76,29 @@ private:
 		Empty,
 	};
 
-	[[nodiscard]] StartModernResult startModern(const QByteArray &passcode);
+	struct DerivedKey {
+		QByteArray salt;
+		MTP::AuthKeyPtr key;
+	};
+
+	[[nodiscard]] StartResult start(
+		const QByteArray &passcode,
+		const DerivedKey &derived);
+	[[nodiscard]] StartModernResult startModern(
+		const QByteArray &passcode,
+		const DerivedKey &derived);
+	[[nodiscard]] QByteArray readPasscodeKeySalt() const;
 	void startWithSingleAccount(
 		const QByteArray &passcode,
 		std::unique_ptr<Main::Account> account);
 	void generateLocalKey();
 	void encryptLocalKey(const QByteArray &passcode);
+	void encryptLocalKey(DerivedKey &&derived);
+	void passcodeChanged(bool hasPasscode);
+	[[nodiscard]] DatabasePointer openSharedCache(
+		DatabasePointer &cache,
+		const QString &name,
+		const Cache::Database::Settings &settings);
 
 	const not_null<Main::Domain*> _owner;
 	const QString _dataName;
@@ -68,6 +109,9 @@ private:
 	QByteArray _passcodeKeyEncrypted;
 	int _oldVersion = 0;
 
+	DatabasePointer _sharedCache;
+	DatabasePointer _sharedCacheBigFile;
+
 };
 
 } // namespace Storage
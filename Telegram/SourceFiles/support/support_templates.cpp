@@ -19,7 +19,16 @@ namespace details {
 namespace {
 
 constexpr auto kQueryLimit = 10;
-constexpr auto kWeightStep = 1000;
+
+// Terms found in keys and questions count as if they were repeated.
+constexpr auto kKeyBoost = 64;
+constexpr auto kQuestionBoost = 8;
+constexpr auto kValueBoost = 1;
+
+// Okapi BM25 parameters, prefix matches count less than full words.
+constexpr auto kSaturation = 1.2;
+constexpr auto kLengthNormalization = 0.75;
+constexpr auto kPrefixMatchFactor = 0.5;
 
 struct Delta {
 	std::vector<const TemplatesQuestion*> added;
@@ -270,75 +279,92 @@ FilesResult ReadFiles(const QString &folder) {
 	return result;
 }
 
-TemplatesIndex ComputeIndex(const TemplatesData &data) {
-	using Id = TemplatesIndex::Id;
-	using Term = TemplatesIndex::Term;
-
-	auto uniqueFirst = std::map<QChar, base::flat_set<Id>>();
-	auto uniqueFull = std::map<Id, base::flat_set<Term>>();
-	const auto pushString = [&](
-			const Id &id,
-			const QString &string,
-			int weight) {
+void RemoveFromIndex(
+		TemplatesIndex &index,
+		const TemplatesIndex::Id &id) {
+	const auto i = index.documents.find(id);
+	if (i == end(index.documents)) {
+		return;
+	}
+	for (const auto &term : i->second.terms) {
+		const auto j = index.terms.find(term);
+		if (j == end(index.terms)) {
+			continue;
+		}
+		auto &postings = j->second;
+		if (const auto k = postings.find(id); k != end(postings)) {
+			postings.erase(k);
+		}
+		if (postings.empty()) {
+			index.terms.erase(j);
+		}
+	}
+	index.totalLength -= i->second.length;
+	index.documents.erase(i);
+}
+
+void AddToIndex(
+		TemplatesIndex &index,
+		const TemplatesIndex::Id &id,
+		const TemplatesQuestion &question) {
+	RemoveFromIndex(index, id);
+
+	auto frequencies = base::flat_map<QString, int>();
+	auto length = 0;
+	const auto pushString = [&](const QString &string, int boost) {
 		const auto list = TextUtilities::PrepareSearchWords(string);
 		for (const auto &word : list) {
-			uniqueFirst[word[0]].emplace(id);
-			uniqueFull[id].emplace(std::make_pair(word, weight));
+			frequencies[word] += boost;
+			length += boost;
 		}
 	};
-	for (const auto &[path, file] : data.files) {
-		for (const auto &[normalized, question] : file.questions) {
-			const auto id = std::make_pair(path, normalized);
-			for (const auto &key : question.normalizedKeys) {
-				pushString(id, key, kWeightStep * kWeightStep);
-			}
-			pushString(id, question.question, kWeightStep);
-			pushString(id, question.value, 1);
-		}
+	for (const auto &key : question.normalizedKeys) {
+		pushString(key, kKeyBoost);
 	}
-
-	auto result = TemplatesIndex();
-	for (const auto &[ch, unique] : uniqueFirst) {
-		result.first.emplace(ch, unique | ranges::to_vector);
+	pushString(question.question, kQuestionBoost);
+	pushString(question.value, kValueBoost);
+	if (frequencies.empty()) {
+		return;
 	}
-	for (const auto &[id, unique] : uniqueFull) {
-		result.full.emplace(id, unique | ranges::to_vector);
+
+	auto &document = index.documents[id];
+	document.length = length;
+	document.terms.reserve(frequencies.size());
+	for (const auto &[word, frequency] : frequencies) {
+		index.terms[word].emplace(id, TemplatesIndex::Posting{
+			.frequency = frequency,
+			.length = length,
+		});
+		document.terms.push_back(word);
 	}
-	return result;
+	index.totalLength += length;
 }
 
-void ReplaceFileIndex(
-		TemplatesIndex &result,
-		TemplatesIndex &&source,
-		const QString &path) {
-	for (auto i = begin(result.full); i != end(result.full);) {
-		if (i->first.first == path) {
-			i = result.full.erase(i);
-		} else {
-			++i;
+TemplatesIndex ComputeIndex(const TemplatesData &data) {
+	auto result = TemplatesIndex();
+	for (const auto &[path, file] : data.files) {
+		for (const auto &[normalized, question] : file.questions) {
+			AddToIndex(result, { path, normalized }, question);
 		}
 	}
-	for (auto &[id, list] : source.full) {
-		result.full.emplace(id, std::move(list));
-	}
+	return result;
+}
 
-	using Id = TemplatesIndex::Id;
-	for (auto &[ch, list] : result.first) {
-		auto i = ranges::lower_bound(
-			list,
-			std::make_pair(path, QString()));
-		auto j = std::find_if(i, end(list), [&](const Id &id) {
-			return id.first != path;
-		});
-		list.erase(i, j);
+void ApplyDelta(
+		TemplatesIndex &index,
+		const QString &path,
+		const Delta &delta) {
+	const auto idByQuestion = [&](not_null<const TemplatesQuestion*> q) {
+		return TemplatesIndex::Id{ path, NormalizeQuestion(q->question) };
+	};
+	for (const auto question : delta.removed) {
+		RemoveFromIndex(index, idByQuestion(question));
+	}
+	for (const auto question : delta.added) {
+		AddToIndex(index, idByQuestion(question), *question);
 	}
-	for (auto &[ch, list] : source.first) {
-		auto &to = result.first[ch];
-		to.insert(
-			end(to),
-			std::make_move_iterator(begin(list)),
-			std::make_move_iterator(end(list)));
-		ranges::sort(to);
+	for (const auto question : delta.changed) {
+		AddToIndex(index, idByQuestion(question), *question);
 	}
 }
 
@@ -485,7 +511,13 @@ void Templates::load() {
 
 	crl::async([=, guard = _reading.make_guard()]() mutable {
 		auto result = ReadFiles(cWorkingDir() + "TEMPLATES");
+		const auto indexing = crl::now();
 		result.index = ComputeIndex(result.result);
+		DEBUG_LOG(("Support Templates: "
+			"indexed %1 questions, %2 terms in %3 ms."
+			).arg(result.index.documents.size()
+			).arg(result.index.terms.size()
+			).arg(crl::now() - indexing));
 		crl::on_main(std::move(guard), [
 			=,
 			result = std::move(result)
@@ -570,21 +602,20 @@ void Templates::updateRequestFinished(QNetworkReply *reply) {
 		auto result = ReadFromBlob(content);
 		auto one = TemplatesData();
 		one.files.emplace(path, std::move(result.result));
-		auto index = ComputeIndex(one);
 		crl::on_main(weak,[
 			=,
 			one = std::move(one),
-			errors = std::move(result.errors),
-			index = std::move(index)
+			errors = std::move(result.errors)
 		]() mutable {
 			auto &existing = _data.files.at(path);
 			auto &parsed = one.files.at(path);
 			MoveKeys(parsed, existing);
-			ReplaceFileIndex(_index, ComputeIndex(one), path);
 			if (!errors.isEmpty()) {
 				_errors.fire(std::move(errors));
 			}
-			if (const auto delta = ComputeDelta(existing, parsed)) {
+			const auto delta = ComputeDelta(existing, parsed);
+			ApplyDelta(_index, path, delta);
+			if (delta) {
 				const auto text = FormatUpdateNotification(
 					path,
 					delta);
@@ -666,58 +697,75 @@ Templates::~Templates() = default;
 
 auto Templates::query(const QString &text) const -> std::vector<Question> {
 	const auto words = TextUtilities::PrepareSearchWords(text);
-	const auto questions = [&](const QString &word) {
-		const auto i = _index.first.find(word[0]);
-		return (i == end(_index.first)) ? 0 : i->second.size();
-	};
-	const auto best = ranges::min_element(words, std::less<>(), questions);
-	if (best == std::end(words)) {
-		return {};
-	}
-	const auto narrowed = _index.first.find((*best)[0]);
-	if (narrowed == end(_index.first)) {
+	if (words.isEmpty() || _index.documents.empty()) {
 		return {};
 	}
+	const auto started = crl::now();
+
 	using Id = TemplatesIndex::Id;
-	using Term = TemplatesIndex::Term;
-	const auto questionById = [&](const Id &id) {
-		return _data.files.at(id.first).questions.at(id.second);
-	};
+	using Pair = std::pair<Id, double>;
+	const auto count = double(_index.documents.size());
+	const auto averageLength = std::max(double(_index.totalLength) / count, 1.);
+	const auto scoresByWord = [&](const QString &word) {
+		auto result = std::vector<Pair>();
+		for (auto i = _index.terms.lower_bound(word)
+			; i != end(_index.terms) && i->first.startsWith(word)
+			; ++i) {
+			const auto &postings = i->second;
+			const auto found = double(postings.size());
+			const auto idf = std::log(
+				1. + (count - found + 0.5) / (found + 0.5));
+			const auto factor = (i->first.size() == word.size())
+				? 1.
+				: kPrefixMatchFactor;
+			for (const auto &[id, posting] : postings) {
+				const auto frequency = double(posting.frequency);
+				const auto normalization = 1.
+					- kLengthNormalization
+					+ kLengthNormalization * posting.length / averageLength;
+				result.emplace_back(
+					id,
+					factor * idf * frequency * (kSaturation + 1.)
+						/ (frequency + kSaturation * normalization));
+			}
+		}
 
-	const auto computeWeight = [&](const Id &id) {
-		auto result = 0;
-		const auto full = _index.full.find(id);
-		for (const auto &word : words) {
-			const auto from = ranges::lower_bound(
-				full->second,
-				word,
-				std::less<>(),
-				[](const Term &term) { return term.first; });
-			const auto till = std::find_if(
-				from,
-				end(full->second),
-				[&](const Term &term) {
-					return !term.first.startsWith(word);
-				});
-			const auto weight = std::max_element(
-				from,
-				till,
-				[](const Term &a, const Term &b) {
-					return a.second < b.second;
-				});
-			if (weight == till) {
-				return 0;
+		// One word may match several terms by prefix, take the best one.
+		ranges::sort(result, std::less<>(), &Pair::first);
+		auto till = begin(result);
+		for (auto i = begin(result); i != end(result); ++i) {
+			if (till != begin(result) && (till - 1)->first == i->first) {
+				accumulate_max((till - 1)->second, i->second);
+			} else {
+				*till++ = std::move(*i);
 			}
-			result += weight->second * (weight->first == word ? 2 : 1);
 		}
+		result.erase(till, end(result));
 		return result;
 	};
-	using Pair = std::pair<Id, int>;
-	const auto pairById = [&](const Id &id) {
-		return std::make_pair(id, computeWeight(id));
-	};
+
+	// Each word must be found in the question, keys or value.
+	auto scores = scoresByWord(words.front());
+	for (auto i = 1; i < words.size() && !scores.empty(); ++i) {
+		const auto other = scoresByWord(words[i]);
+		auto till = begin(scores);
+		auto j = begin(other);
+		for (auto k = begin(scores); k != end(scores); ++k) {
+			const auto byId = [](const Pair &pair, const Id &id) {
+				return pair.first < id;
+			};
+			j = std::lower_bound(j, end(other), k->first, byId);
+			if (j == end(other)) {
+				break;
+			} else if (j->first == k->first) {
+				*till++ = Pair{ std::move(k->first), k->second + j->second };
+			}
+		}
+		scores.erase(till, end(scores));
+	}
+
 	const auto sorter = [](const Pair &a, const Pair &b) {
-		// weight DESC filename DESC question ASC
+		// score DESC filename DESC question ASC
 		if (a.second > b.second) {
 			return true;
 		} else if (a.second < b.second) {
@@ -730,14 +778,24 @@ auto Templates::query(const QString &text) const -> std::vector<Question> {
 			return (a.first.second < b.first.second);
 		}
 	};
-	const auto good = narrowed->second | ranges::view::transform(
-		pairById
-	) | ranges::view::filter([](const Pair &pair) {
-		return pair.second > 0;
-	}) | ranges::to_vector | ranges::action::stable_sort(sorter);
-	return good | ranges::view::transform([&](const Pair &pair) {
-		return questionById(pair.first);
-	}) | ranges::view::take(kQueryLimit) | ranges::to_vector;
+	const auto limit = std::min(int(scores.size()), kQueryLimit);
+	std::partial_sort(
+		begin(scores),
+		begin(scores) + limit,
+		end(scores),
+		sorter);
+
+	DEBUG_LOG(("Support Templates: query with %1 words, "
+		"%2 matches in %3 ms."
+		).arg(words.size()
+		).arg(scores.size()
+		).arg(crl::now() - started));
+
+	return scores | ranges::view::take(limit) | ranges::view::transform([&](
+			const Pair &pair) {
+		return _data.files.at(pair.first.first).questions.at(
+			pair.first.second);
+	}) | ranges::to_vector;
 }
 
 } // namespace Support
@@ -36,10 +36,20 @@ struct TemplatesData {
 
 struct TemplatesIndex {
 	using Id = std::pair<QString, QString>; // filename, normalized question
-	using Term = std::pair<QString, int>; // search term, weight
 
-	std::map<QChar, std::vector<Id>> first;
-	std::map<Id, std::vector<Term>> full;
+	struct Posting {
+		int frequency = 0; // weighted by the field the term was found in
+		int length = 0; // weighted length of the question
+	};
+	struct Document {
+		std::vector<QString> terms;
+		int length = 0;
+	};
+
+	// Sorted by term, so that all terms with a prefix go one by one.
+	std::map<QString, base::flat_map<Id, Posting>> terms;
+	std::map<Id, Document> documents;
+	int64 totalLength = 0;
 };
 
 } // namespace details
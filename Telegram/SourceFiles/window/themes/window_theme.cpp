@@ -22,6 +22,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/unixtime.h"
 #include "base/crc32hash.h"
 #include "data/data_session.h"
+#include "data/data_document.h"
+#include "storage/cache/storage_cache_database.h"
 #include "main/main_account.h" // Account::local.
 #include "main/main_domain.h" // Domain::activeSessionValue.
 #include "ui/image/image.h"
@@ -42,6 +44,7 @@ constexpr auto kThemeFileSizeLimit = 5 * 1024 * 1024;
 constexpr auto kBackgroundSizeLimit = 25 * 1024 * 1024;
 constexpr auto kNightThemeFile = ":/gui/night.tdesktop-theme"_cs;
 constexpr auto kMinimumTiledSize = 512;
+constexpr auto kPreparedLimit = 2;
 
 struct Applying {
 	Saved data;
@@ -510,6 +513,63 @@ void ClearEditingPalette() {
 	QFile(EditingPalettePath()).remove();
 }
 
+[[nodiscard]] bool NeedsPreparation(const Data::WallPaper &paper) {
+	return paper.isPattern()
+		? paper.backgroundColor().has_value()
+		: paper.isBlurred();
+}
+
+[[nodiscard]] bool IsRegularWallPaper(const Data::WallPaper &paper) {
+	return !Data::IsThemeWallPaper(paper)
+		&& !Data::details::IsTestingThemeWallPaper(paper)
+		&& !Data::details::IsTestingDefaultWallPaper(paper)
+		&& !Data::details::IsTestingEditorWallPaper(paper)
+		&& !Data::IsLegacy1DefaultWallPaper(paper)
+		&& !Data::IsDefaultWallPaper(paper);
+}
+
+[[nodiscard]] uint32 PreparedParams(
+		const Data::WallPaper &paper,
+		const QImage &image) {
+	const auto fill = paper.backgroundColor();
+	const int32 values[] = {
+		fill ? int32(fill->rgb()) : 0,
+		paper.isPattern() ? 1 : 0,
+		paper.isBlurred() ? 1 : 0,
+		paper.patternIntensity(),
+		image.width(),
+		image.height(),
+	};
+	return uint32(base::crc32(values, sizeof(values)));
+}
+
+[[nodiscard]] QByteArray SerializePrepared(const QImage &prepared) {
+	auto result = QByteArray();
+	auto buffer = QBuffer(&result);
+	buffer.open(QIODevice::WriteOnly);
+	if (!prepared.save(&buffer, "PNG")) {
+		return QByteArray();
+	}
+	return result;
+}
+
+[[nodiscard]] QImage ReadPrepared(
+		const QByteArray &bytes,
+		const QImage &original) {
+	if (bytes.isEmpty()) {
+		return QImage();
+	}
+	auto result = App::readImage(bytes, nullptr, false);
+	if (result.isNull()) {
+		return QImage();
+	} else if (result.format() != QImage::Format_ARGB32_Premultiplied) {
+		result = std::move(result).convertToFormat(
+			QImage::Format_ARGB32_Premultiplied);
+	}
+	result.setDevicePixelRatio(original.devicePixelRatio());
+	return result;
+}
+
 } // namespace
 
 ChatBackground::AdjustableColor::AdjustableColor(style::color data)
@@ -625,6 +685,7 @@ void ChatBackground::checkUploadWallPaper() {
 }
 
 void ChatBackground::set(const Data::WallPaper &paper, QImage image) {
+	++_preparingId;
 	image = ProcessBackgroundImage(std::move(image));
 
 	const auto needResetAdjustable = Data::IsDefaultWallPaper(paper)
@@ -645,7 +706,7 @@ void ChatBackground::set(const Data::WallPaper &paper, QImage image) {
 	}
 	if (Data::IsThemeWallPaper(_paper)) {
 		(nightMode() ? _tileNightValue : _tileDayValue) = _themeTile;
-		setPreparedImage(_themeImage, _themeImage);
+		setPreparedImage(_themeImage, prepareImage(_themeImage));
 	} else if (Data::details::IsTestingThemeWallPaper(_paper)
 		|| Data::details::IsTestingDefaultWallPaper(_paper)
 		|| Data::details::IsTestingEditorWallPaper(_paper)) {
@@ -655,7 +716,7 @@ void ChatBackground::set(const Data::WallPaper &paper, QImage image) {
 			setPaper(Data::details::TestingDefaultWallPaper());
 		}
 		image = validateBackgroundImage(std::move(image));
-		setPreparedImage(image, image);
+		setPreparedImage(image, prepareImage(image));
 	} else {
 		if (Data::IsLegacy1DefaultWallPaper(_paper)) {
 			image.load(qsl(":/gui/art/bg_initial.jpg"));
@@ -678,12 +739,7 @@ void ChatBackground::set(const Data::WallPaper &paper, QImage image) {
 				: image));
 		if (const auto fill = _paper.backgroundColor()) {
 			if (_paper.isPattern() && !image.isNull()) {
-				auto prepared = validateBackgroundImage(
-					Data::PreparePatternImage(
-						image,
-						*fill,
-						Data::PatternColor(*fill),
-						_paper.patternIntensity()));
+				auto prepared = prepareImage(image);
 				setPreparedImage(std::move(image), std::move(prepared));
 			} else {
 				_original = QImage();
@@ -695,7 +751,7 @@ void ChatBackground::set(const Data::WallPaper &paper, QImage image) {
 			}
 		} else {
 			image = validateBackgroundImage(std::move(image));
-			setPreparedImage(image, image);
+			setPreparedImage(image, prepareImage(image));
 		}
 	}
 	Assert(colorForFill()
@@ -718,15 +774,109 @@ void ChatBackground::setPreparedImage(QImage original, QImage prepared) {
 	Expects(prepared.width() > 0 && prepared.height() > 0);
 
 	_original = std::move(original);
-	if (!_paper.isPattern() && _paper.isBlurred()) {
-		prepared = Data::PrepareBlurredBackground(std::move(prepared));
-	}
 	if (adjustPaletteRequired()) {
 		adjustPaletteUsingBackground(prepared);
 	}
 	preparePixmaps(std::move(prepared));
 }
 
+QImage ChatBackground::prepareImage(const QImage &original) {
+	if (!NeedsPreparation(_paper)) {
+		return original;
+	}
+	const auto paperId = _paper.id();
+	const auto params = PreparedParams(_paper, original);
+	const auto i = ranges::find_if(_prepared, [&](const Prepared &entry) {
+		return (entry.paperId == paperId)
+			&& (entry.params == params)
+			&& (entry.original == original);
+	});
+	if (i != end(_prepared)) {
+		auto entry = std::move(*i);
+		_prepared.erase(i);
+		_prepared.push_back(std::move(entry));
+		return _prepared.back().prepared;
+	}
+	auto result = PrepareBackgroundImage(_paper, original);
+	rememberPrepared({
+		.paperId = paperId,
+		.params = params,
+		.original = original,
+		.prepared = result,
+	});
+	return result;
+}
+
+void ChatBackground::rememberPrepared(Prepared &&prepared) {
+	_prepared.erase(ranges::remove_if(_prepared, [&](const Prepared &entry) {
+		return (entry.paperId == prepared.paperId)
+			&& (entry.params == prepared.params);
+	}), end(_prepared));
+	_prepared.push_back(std::move(prepared));
+	if (_prepared.size() > kPreparedLimit) {
+		_prepared.erase(begin(_prepared));
+	}
+}
+
+void ChatBackground::setAsync(const Data::WallPaper &paper, QImage image) {
+	if (image.isNull()
+		|| !IsRegularWallPaper(paper)
+		|| !NeedsPreparation(paper)) {
+		set(paper, std::move(image));
+		return;
+	}
+	const auto preparingId = ++_preparingId;
+	const auto weak = base::make_weak(this);
+	const auto session = _session;
+	const auto document = paper.document();
+	const auto cacheKey = (session && document)
+		? Data::PreparedWallPaperCacheKey(
+			document->id,
+			PreparedParams(paper, image))
+		: std::optional<Storage::Cache::Key>();
+	const auto prepare = [=](QByteArray cached) {
+		crl::async([=] {
+			auto original = ProcessBackgroundImage(image);
+			if (!paper.isPattern()) {
+				original = validateBackgroundImage(std::move(original));
+			}
+			auto prepared = ReadPrepared(cached, original);
+			auto serialized = QByteArray();
+			if (prepared.isNull()) {
+				prepared = PrepareBackgroundImage(paper, original);
+				if (cacheKey) {
+					serialized = SerializePrepared(prepared);
+				}
+			}
+			crl::on_main(weak, [=]() mutable {
+				if (_preparingId != preparingId) {
+					return;
+				} else if (!serialized.isEmpty() && _session == session) {
+					session->data().cache().put(
+						*cacheKey,
+						Storage::Cache::Database::TaggedValue(
+							std::move(serialized),
+							Data::kImageCacheTag));
+				}
+				rememberPrepared({
+					.paperId = paper.id(),
+					.params = PreparedParams(paper, original),
+					.original = original,
+					.prepared = std::move(prepared),
+				});
+				set(paper, std::move(original));
+			});
+		});
+	};
+	if (cacheKey) {
+		session->data().cache().get(*cacheKey, [=](QByteArray &&value) {
+			prepare(std::move(value));
+		});
+	} else {
+		prepare(QByteArray());
+	}
+}
+
 void ChatBackground::preparePixmaps(QImage image) {
 	const auto width = image.width();
 	const auto height = image.height();
@@ -1393,6 +1543,21 @@ QColor AdjustedColor(QColor original, QColor background) {
 	).toRgb();
 }
 
+QImage PrepareBackgroundImage(const Data::WallPaper &paper, QImage image) {
+	if (paper.isPattern()) {
+		if (const auto fill = paper.backgroundColor()) {
+			return validateBackgroundImage(Data::PreparePatternImage(
+				std::move(image),
+				*fill,
+				Data::PatternColor(*fill),
+				paper.patternIntensity()));
+		}
+	} else if (paper.isBlurred()) {
+		return Data::PrepareBlurredBackground(std::move(image));
+	}
+	return image;
+}
+
 QImage ProcessBackgroundImage(QImage image) {
 	constexpr auto kMaxSize = 2960;
 
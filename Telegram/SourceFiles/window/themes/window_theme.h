@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "data/data_wall_paper.h"
 #include "data/data_cloud_themes.h"
+#include "base/weak_ptr.h"
 
 namespace Main {
 class Session;
@@ -102,6 +103,11 @@ QColor CountAverageColor(const QImage &image);
 QColor AdjustedColor(QColor original, QColor background);
 QImage ProcessBackgroundImage(QImage image);
 
+// Pattern tinting or blurring of the processed image, if the paper has it.
+[[nodiscard]] QImage PrepareBackgroundImage(
+	const Data::WallPaper &paper,
+	QImage image);
+
 struct BackgroundUpdate {
 	enum class Type {
 		New,
@@ -133,6 +139,7 @@ enum class ClearEditing {
 
 class ChatBackground
 	: public base::Observable<BackgroundUpdate>
+	, public base::has_weak_ptr
 	, private base::Subscriber {
 public:
 	ChatBackground();
@@ -144,6 +151,10 @@ public:
 
 	// This method is setting the default (themed) image if none was set yet.
 	void set(const Data::WallPaper &paper, QImage image = QImage());
+
+	// Prepares the image on a background thread and applies it after that,
+	// the current background is displayed meanwhile.
+	void setAsync(const Data::WallPaper &paper, QImage image);
 	void setTile(bool tile);
 	void setTileDayValue(bool tile);
 	void setTileNightValue(bool tile);
@@ -186,11 +197,19 @@ private:
 		style::color item;
 		QColor original;
 	};
+	struct Prepared {
+		WallPaperId paperId = 0;
+		uint32 params = 0;
+		QImage original;
+		QImage prepared;
+	};
 
 	[[nodiscard]] bool started() const;
 	void initialRead();
 	void saveForRevert();
 	void setPreparedImage(QImage original, QImage prepared);
+	[[nodiscard]] QImage prepareImage(const QImage &original);
+	void rememberPrepared(Prepared &&prepared);
 	void preparePixmaps(QImage image);
 	void writeNewBackgroundSettings();
 	void setPaper(const Data::WallPaper &paper);
@@ -251,6 +270,8 @@ private:
 	bool _tileForRevert = false;
 
 	std::vector<AdjustableColor> _adjustableColors;
+	std::vector<Prepared> _prepared;
+	uint64 _preparingId = 0;
 	FullMsgId _wallPaperUploadId;
 	mtpRequestId _wallPaperRequestId = 0;
 	rpl::lifetime _wallPaperUploadLifetime;
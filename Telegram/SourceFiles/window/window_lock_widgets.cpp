@@ -131,7 +131,11 @@ void PasscodeLockWidget::paintContent(Painter &p) {
 	p.setPen(st::windowFg);
 	p.drawText(QRect(0, _passcode->y() - st::passcodeHeaderHeight, width(), st::passcodeHeaderHeight), tr::lng_passcode_enter(tr::now), style::al_center);
 
-	if (!_error.isEmpty()) {
+	if (_checking) {
+		p.setFont(st::boxTextFont);
+		p.setPen(st::windowSubTextFg);
+		p.drawText(QRect(0, _passcode->y() + _passcode->height(), width(), st::passcodeSubmitSkip), tr::lng_passcode_checking(tr::now), style::al_center);
+	} else if (!_error.isEmpty()) {
 		p.setFont(st::boxTextFont);
 		p.setPen(st::boxTextFgError);
 		p.drawText(QRect(0, _passcode->y() + _passcode->height(), width(), st::passcodeSubmitSkip), _error, style::al_center);
@@ -139,7 +143,9 @@ void PasscodeLockWidget::paintContent(Painter &p) {
 }
 
 void PasscodeLockWidget::submit() {
-	if (_passcode->text().isEmpty()) {
+	if (_checking) {
+		return;
+	} else if (_passcode->text().isEmpty()) {
 		_passcode->showError();
 		return;
 	}
@@ -150,11 +156,27 @@ void PasscodeLockWidget::submit() {
 		return;
 	}
 
+	_checking = true;
+	_error = QString();
+	update();
+
+	// Key derivation is slow, so it is done on a background thread.
 	const auto passcode = _passcode->text().toUtf8();
+	const auto done = crl::guard(this, [=](bool correct) {
+		checked(correct);
+	});
 	auto &domain = Core::App().domain();
-	const auto correct = domain.started()
-		? domain.local().checkPasscode(passcode)
-		: (domain.start(passcode) == Storage::StartResult::Success);
+	if (domain.started()) {
+		domain.local().checkPasscode(passcode, done);
+	} else {
+		domain.start(passcode, [=](Storage::StartResult result) {
+			done(result == Storage::StartResult::Success);
+		});
+	}
+}
+
+void PasscodeLockWidget::checked(bool correct) {
+	_checking = false;
 	if (!correct) {
 		cSetPasscodeBadTries(cPasscodeBadTries() + 1);
 		cSetPasscodeLastTry(crl::now());
@@ -22,6 +22,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/player/media_player_instance.h"
 #include "data/data_media_types.h"
 #include "data/data_session.h"
+#include "data/data_histories.h"
 #include "data/data_folder.h"
 #include "data/data_channel.h"
 #include "data/data_chat.h"
@@ -587,6 +588,9 @@ void SessionController::setActiveChatEntry(Dialogs::RowDescriptor row) {
 	if (now) {
 		now->setFakeUnreadWhileOpened(true);
 	}
+	if (was != now) {
+		session().data().histories().shownHistoryChanged(was, now);
+	}
 	if (session().supportMode()) {
 		pushToChatEntryHistory(row);
 	}
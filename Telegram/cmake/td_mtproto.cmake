@@ -15,6 +15,8 @@ PRIVATE
     mtproto/details/mtproto_abstract_socket.h
     mtproto/details/mtproto_bound_key_creator.cpp
     mtproto/details/mtproto_bound_key_creator.h
+    mtproto/details/mtproto_conditioned_socket.cpp
+    mtproto/details/mtproto_conditioned_socket.h
     mtproto/details/mtproto_dc_key_binder.cpp
     mtproto/details/mtproto_dc_key_binder.h
     mtproto/details/mtproto_dc_key_creator.cpp
@@ -23,6 +25,8 @@ PRIVATE
     mtproto/details/mtproto_dcenter.h
     mtproto/details/mtproto_domain_resolver.cpp
     mtproto/details/mtproto_domain_resolver.h
+    mtproto/details/mtproto_loopback_server.cpp
+    mtproto/details/mtproto_loopback_server.h
     mtproto/details/mtproto_dump_to_text.cpp
     mtproto/details/mtproto_dump_to_text.h
     mtproto/details/mtproto_received_ids_manager.cpp
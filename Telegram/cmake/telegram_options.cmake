@@ -6,6 +6,7 @@
 
 option(TDESKTOP_DISABLE_GTK_INTEGRATION "Disable all code for GTK integration (Linux only)." OFF)
 option(TDESKTOP_API_TEST "Use test API credentials." OFF)
+option(TDESKTOP_BUILD_BENCHMARKS "Build the MTProto loopback benchmark." OFF)
 set(TDESKTOP_API_ID "0" CACHE STRING "Provide 'api_id' for the Telegram API access.")
 set(TDESKTOP_API_HASH "" CACHE STRING "Provide 'api_hash' for the Telegram API access.")
 set(TDESKTOP_LAUNCHER_BASENAME "" CACHE STRING "Desktop file base name (Linux only).")